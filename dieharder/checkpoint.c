@@ -0,0 +1,441 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * -K file checkpoints a run as it goes, so that a long test to
+ * destruction (-Y 2 -P 1000000 on a slow hardware source can take days)
+ * that is killed or crashes can be picked up again with --resume
+ * instead of being started over.  A checkpoint holds
+ *
+ *   the options the run depends on, so a resume with different ones
+ *     can be refused;
+ *   how far run_jobs() got through the -a list, and the pvalue of
+ *     every job before that (for the -a summary);
+ *   the state of the generator, since (with -s 0) each test goes on
+ *     from where the last one left it:  a copy of rng->state where the
+ *     type allows it, the position (rptr, rtot and rewind_cnt) of
+ *     file_input and file_input_raw;
+ *   and, when a test is in progress, its Test vectors (every pvalue it
+ *     has so far) and its bit reader.
+ *
+ * The test is saved between TTD/RA steps, after its results have been
+ * output, and a resumed test just goes on to its next step.  A resumed
+ * -a run skips (silently) the tests that were already done.
+ *
+ * It is written at most once every checkpoint_interval seconds (and
+ * whenever a test ends) to file.tmp, which then replaces file, so a
+ * crash leaves either the old checkpoint or the new one, never half of
+ * one.  The file is native binary, good only for the dieharder that
+ * wrote it, and is removed when the run completes.
+ *========================================================================
+ */
+
+#include "dieharder.h"
+#include <time.h>
+
+#define CKPT_MAGIC "DHCKPT1"
+#define CKPT_VERSION 2
+
+/*
+ * What we can do about the generator.
+ */
+#define CKPT_RNG_STATE 0       /* copy rng->state */
+#define CKPT_RNG_FILE 1        /* file_input(_raw):  seek to rptr */
+#define CKPT_RNG_STREAM 2      /* hardware or a pipe:  nothing to restore */
+#define CKPT_RNG_NONE 3        /* state we can't copy (pointers, globals) */
+
+typedef struct {
+  char magic[8];
+  unsigned int version;
+  char rng_name[128];
+  int dtest_num;               /* the -d test, -1 for -a */
+  unsigned long int Seed;
+  unsigned int all,tsamples,psamples,ntuple;
+  unsigned int Xtrategy,Xstep,Xoff,ks_test;
+  double multiply_p,strategy;
+  unsigned int jobseeds;       /* -j given:  every test has its own seed */
+  unsigned int njobs;          /* jobs in the -a list */
+  unsigned int job;            /* the ones before this one are done */
+  unsigned int intest;         /* and this one is in progress */
+} ckpt_header;
+
+typedef struct {
+  unsigned int kind;
+  size_t size;                 /* bytes of rng->state (CKPT_RNG_STATE) */
+  off_t rptr,rtot;             /* (CKPT_RNG_FILE) */
+  unsigned int rewind_cnt;
+} ckpt_rng;
+
+typedef struct {
+  int dtest_num;
+  unsigned int ntuple;
+  unsigned int nkps;
+  Dbits bits;
+} ckpt_test;
+
+typedef struct {
+  unsigned int tsamples,psamples,ntuple;
+  double ks_pvalue;
+} ckpt_pvalues;
+
+/*
+ * Where the run is, for the next checkpoint.
+ */
+static Job *ckpt_joblist = NULL;
+static unsigned int ckpt_njobs = 0,ckpt_j = 0,ckpt_first = 0;
+static time_t ckpt_last = 0;
+
+/*
+ * The checkpoint we are resuming from.
+ */
+static int ckpt_loaded = 0;
+static ckpt_header rh;
+static double *rjob = NULL;
+static ckpt_rng rr;
+static void *rstate = NULL;
+static ckpt_test rt;
+static ckpt_pvalues *rtp = NULL;
+static double **rtpv = NULL;
+
+static int ckpt_rng_kind(gsl_rng *r)
+{
+
+ const gsl_rng_type *t = r->type;
+
+ if(t == gsl_rng_file_input || t == gsl_rng_file_input_raw){
+   return(CKPT_RNG_FILE);
+ }
+ if(t == gsl_rng_stdin_input_raw || t == gsl_rng_dev_random ||
+    t == gsl_rng_dev_urandom || t == gsl_rng_dev_arandom || t == gsl_rng_rdrand){
+   return(CKPT_RNG_STREAM);
+ }
+ if(t == gsl_rng_XOR || t == gsl_rng_ca || t == gsl_rng_uvag || t == gsl_rng_sfmt){
+   return(CKPT_RNG_NONE);
+ }
+ return(CKPT_RNG_STATE);
+
+}
+
+static void ckpt_config(ckpt_header *h)
+{
+
+ memset(h,0,sizeof(ckpt_header));
+ memcpy(h->magic,CKPT_MAGIC,sizeof(CKPT_MAGIC));
+ h->version = CKPT_VERSION;
+ strncpy(h->rng_name,gsl_rng_name(rng),sizeof(h->rng_name) - 1);
+ h->dtest_num = all ? -1 : dtest_num;
+ h->all = all;
+ h->Seed = Seed;
+ h->tsamples = tsamples;
+ h->psamples = psamples;
+ h->ntuple = all ? 0 : ntuple;
+ h->Xtrategy = Xtrategy;
+ h->Xstep = Xstep;
+ h->Xoff = Xoff;
+ h->ks_test = ks_test;
+ h->multiply_p = multiply_p;
+ h->strategy = strategy;
+ h->jobseeds = (workers > 0);
+
+}
+
+/*
+ * Write the checkpoint:  the jobs before ckpt_j done, and test (the
+ * test of job ckpt_j, or the -d test) in progress if it isn't NULL.
+ */
+static void ckpt_write(Dtest *dtest,Test **test)
+{
+
+ char tmpname[PATH_MAX];
+ ckpt_header h;
+ ckpt_rng r;
+ ckpt_test t;
+ ckpt_pvalues tp;
+ file_input_state_t *fstate;
+ unsigned int i,j;
+ FILE *fp;
+ int ok;
+
+ snprintf(tmpname,sizeof(tmpname),"%s.tmp",checkpoint_file);
+ if((fp = fopen(tmpname,"wb")) == NULL){
+   fprintf(stderr,"# checkpoint: cannot open %s, not checkpointing\n",tmpname);
+   checkpoint_file = NULL;
+   return;
+ }
+
+ ckpt_config(&h);
+ h.njobs = ckpt_njobs;
+ h.job = ckpt_j;
+ h.intest = (test != NULL);
+ ok = (fwrite(&h,sizeof(h),1,fp) == 1);
+ for(j=0;j<ckpt_njobs;j++){
+   ok = ok && fwrite(&ckpt_joblist[j].pvalue,sizeof(double),1,fp) == 1;
+ }
+
+ memset(&r,0,sizeof(r));
+ r.kind = ckpt_rng_kind(rng);
+ if(r.kind == CKPT_RNG_STATE){
+   r.size = rng->type->size;
+ } else if(r.kind == CKPT_RNG_FILE){
+   fstate = (file_input_state_t *) rng->state;
+   r.rptr = fstate->rptr;
+   r.rtot = fstate->rtot;
+   r.rewind_cnt = fstate->rewind_cnt;
+ }
+ ok = ok && fwrite(&r,sizeof(r),1,fp) == 1;
+ if(r.size){
+   ok = ok && fwrite(rng->state,r.size,1,fp) == 1;
+ }
+
+ if(test != NULL){
+   memset(&t,0,sizeof(t));
+   t.dtest_num = dtest_num;
+   t.ntuple = ntuple;
+   t.nkps = dtest->nkps;
+   t.bits = test[0]->ctx->bits;
+   t.bits.rng = NULL;
+   ok = ok && fwrite(&t,sizeof(t),1,fp) == 1;
+   for(i=0;i<dtest->nkps;i++){
+     tp.tsamples = test[i]->tsamples;
+     tp.psamples = test[i]->psamples;
+     tp.ntuple = test[i]->ntuple;
+     tp.ks_pvalue = test[i]->ks_pvalue;
+     ok = ok && fwrite(&tp,sizeof(tp),1,fp) == 1;
+     ok = ok && fwrite(test[i]->pvalues,sizeof(double),tp.psamples,fp) == tp.psamples;
+   }
+ }
+
+ ok = ok && fflush(fp) == 0;
+#if !defined(_WIN32)
+ ok = ok && fsync(fileno(fp)) == 0;
+#endif
+ ok = (fclose(fp) == 0) && ok;
+ if(!ok || rename(tmpname,checkpoint_file) != 0){
+   fprintf(stderr,"# checkpoint: cannot write %s, not checkpointing\n",checkpoint_file);
+   remove(tmpname);
+   checkpoint_file = NULL;
+   return;
+ }
+ ckpt_last = time(NULL);
+ MYDEBUG(D_ALL){
+   fprintf(stdout,"# checkpoint: job %u of %u%s written to %s\n",ckpt_j,ckpt_njobs,
+           test ? " (in progress)" : "",checkpoint_file);
+ }
+
+}
+
+/*
+ * Read the checkpoint (once) and make sure it is for this run.  Any
+ * problem with it is fatal:  a resume that quietly started over would
+ * be worse than none.
+ */
+static void ckpt_fail(const char *why)
+{
+
+ fprintf(stderr,"Error: cannot resume from %s: %s.\n",checkpoint_file,why);
+ exit(1);
+
+}
+
+static void ckpt_load()
+{
+
+ ckpt_header h;
+ unsigned int i;
+ FILE *fp;
+
+ if(ckpt_loaded) return;
+ ckpt_loaded = 1;
+ if((fp = fopen(checkpoint_file,"rb")) == NULL) ckpt_fail("no such file");
+ if(fread(&rh,sizeof(rh),1,fp) != 1 || memcmp(rh.magic,CKPT_MAGIC,sizeof(CKPT_MAGIC)) != 0 ||
+    rh.version != CKPT_VERSION){
+   ckpt_fail("not a dieharder checkpoint");
+ }
+
+ /*
+  * Compare everything but the progress.
+  */
+ ckpt_config(&h);
+ h.njobs = rh.njobs;
+ h.job = rh.job;
+ h.intest = rh.intest;
+ if(memcmp(&h,&rh,sizeof(h)) != 0){
+   ckpt_fail("it was written by a run with a different generator, test or options");
+ }
+
+ rjob = (double *)malloc((rh.njobs + 1)*sizeof(double));
+ if(rh.njobs && fread(rjob,sizeof(double),rh.njobs,fp) != rh.njobs) ckpt_fail("it is truncated");
+ if(fread(&rr,sizeof(rr),1,fp) != 1) ckpt_fail("it is truncated");
+ if(rr.size){
+   rstate = malloc(rr.size);
+   if(fread(rstate,rr.size,1,fp) != 1) ckpt_fail("it is truncated");
+ }
+
+ if(rh.intest){
+   if(fread(&rt,sizeof(rt),1,fp) != 1) ckpt_fail("it is truncated");
+   rtp = (ckpt_pvalues *)malloc(rt.nkps*sizeof(ckpt_pvalues));
+   rtpv = (double **)malloc(rt.nkps*sizeof(double *));
+   for(i=0;i<rt.nkps;i++){
+     if(fread(&rtp[i],sizeof(ckpt_pvalues),1,fp) != 1) ckpt_fail("it is truncated");
+     rtpv[i] = (double *)malloc((rtp[i].psamples + 1)*sizeof(double));
+     if(fread(rtpv[i],sizeof(double),rtp[i].psamples,fp) != rtp[i].psamples){
+       ckpt_fail("it is truncated");
+     }
+   }
+ }
+ fclose(fp);
+
+}
+
+/*
+ * Put the generator back where the checkpoint left it.
+ */
+static void ckpt_restore_rng()
+{
+
+ file_input_state_t *fstate;
+
+ switch(rr.kind){
+   case CKPT_RNG_STATE:
+     if(rr.size != rng->type->size) ckpt_fail("the generator state is the wrong size");
+     memcpy(rng->state,rstate,rr.size);
+     break;
+   case CKPT_RNG_FILE:
+     /*
+      * The file is open and rewound; read our way back to rptr (a mmap'd
+      * file can just be pointed there).
+      */
+     fstate = (file_input_state_t *) rng->state;
+     if(fstate->flen && rr.rptr >= fstate->flen) ckpt_fail("the input file is shorter than it was");
+     if(fstate->map != NULL){
+       fstate->rptr = rr.rptr;
+     } else {
+       while(fstate->rptr < rr.rptr) gsl_rng_get(rng);
+     }
+     fstate->rtot = rr.rtot;
+     fstate->rewind_cnt = rr.rewind_cnt;
+     break;
+   case CKPT_RNG_STREAM:
+     break;
+   default:
+     fprintf(stderr,"# checkpoint: the state of %s cannot be saved, so it goes on from its seed\n",
+             gsl_rng_name(rng));
+     break;
+ }
+
+}
+
+/*
+ * Restore a -a run:  fill in the pvalues of the jobs that are done and
+ * return the job to go on with.  Without --resume, start at 0.
+ */
+unsigned int resume_jobs(Job *job,unsigned int njobs)
+{
+
+ unsigned int j;
+
+ if(!resume || checkpoint_file == NULL) return(0);
+ ckpt_load();
+ if(rh.njobs != njobs) ckpt_fail("it was written for a different list of tests");
+ for(j=0;j<rh.job;j++){
+   job[j].pvalue = rjob[j];
+   job[j].done = YES;
+ }
+ fprintf(stderr,"# checkpoint: resuming %s at test %u of %u\n",checkpoint_file,rh.job + 1,njobs);
+ ckpt_first = rh.job;
+ /*
+  * A test in progress gets its generator back in resume_test(), after
+  * execute_test() has (maybe) reseeded it.
+  */
+ if(!rh.intest) ckpt_restore_rng();
+ return(rh.job);
+
+}
+
+/*
+ * Restore the test that was in progress, if test (just created by
+ * execute_test()) is that test; returns YES if it was.
+ */
+int resume_test(Dtest *dtest,Test **test)
+{
+
+ gsl_rng *bits_rng;
+ unsigned int i,bits_rmax,pcutoff;
+
+ if(!resume || checkpoint_file == NULL) return(NO);
+ ckpt_load();
+ if(!rh.intest || ckpt_j != rh.job) return(NO);
+ if(rt.dtest_num != dtest_num || rt.ntuple != ntuple || rt.nkps != dtest->nkps){
+   ckpt_fail("the test in progress does not match");
+ }
+
+ for(i=0;i<dtest->nkps;i++){
+   /*
+    * The room create_test() made for the pvalues.
+    */
+   pcutoff = (Xtrategy != 0 && Xoff > test[i]->psamples) ? Xoff : test[i]->psamples;
+   if(rtp[i].psamples > pcutoff) ckpt_fail("the test in progress has too many psamples");
+   test[i]->tsamples = rtp[i].tsamples;
+   test[i]->psamples = rtp[i].psamples;
+   test[i]->ntuple = rtp[i].ntuple;
+   test[i]->ks_pvalue = rtp[i].ks_pvalue;
+   test[i]->ks_sorted = 0;
+   memcpy(test[i]->pvalues,rtpv[i],rtp[i].psamples*sizeof(double));
+ }
+
+ ckpt_restore_rng();
+
+ bits_rng = test[0]->ctx->bits.rng;
+ bits_rmax = test[0]->ctx->bits.rmax_bits;
+ test[0]->ctx->bits = rt.bits;
+ test[0]->ctx->bits.rng = bits_rng;
+ test[0]->ctx->bits.rmax_bits = bits_rmax;
+
+ fprintf(stderr,"# checkpoint: resuming %s with %u psamples\n",dtest->sname,test[0]->psamples);
+ rh.intest = 0;
+ return(YES);
+
+}
+
+/*
+ * run_jobs() is about to run job j of job[0..njobs-1] (all but the -a
+ * run have no list).  Everything before it is done, which is worth a
+ * checkpoint.
+ */
+void checkpoint_jobs(Job *job,unsigned int njobs,unsigned int j)
+{
+
+ ckpt_joblist = job;
+ ckpt_njobs = njobs;
+ ckpt_j = j;
+ if(checkpoint_file != NULL && j > ckpt_first) ckpt_write(NULL,NULL);
+
+}
+
+/*
+ * One TTD/RA step of test is done and there will be another, so this
+ * is a good point to checkpoint it (if it has been long enough).
+ */
+void checkpoint_test(Dtest *dtest,Test **test)
+{
+
+ if(checkpoint_file == NULL) return;
+ if(time(NULL) - ckpt_last < checkpoint_interval) return;
+ ckpt_write(dtest,test);
+
+}
+
+/*
+ * The run is complete:  nothing left to resume.
+ */
+void checkpoint_done()
+{
+
+ if(checkpoint_file == NULL) return;
+ remove(checkpoint_file);
+
+}
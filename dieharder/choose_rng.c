@@ -14,7 +14,7 @@
 
 #include "dieharder.h"
 
-int select_rng(int gennum,char *genname,unsigned int initial_seed);
+int select_rng(int gennum,char *genname,unsigned long int initial_seed);
 
 void choose_rng()
 {
@@ -95,7 +95,7 @@ void choose_rng()
 
 int select_rng(int gennum,
                UNUSED_PARAM char *genname,
-               UNUSED_PARAM unsigned int initial_seed)
+               UNUSED_PARAM unsigned long int initial_seed)
 {
  unsigned int i;
 
@@ -320,6 +320,50 @@ int select_rng(int gennum,
 }
 
 
+/*
+ * ========================================================================
+ * select_batch_rng()
+ *
+ * A -G batch (see run_batch()) switches between already validated
+ * generators by number, from the job that is about to run.  This just
+ * (re)allocates rng as the dh_rng_types[gennum] generator, seeds it
+ * with s and sets up the rmax globals the way select_rng() does, with
+ * none of the name lookups, XOR or file checks and no timing.
+ * ========================================================================
+ */
+
+void select_batch_rng(int gennum,unsigned long int s)
+{
+
+ if(rng == NULL || rng->type != dh_rng_types[gennum]){
+   if(rng){
+     gsl_rng_free(rng);
+   }
+   MYDEBUG(D_SEED){
+     fprintf(stdout,"# select_batch_rng(): Creating rng %s\n",
+             dh_rng_types[gennum]->name);
+   }
+   rng = gsl_rng_alloc(dh_rng_types[gennum]);
+ }
+ reset_bit_buffers();
+ generator = gennum;
+ seed = s;
+ gsl_rng_set(rng,seed);
+
+ random_max = rng->type->max;
+ rmax = random_max;
+ rmax_bits = 0;
+ rmax_mask = 0;
+ while(rmax){
+   rmax >>= 1;
+   rmax_mask = rmax_mask << 1;
+   rmax_mask++;
+   rmax_bits++;
+ }
+
+}
+
+
 /*
  * ========================================================================
  * select_XOR()
@@ -62,6 +62,15 @@ int main(int argc, char *argv[])
   * RELATIVE precedence in a core event loop in a UI.
   */
 
+   /*
+    * A -G batch selects, seeds and times each of its generators itself
+    * and runs all of the tests on every one of them (see run_batch()).
+    */
+   if(batch_list != NULL){
+     run_batch();
+     exit(0);
+   }
+
    /*
     * Pick a rng, establish a seed based on how things were initialized
     * in parsecl() or elsewhere.  Note that choose_rng() times the selected
@@ -85,6 +94,8 @@ int main(int argc, char *argv[])
     */
    if(all){
      run_all_tests();
+   } else if(sweep_seeds){
+     run_sweep();
    } else {
      run_test();
    }
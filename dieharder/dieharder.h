@@ -52,6 +52,84 @@ EXTERN double rng_avg_time_nsec, rng_rands_per_second;
 EXTERN int rng_double_rands_per_second;
 EXTERN double strategy;
 
+/*
+ * -a(ll) runs are split up into a list of jobs, one per call to
+ * execute_test(), that run_jobs() executes either in order in this
+ * process (workers = 0 or 1) or in up to workers forked processes at
+ * once (-j workers).  Without -j (workers = 0, the default) the tests
+ * share the one stream of rng, as they always have.  With any -j, even
+ * -j 1, each job reseeds rng with job->seed, which is drawn in job order
+ * from the run seed, so a run is reproducible (with -S) independent of
+ * the number of workers.  Output is replayed and ks_pvalues[] is filled
+ * in the usual test order either way.
+ *
+ *   dtest_num is the test to run, ntuple the ntuple to run it with.
+ *   group is the ks_pvalues[] slot the pvalue is averaged into, or -1
+ *     if the test is to be skipped (or is not there at all).
+ *   announce prints a "Preparing to run test" line first.
+ *   gennum is the dh_rng_types[] generator the job runs on in a -G
+ *     batch (see run_batch()), -1 for the one selected generator.
+ *   kind is JOB_TEST for a test.  A batch also brackets the tests of
+ *     each generator with a JOB_HEADER job, which selects and seeds
+ *     (with seed) and times the generator and prints its rng header, and
+ *     a JOB_FOOTER job, which prints the -a summary of the span jobs
+ *     before it once they are all done.  A -E seed sweep is made of
+ *     JOB_SWEEP jobs, tests that run from their own seed (not one drawn
+ *     from the run seed) and keep all of their ks_pvalues in ks_pvalues.
+ */
+#define JOB_TEST 0
+#define JOB_HEADER 1
+#define JOB_FOOTER 2
+#define JOB_SWEEP 3
+
+typedef struct {
+  int dtest_num;
+  unsigned int ntuple;
+  int group;
+  unsigned int announce;
+  unsigned long int seed;
+  double pvalue;
+  FILE *out,*err;
+  pid_t pid;
+  unsigned int done;
+  int gennum;
+  unsigned int kind;
+  unsigned int span;
+  double *ks_pvalues;
+} Job;
+
+EXTERN unsigned int workers;
+
+/*
+ * -G list runs -a on every generator in the list (numbers, names and
+ * number ranges, comma separated) as one batch of jobs.
+ */
+EXTERN char *batch_list;
+
+/*
+ * -E nseeds runs the -d test from each of nseeds seeds in turn and
+ * tests the ks_pvalues it gets against U[0,1) (see run_sweep()).  When
+ * ks_pvalue_save is not NULL execute_test() leaves every ks_pvalue of
+ * the test in it.
+ */
+EXTERN unsigned int sweep_seeds;
+EXTERN double *ks_pvalue_save;
+
+/*
+ * With -b, -a runs the rgb_bitdist ntuple series as the single pass
+ * rgb_bitdist_sweep test instead of one test per ntuple.
+ */
+EXTERN unsigned int bitdist_sweep;
+
+/*
+ * -K file checkpoints the run to file (see checkpoint.c) at most every
+ * checkpoint_interval seconds (--checkpoint-interval) and whenever a
+ * test ends, and --resume (resume) picks it up from there.
+ */
+EXTERN char *checkpoint_file;
+EXTERN unsigned int resume;
+EXTERN unsigned int checkpoint_interval;
+
 #ifdef RDIEHARDER
  EXTERN Test **rdh_testptr;		/* kludge: need a global to report back to R */
  EXTERN Dtest *rdh_dtestptr;		/* kludge: need a global to report back to R */
@@ -65,11 +143,25 @@ EXTERN double strategy;
  void set_globals();
  void choose_rng();
  double execute_test(int);
+ void select_batch_rng(int gennum,unsigned long int s);
+ void run_jobs(Job *job,unsigned int njobs);
  void run_all_tests();
+ void all_tests_footer(Job *job,unsigned int njobs);
+ void run_batch();
  void run_test();
+ int select_test();
+ void run_sweep();
+ unsigned int resume_jobs(Job *job,unsigned int njobs);
+ int resume_test(Dtest *dtest,Test **test);
+ void checkpoint_jobs(Job *job,unsigned int njobs,unsigned int j);
+ void checkpoint_test(Dtest *dtest,Test **test);
+ void checkpoint_done();
  void add_ui_rngs();
  void parsecl(int argc, char **argv);
  void output(Dtest *dtest,Test **test);
+ void output_header();
+ void output_batch_header();
+ void output_rng_header();
  void show_test_header(Dtest *dtest,Test **test);
  void show_test_header_debug(Dtest *dtest,Test **test);
  void test_header(Dtest *dtest);
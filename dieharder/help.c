@@ -50,10 +50,13 @@ void Usage()
  fprintf(stdout, "\n\
 Usage:\n\
 \n\
-dieharder [-a] [-d dieharder test number] [-f filename] [-B]\n\
-          [-D output flag [-D output flag] ... ] [-F] [-c separator]\n\
-          [-g generator number or -1] [-h] [-k ks_flag] [-l] \n\
-          [-L overlap] [-m multiply_p] [-n ntuple] \n\
+dieharder [-a] [-b] [-d dieharder test number] [-f filename] [-B] [-C]\n\
+          [-D output flag [-D output flag] ... ] [-E nseeds] [-F]\n\
+          [-c separator]\n\
+          [-g generator number or -1] [-G generator list] [-h]\n\
+          [-j workers] [-K checkpoint file [--resume]\n\
+          [--checkpoint-interval seconds]] [-k ks_flag] [-l] [-L overlap]\n\
+          [-m multiply_p] [-n ntuple]\n\
           [-p number of p samples] [-P Xoff]\n\
           [-o filename] [-s seed strategy] [-S random number seed]\n\
           [-n ntuple] [-p number of p samples] [-o filename]\n\
@@ -63,6 +66,8 @@ dieharder [-a] [-d dieharder test number] [-f filename] [-B]\n\
           [-x xvalue] [-y yvalue] [-z zvalue]\n");
 fprintf(stdout, "\n\
   -a - runs all the tests with standard/default options to create a report\n\
+  -b - with -a, run the rgb_bitdist ntuple 1 to 12 series as one pass over\n\
+     the same bits (the rgb_bitdist_sweep test) instead of twelve tests.\n\
   -d test number -  selects specific diehard test.\n\
   -f filename - generators 201 or 202 permit either raw binary or \n\
      formatted ASCII numbers to be read in from a file for testing.\n\
@@ -76,16 +81,41 @@ fprintf(stdout, "\n\
      Raw binary input reads 32 bit increments of the specified data stream.\n\
      stdin_input_raw accepts a pipe from a raw binary stream.\n\
   -B binary output (used with -o)\n\
+  -C with -g 202, convert the ASCII input file to raw binary once, in\n\
+     filename.raw, and read the rands from that on this and later runs.\n\
+     It is rebuilt if the input file changes.\n\
   -D output flag - permits fields to be selected for inclusion in dieharder\n\
      output.  Each flag can be entered as a binary number that turns\n\
      on a specific output field or header or by flag name; flags are\n\
      aggregated.  To see all currently known flags use the -F command.\n\
+  -E nseeds - with -d, run the test once from each of nseeds seeds, -S\n\
+     seed (or a random one) and up, in parallel with -j, then test each\n\
+     of its ks_pvalues over the seeds for uniformity (KS and Kuiper, the\n\
+     latter only from 10 seeds up).  Ignored with -a or -G.\n\
   -F - lists all known flags by name and number.\n\
   -c table separator - where separator is e.g. ',' (CSV) or ' ' (whitespace).\n\
   -g generator number - selects a specific generator for testing.  Using\n\
      -1 causes all known generators to be printed out to the display.\n\
+  -G generator list - runs -a on every generator in the list, one after\n\
+     the other as one batch of tests (in parallel with -j), and ends with a\n\
+     table of their summaries.  The list is comma separated generator\n\
+     numbers, names and ranges, e.g. -G 216,224,235-242,xoshiro256++.\n\
   -h prints context-sensitive help -- usually Usage (this message) or a\n\
-     test synopsis if entered as e.g. dieharder -D 3 -h.\n\
+     test synopsis if entered as e.g. dieharder -D 3 -h.\n");
+ fprintf(stdout,
+"  -j workers - with -a, run up to this many tests at the same time, each\n\
+     in its own process with its own copy of the generator, reseeded from\n\
+     the run seed (-S) in test order so a run can be reproduced.  Results\n\
+     are still reported in the usual test order, and -j 1 gives the same\n\
+     results one test at a time.  Without -j the tests share the one\n\
+     stream of the generator as always.  File and stdin input always run\n\
+     one test at a time.\n\
+  -K file - checkpoint a -d or -a run to file:  the tests that are done,\n\
+     every pvalue of the one in progress and the generator state (or the\n\
+     file_input position).  A test is saved between -Y 1/2 steps, at most\n\
+     once a minute (--checkpoint-interval seconds).  Run the same command\n\
+     with --resume to pick the run up where it stopped.  XOR, ca, uvag and\n\
+     sfmt go on from their seed.  Runs one test at a time (-j still seeds).\n\
   -k ks_flag - ks_flag\n\
 \n\
      0 is fast but slightly sloppy for psamples > 4999 (default).\n\
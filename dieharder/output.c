@@ -39,7 +39,50 @@ void output(Dtest *dtest,Test **test)
  /*
   * Show the table header at most one time.
   */
- static unsigned int firstcall = 1;
+ output_header();
+
+ /*
+  * This almost certainly belongs in the show_test_results section,
+  * possibly with additional conditionals rejecting test results involving
+  * rewinds, period.
+  */
+ if(strncmp("file_input",gsl_rng_name(rng),10) == 0){
+   /*
+    * This needs its own output flag and field.  I'm losing it for now.
+   if(!quiet){
+     fprintf(stdout,"# %u rands were used in this test\n",file_input_get_rtot(rng));
+     fflush(stdout);
+   }
+    */
+   if(file_input_get_rewind_cnt(rng) != 0){
+     fprintf(stderr,"# The file %s was rewound %u times\n",gsl_rng_name(rng),file_input_get_rewind_cnt(rng));
+     fflush(stderr);
+   }
+ }
+
+ /*
+  * Everything below is the output PER TEST.  It cannot be skipped,
+  * although I suppose it can be empty if no non-header output flags are
+  * turned on.
+  */
+ output_table_line(dtest,test);
+
+#endif
+
+}
+
+/*
+ * The table header (version, rng information and the table line header)
+ * is shown at most one time per run.  output() calls this on its first
+ * call; run_jobs() calls it directly before it starts any parallel
+ * workers, so that their output follows a single header.
+ */
+static unsigned int firstcall = 1;
+
+void output_header()
+{
+
+#if !defined(RDIEHARDER)
  if(firstcall){
 
    /*
@@ -75,32 +118,39 @@ void output(Dtest *dtest,Test **test)
 
  }
 
- /*
-  * This almost certainly belongs in the show_test_results section,
-  * possibly with additional conditionals rejecting test results involving
-  * rewinds, period.
-  */
- if(strncmp("file_input",gsl_rng_name(rng),10) == 0){
-   /*
-    * This needs its own output flag and field.  I'm losing it for now.
-   if(!quiet){
-     fprintf(stdout,"# %u rands were used in this test\n",file_input_get_rtot(rng));
-     fflush(stdout);
-   }
-    */
-   if(file_input_get_rewind_cnt(rng) != 0){
-     fprintf(stderr,"# The file %s was rewound %u times\n",gsl_rng_name(rng),file_input_get_rewind_cnt(rng));
-     fflush(stderr);
-   }
+#endif
+
+}
+
+/*
+ * In a -G batch the version header is printed just once, up front, by
+ * output_batch_header(), and each generator then gets its own rng
+ * information and table line header, printed by its JOB_HEADER job
+ * (see run_jobs.c) instead of by the first output().
+ */
+void output_batch_header()
+{
+
+#if !defined(RDIEHARDER)
+ if(tflag & THEADER){
+   dh_header();
  }
+ firstcall = 0;
+#endif
 
- /*
-  * Everything below is the output PER TEST.  It cannot be skipped,
-  * although I suppose it can be empty if no non-header output flags are
-  * turned on.
-  */
- output_table_line(dtest,test);
+}
 
+void output_rng_header()
+{
+
+#if !defined(RDIEHARDER)
+ if(tflag & TSHOW_RNG){
+   output_rng_info();
+ }
+ if((tflag & TLINE_HEADER) && !(tflag & THISTOGRAM)){
+   output_table_line_header();
+ }
+ firstcall = 0;
 #endif
 
 }
@@ -24,6 +24,18 @@
 char table_entry[TLENGTH];
 int show_flags = 0;
 
+/*
+ * The few options that only have a long form.
+ */
+#define OPT_RESUME 256
+#define OPT_CHECKPOINT_INTERVAL 257
+
+static struct option long_options[] = {
+  {"resume",no_argument,NULL,OPT_RESUME},
+  {"checkpoint-interval",required_argument,NULL,OPT_CHECKPOINT_INTERVAL},
+  {NULL,0,NULL,0}
+};
+
 void parsecl(int argc, char **argv)
 {
 
@@ -53,14 +65,21 @@ void parsecl(int argc, char **argv)
     exit(1); /* count this as an error */
  }
 
- while ((c = getopt(argc,argv,"aBc:D:d:Ff:g:hi:k:lL:m:n:oO:p:P:S:s:t:Vv:W:X:x:Y:y:Z:z:")) != EOF){
+ while ((c = getopt_long(argc,argv,"abBCc:D:d:E:Ff:g:G:hi:j:K:k:lL:m:n:oO:p:P:S:s:t:Vv:W:X:x:Y:y:Z:z:",
+                          long_options,NULL)) != EOF){
    switch (c){
      case 'a':
        all = YES;
        break;
+     case 'b':
+       bitdist_sweep = 1;
+       break;
      case 'B':
        binary = 1;
        break;
+     case 'C':
+       file_input_cache = 1;
+       break;
      case 'c':
        /* printf("Setting separator to %c\n",optarg[0]); */
        table_separator = (char) optarg[0];
@@ -137,6 +156,15 @@ void parsecl(int argc, char **argv)
          dtest_num = dtest_tmp;
        }
        break;
+     case 'E':
+       itmp = strtol(optarg,(char **) NULL,10);
+       if(itmp > 0){
+         sweep_seeds = itmp;
+       } else {
+         fprintf(stderr,"Warning!  -E %d: need at least one seed, not sweeping.\n",itmp);
+         sweep_seeds = 0;
+       }
+       break;
      case 'F':
        show_flags = 1;
        break;
@@ -172,12 +200,33 @@ void parsecl(int argc, char **argv)
          exit(1);
        }
        break;
+     /*
+      * -G is a whole batch of generators, each run through -a.  The
+      * list is taken apart in run_batch(), once dh_rng_types[] is there
+      * to look the names up in.
+      */
+     case 'G':
+       batch_list = optarg;
+       all = YES;
+       break;
      case 'h':
        help_flag = YES;
        break;
      case 'i':
        iterations = strtol(optarg,(char **) NULL,10);
        break;
+     case 'j':
+       itmp = strtol(optarg,(char **) NULL,10);
+       if(itmp > 0){
+         workers = itmp;
+       } else {
+         fprintf(stderr,"Warning!  -j %d: need at least one worker, using 1.\n",itmp);
+         workers = 1;
+       }
+       break;
+     case 'K':
+       checkpoint_file = optarg;
+       break;
      case 'k':
        ks_test = strtol(optarg,(char **) NULL,10);
        break;
@@ -214,7 +263,7 @@ void parsecl(int argc, char **argv)
        psamples = strtol(optarg,(char **) NULL,10);
        break;
      case 'S':
-       Seed = strtol(optarg,(char **) NULL,10);
+       Seed = strtoul(optarg,(char **) NULL,10);
        gseeds[gscount] = gen_tmp;
        gscount++;
        break;
@@ -263,6 +312,13 @@ void parsecl(int argc, char **argv)
      case 'z':
        z_user = strtod(optarg,(char **) NULL);
        break;
+     case OPT_RESUME:
+       resume = YES;
+       break;
+     case OPT_CHECKPOINT_INTERVAL:
+       itmp = strtol(optarg,(char **) NULL,10);
+       checkpoint_interval = (itmp > 0) ? itmp : 0;
+       break;
      case '?':
        errflg++;
    }
@@ -332,6 +388,20 @@ void parsecl(int argc, char **argv)
      Exit(1);
    }
    
+   if(sweep_seeds && (all || batch_list != NULL)){
+     fprintf(stderr,"Warning!  -E sweeps the seeds of one -d test, ignoring it with %s.\n",
+             batch_list != NULL ? "-G" : "-a");
+     sweep_seeds = 0;
+   }
+   if(checkpoint_file != NULL && (batch_list != NULL || sweep_seeds)){
+     fprintf(stderr,"Error: -K checkpoints -d and -a runs, not -G or -E.\n");
+     Exit(1);
+   }
+   if(resume && checkpoint_file == NULL){
+     fprintf(stderr,"Error: --resume needs -K file, the checkpoint to resume from.\n");
+     Exit(1);
+   }
+
    /*
     * If help was requested, call the help routine.  This routine does
     * different things depending on the other flags and variables, so
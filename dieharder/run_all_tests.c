@@ -19,14 +19,76 @@
 
 double ks_pvalues[MAXTESTS] = {0};
 
-void run_all_tests()
+/*
+ * The -a(ll) run is first laid out as a list of jobs (one per call to
+ * execute_test(), in the order they are reported) and then handed to
+ * run_jobs(), which may run them in parallel (-j).  Each job carries the
+ * ks_pvalues[] slot (group) its pvalue is averaged into, and in a -G
+ * batch the generator (job_gennum when it was laid out) it runs on.
+ */
+static Job *joblist = NULL;
+static unsigned int njobs = 0,jobmax = 0;
+static int job_gennum = -1;
+
+static Job *new_job(unsigned int kind)
+{
+
+ if(njobs == jobmax){
+   jobmax = jobmax ? 2*jobmax : 128;
+   joblist = (Job *)realloc(joblist,jobmax*sizeof(Job));
+ }
+ memset(&joblist[njobs],0,sizeof(Job));
+ joblist[njobs].done = NO;
+ joblist[njobs].gennum = job_gennum;
+ joblist[njobs].kind = kind;
+ return(&joblist[njobs++]);
+
+}
+
+static void add_job(int dnum,unsigned int nt,int group,unsigned int announce)
+{
+
+ Job *job = new_job(JOB_TEST);
+
+ job->dtest_num = dnum;
+ job->ntuple = nt;
+ job->group = group;
+ job->announce = announce;
+
+}
+
+/*
+ * The dh_test_types[] number of a test by name, or -1.  Tests parked at
+ * 900+ (see dieharder_test_types.c) have no fixed number, and the Dtest
+ * each test header declares is a static copy, so its address can't be
+ * compared with dh_test_types[] either.
+ */
+static int find_test(const char *sname)
+{
+
+ int i;
+
+ for(i=0;i<MAXTESTS;i++){
+   if(dh_test_types[i] && strncmp(dh_test_types[i]->sname,sname,128) == 0){
+     return(i);
+   }
+ }
+ return(-1);
+
+}
+
+/*
+ * Lay out the -a(ll) jobs for one generator; returns the number of
+ * ks_pvalues[] groups they fill.
+ */
+static unsigned int add_all_tests()
 {
 
  /*
   * The nt variables control ntuple loops for the -a(ll) display only.
   */
-  unsigned int ntmin,ntmax,ntsave,i,num = 0;
-  double mean,stddev;
+  unsigned int ntmin,ntmax,i,num = 0;
+  int sweep_num;
 
  /*
   * This isn't QUITE a simple loop because -a is a dieharder-only function,
@@ -40,7 +102,7 @@ void run_all_tests()
  for(dtest_num=0; (unsigned)dtest_num < dh_num_diehard_tests; dtest_num++){
    // skip the "Do not use" diehard_sums test, rgb_lagged_sum is much better
    if(dh_test_types[dtest_num] && dtest_num != 14){
-     ks_pvalues[num++] = execute_test(dtest_num);
+     add_job(dtest_num,ntuple,num++,NO);
    }
  }
 
@@ -49,7 +111,7 @@ void run_all_tests()
   */
  for(dtest_num=100; (unsigned)dtest_num < 100+dh_num_sts_tests; dtest_num++){
    if(dh_test_types[dtest_num]){
-     ks_pvalues[num++] = execute_test(dtest_num);
+     add_job(dtest_num,ntuple,num++,NO);
    }
  }
 
@@ -77,10 +139,15 @@ void run_all_tests()
 	    * We might need to check to be sure it is "doable", but probably
 	    * not...
             */
-           ks_pvalues[num++] = execute_test(dtest_num);
+           add_job(dtest_num,ntuple,num++,NO);
+         } else if(bitdist_sweep &&
+                   (sweep_num = find_test(rgb_bitdist_sweep_dtest.sname)) >= 0){
+           /*
+            * The same series all in one pass with rgb_bitdist_sweep (see
+            * rgb_bitdist.c).
+            */
+           add_job(sweep_num,ntuple,num++,NO);
          } else {
-           double *avg;
-           unsigned cnt;
            /*
             * Default is to test 1 through 8 bits, which takes a while on my
             * (quite fast) laptop but is a VERY thorough test of randomness
@@ -89,21 +156,10 @@ void run_all_tests()
            ntmin = 1;
            ntmax = 12;
            /* ntmax = 8; */
-           cnt = ntmax - ntmin + 1;
-           avg = calloc (cnt, 8);
-           i = 0;
-           /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
-           for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-             avg[i++] = execute_test(dtest_num);
+           for(i = ntmin;i <= ntmax;i++){
+             add_job(dtest_num,i,num,NO);
            }
-           ks_pvalues[num++] = gsl_stats_mean (avg, 1, cnt);
-           free (avg);
-
-           /*
-            * This RESTORES ntuple = 0, which is the only way we could have
-            * gotten here in the first place!
-            */
-           ntuple = 0;
+           num++;
 
 	 }
        }
@@ -122,37 +178,21 @@ void run_all_tests()
             * but only if it is in bounds.
             */
            if(ntuple < 2 || ntuple > 5){
-             ntsave = ntuple;
-             ntuple = 5;  /* This is the hardest test anyway */
-             ks_pvalues[num++] = execute_test(dtest_num);
-             ntuple = ntsave;
+             add_job(dtest_num,5,num++,NO);  /* This is the hardest test anyway */
            } else {
-             ks_pvalues[num++] = execute_test(dtest_num);
+             add_job(dtest_num,ntuple,num++,NO);
            }
          } else {
            /*
             * Default is to 2 through 5 dimensions, all that are supported by
             * the test.
             */
-           double *avg;
-           unsigned cnt;
            ntmin = 2;
            ntmax = 5;
-           cnt = ntmax - ntmin + 1;
-           avg = calloc (cnt, 8);
-           i = 0;
-           /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
-           for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-	     avg[i++] = execute_test(dtest_num);
-	   }
-           ks_pvalues[num++] = gsl_stats_mean (avg, 1, cnt);;
-           free (avg);
-
-           /*
-            * This RESTORES ntuple = 0, which is the only way we could have
-            * gotten here in the first place!
-            */
-           ntuple = 0;
+           for(i = ntmin;i <= ntmax;i++){
+             add_job(dtest_num,i,num,NO);
+           }
+           num++;
 	 }
        }
        break;
@@ -170,37 +210,21 @@ void run_all_tests()
             * but only if it is in bounds.
             */
            if(ntuple < 2){
-             ntsave = ntuple;
-             ntuple = 5;  /* This is the default operm5 value */
-             ks_pvalues[num++] = execute_test(dtest_num);
-             ntuple = ntsave;
+             add_job(dtest_num,5,num++,NO);  /* This is the default operm5 value */
            } else {
-             ks_pvalues[num++] = execute_test(dtest_num);
+             add_job(dtest_num,ntuple,num++,NO);
            }
          } else {
            /*
             * Default is to 2 through 5 permutations.  Longer than 5 takes
 	    * a LONG TIME and must be done by hand.
             */
-           double *avg;
-           unsigned cnt;
            ntmin = 2;
            ntmax = 5;
-           cnt = ntmax - ntmin + 1;
-           avg = calloc (cnt, 8);
-           i = 0;
-           /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
-           for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-	     avg[i++] = execute_test(dtest_num);
-	   }
-           ks_pvalues[num++] = gsl_stats_mean (avg, 1, cnt);
-           free (avg);
-
-           /*
-            * This RESTORES ntuple = 0, which is the only way we could have
-            * gotten here in the first place!
-            */
-           ntuple = 0;
+           for(i = ntmin;i <= ntmax;i++){
+             add_job(dtest_num,i,num,NO);
+           }
+           num++;
 	 }
        }
        break;
@@ -216,30 +240,17 @@ void run_all_tests()
            /*
             * If ntuple is set to be nonzero, just use that value in "all".
             */
-           ks_pvalues[num++] = execute_test(dtest_num);
+           add_job(dtest_num,ntuple,num++,NO);
          } else {
            /*
             * Do all lags from 0 to 32.
             */
-           double *avg;
-           unsigned cnt;
            ntmin = 0;
            ntmax = 32;
-           cnt = ntmax - ntmin + 1;
-           avg = calloc (cnt, 8);
-           i = 0;
-           /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
-           for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-	     avg[i++] = execute_test(dtest_num);
-	   }
-           ks_pvalues[num++] = gsl_stats_mean (avg, 1, cnt);
-           free (avg);
-
-           /*
-            * This RESTORES ntuple = 0, which is the only way we could have
-            * gotten here in the first place!
-            */
-           ntuple = 0;
+           for(i = ntmin;i <= ntmax;i++){
+             add_job(dtest_num,i,num,NO);
+           }
+           num++;
 	 }
        }
        break;
@@ -250,7 +261,7 @@ void run_all_tests()
      case 204:
 
        if(dh_test_types[dtest_num]){
-         ks_pvalues[num++] = execute_test(dtest_num);
+         add_job(dtest_num,ntuple,num++,NO);
        }
        break;
 
@@ -260,7 +271,7 @@ void run_all_tests()
      case 205:
 
        if(dh_test_types[dtest_num]){
-         ks_pvalues[num++] = execute_test(dtest_num);
+         add_job(dtest_num,ntuple,num++,NO);
        }
        break;
 
@@ -270,7 +281,7 @@ void run_all_tests()
      case 206:
 
        if(dh_test_types[dtest_num]){
-         ks_pvalues[num++] = execute_test(dtest_num);
+         add_job(dtest_num,ntuple,num++,NO);
        }
        break;
 
@@ -278,13 +289,14 @@ void run_all_tests()
       * Test 207 dab_filltree is broken
       */
      case 207:
-       printf("Skipping test %d\n",dtest_num);
+       add_job(dtest_num,ntuple,-1,NO);
        break;
 
    default:
-       printf("Preparing to run test %d.  ntuple = %d\n",dtest_num,ntuple);
        if(dh_test_types[dtest_num]){   /* This is the fallback to normal tests */
-         ks_pvalues[num++] = execute_test(dtest_num);
+         add_job(dtest_num,ntuple,num++,YES);
+       } else {
+         add_job(dtest_num,ntuple,-1,YES);  /* just the announcement */
        }
        break;
    }
@@ -294,11 +306,72 @@ void run_all_tests()
   * Future expansion in -a tests...
  for(dtest_num=600;dtest_num<600+dh_num_user_tests;dtest_num++){
    if(dh_test_types[dtest_num]){
-     ks_pvalues[num++] = execute_test(dtest_num);
+     add_job(dtest_num,ntuple,num++,NO);
    }
  }
   */
 
+  return(num);
+
+}
+
+/*
+ * Reduce the finished jobs of one -a run to one pvalue per test in
+ * ks_pvalues[], averaging over the ntuple series where there is one,
+ * and return the number of tests.
+ */
+static unsigned int all_tests_reduce(Job *job,unsigned int njobs)
+{
+
+ unsigned int i,j,cnt,num = 0;
+ double *avg;
+
+ for(j=0;j<njobs;){
+   if(job[j].group < 0){
+     j++;
+     continue;
+   }
+   for(cnt = 1;j+cnt < njobs && job[j+cnt].group == job[j].group;cnt++);
+   if(cnt == 1){
+     ks_pvalues[job[j].group] = job[j].pvalue;
+   } else {
+     avg = calloc (cnt, 8);
+     for(i = 0;i < cnt;i++) avg[i] = job[j+i].pvalue;
+     ks_pvalues[job[j].group] = gsl_stats_mean (avg, 1, cnt);
+     free (avg);
+   }
+   if((unsigned int)job[j].group >= num) num = job[j].group + 1;
+   j += cnt;
+ }
+
+ return(num);
+
+}
+
+void run_all_tests()
+{
+
+ add_all_tests();
+ run_jobs(joblist,njobs);
+ all_tests_footer(joblist,njobs);
+ checkpoint_done();
+ nullfree(joblist);
+ njobs = jobmax = 0;
+
+}
+
+/*
+ * The footer of an -a run:  the mean and stddev of ks_pvalues[] over
+ * its jobs.
+ */
+void all_tests_footer(Job *job,unsigned int njobs)
+{
+
+ unsigned int num;
+ double mean,stddev;
+
+ num = all_tests_reduce(job,njobs);
+
  /* Footer: summary of all scaled abs(p-values - 0.5), the deviation of the ideal 0.5.
     0.0 is best */
  fprintf(stdout,"#=============================================================================#\n");
@@ -321,3 +394,167 @@ void run_all_tests()
  fprintf(stdout,"\n");
  fflush(stdout);
 }
+
+/*
+ *========================================================================
+ * run_batch() runs -a on every generator in the -G list as one list of
+ * jobs:  each generator's tests, laid out exactly as run_all_tests()
+ * lays them out, between a header job that selects, seeds and times it
+ * and a footer job that prints its summary.  With -j the tests of all
+ * of the generators share the one pool of workers, so the last tests of
+ * one generator overlap the first of the next, and the report still
+ * reads generator by generator, as a series of -a runs would.  It ends
+ * with a table of every generator's summary.
+ *
+ * The list is comma separated generator numbers, names and ranges of
+ * numbers (lo-hi), e.g. -G 216,224,235-242,xoshiro256++.  Empty slots
+ * in a range are passed over, as are the file and stdin inputs and XOR,
+ * which need more than a number to run.
+ *========================================================================
+ */
+
+static int batch_lookup(const char *name)
+{
+
+ int i;
+
+ for(i=0;i<MAXRNGS;i++){
+   if(dh_rng_types[i] && strncmp(dh_rng_types[i]->name,name,20) == 0){
+     return(i);
+   }
+ }
+ return(-1);
+
+}
+
+static int batch_usable(int gennum)
+{
+
+ const char *name;
+
+ if(gennum < 0 || gennum >= MAXRNGS || dh_rng_types[gennum] == NULL) return(0);
+ name = dh_rng_types[gennum]->name;
+ if(name[0] == 0) return(0);
+ if(strncmp("file_input",name,10) == 0 ||
+    strncmp("stdin_input_raw",name,15) == 0 ||
+    strncmp("XOR",name,3) == 0){
+   fprintf(stderr,"# run_batch(): %s cannot be run in a -G batch, skipping it\n",name);
+   return(0);
+ }
+ return(1);
+
+}
+
+void run_batch()
+{
+
+ char *list,*tok,*endptr;
+ int *gens = NULL;
+ unsigned int ngens = 0,gmax = 0,i,j,first,num;
+ long lo,hi = -1,g;
+ Job *job;
+ double mean,stddev;
+
+ /*
+  * Take the list apart.
+  */
+ list = (char *)malloc(strlen(batch_list) + 1);
+ strcpy(list,batch_list);
+ for(tok = strtok(list,",");tok != NULL;tok = strtok((char *) NULL,",")){
+   lo = strtol(tok,&endptr,10);
+   if(endptr == tok){
+     lo = hi = batch_lookup(tok);
+     if(lo < 0){
+       fprintf(stderr,"Error: -G %s: no generator by that name.\n",tok);
+       Exit(1);
+     }
+   } else if(*endptr == '-'){
+     tok = endptr + 1;
+     hi = strtol(tok,&endptr,10);
+     if(endptr == tok || *endptr != 0 || hi < lo){
+       fprintf(stderr,"Error: -G %ld-%s is not a range of generators.\n",lo,tok);
+       Exit(1);
+     }
+   } else if(*endptr == 0){
+     hi = lo;
+   } else {
+     fprintf(stderr,"Error: -G %s is not a generator.\n",tok);
+     Exit(1);
+   }
+   for(g = lo;g <= hi;g++){
+     if(lo == hi && (g < 0 || g >= MAXRNGS || dh_rng_types[g] == NULL)){
+       fprintf(stderr,"Error: -G %ld: no generator by that number.\n",g);
+       Exit(1);
+     }
+     if(!batch_usable(g)) continue;
+     if(ngens == gmax){
+       gmax = gmax ? 2*gmax : 32;
+       gens = (int *)realloc(gens,gmax*sizeof(int));
+     }
+     gens[ngens++] = g;
+   }
+ }
+ free(list);
+ if(ngens == 0){
+   fprintf(stderr,"Error: -G %s has no generators to test.\n",batch_list);
+   Exit(1);
+ }
+
+ /*
+  * Lay out the jobs, generator by generator.  Each generator gets its
+  * own run seed (Seed, or a fresh random one), carried by its header.
+  */
+ for(i=0;i<ngens;i++){
+   job_gennum = gens[i];
+   job = new_job(JOB_HEADER);
+   job->dtest_num = -1;
+   job->seed = Seed ? Seed : random_seed();
+   first = njobs;
+   add_all_tests();
+   job = new_job(JOB_FOOTER);
+   job->dtest_num = -1;
+   job->group = -1;
+   job->span = njobs - 1 - first;
+ }
+ job_gennum = -1;
+
+ output_batch_header();
+ select_batch_rng(gens[0],joblist[0].seed);
+ run_jobs(joblist,njobs);
+
+ /*
+  * The table of summaries, one line per generator, from the jobs
+  * between each header and footer.
+  */
+ fprintf(stdout,"#=============================================================================#\n");
+ if(tflag & TNO_WHITE){
+   fprintf(stdout,"#rng_name%cnum%cmean%cstddev%c\n",
+           table_separator,table_separator,table_separator,table_separator);
+ } else {
+   fprintf(stdout,"#%20s%c%4s%c   mean  %c  stddev %c  error-rate (best = 0.0, worst = 0.5)\n",
+           "rng_name        ",table_separator,"num",table_separator,
+           table_separator,table_separator);
+ }
+ fprintf(stdout,"#=============================================================================#\n");
+ for(j=0;j<njobs;j++){
+   if(joblist[j].kind != JOB_FOOTER) continue;
+   num = all_tests_reduce(&joblist[j] - joblist[j].span,joblist[j].span);
+   mean = gsl_stats_mean (ks_pvalues, 1, num);
+   stddev = gsl_stats_sd_m (ks_pvalues, 1, num, mean);
+   if(tflag & TNO_WHITE){
+     fprintf(stdout,"%s%c%d%c%.6f%c%.6f%c\n",dh_rng_types[joblist[j].gennum]->name,
+             table_separator,joblist[j].gennum,table_separator,
+             mean,table_separator,stddev,table_separator);
+   } else {
+     fprintf(stdout," %20s%c%4d%c%.6f  %c%.6f  %c\n",dh_rng_types[joblist[j].gennum]->name,
+             table_separator,joblist[j].gennum,table_separator,
+             mean,table_separator,stddev,table_separator);
+   }
+ }
+ fflush(stdout);
+
+ free(gens);
+ nullfree(joblist);
+ njobs = jobmax = 0;
+
+}
@@ -0,0 +1,329 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * run_jobs() executes a list of jobs (see dieharder.h), each a single
+ * call to execute_test().  Without -j it just runs them in order,
+ * exactly the way run_all_tests() always has.  With -j workers every
+ * job is reseeded from its own seed, drawn in job order from the run
+ * seed, and with workers > 1 it forks up to workers processes at a
+ * time, one per job.  A forked worker has its own copy of every global
+ * -- rng, the bit buffers, the test statics -- so the tests themselves
+ * need no changes to run side by side.  Each worker writes its stdout
+ * and stderr into private tmpfiles and its pvalue into a shared page;
+ * the parent replays the tmpfiles in job order as soon as each job and
+ * all of the jobs before it are done, so the report reads exactly like
+ * a sequential one (-j 1) with the same seeds.
+ *
+ * A -G batch (see run_batch()) is just a longer list, the tests of
+ * every generator in turn, each run bracketed by a header job (run like
+ * a test, in a worker) and a footer job (run here, as it is replayed).
+ *========================================================================
+ */
+
+#include "dieharder.h"
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <signal.h>
+#endif
+
+static void run_job(Job *job)
+{
+
+ unsigned int ntsave;
+ unsigned long int Ssave;
+
+ if(job->kind == JOB_HEADER){
+   select_batch_rng(job->gennum,job->seed);
+   if(tflag & TRATE){
+     time_rng();
+   }
+   output_rng_header();
+   return;
+ }
+ if(job->kind == JOB_FOOTER){
+   all_tests_footer(job - job->span,job->span);
+   return;
+ }
+
+ if(job->announce){
+   printf("Preparing to run test %d.  ntuple = %d\n",job->dtest_num,job->ntuple);
+ }
+ if(job->group < 0){
+   if(!job->announce) printf("Skipping test %d\n",job->dtest_num);
+   return;
+ }
+
+ /*
+  * A sweep job starts from its own seed, and so does every reseed
+  * (-s 1) within it.
+  */
+ Ssave = Seed;
+ if(job->kind == JOB_SWEEP){
+   Seed = seed = job->seed;
+   gsl_rng_set(rng,seed);
+   reset_bit_buffers();
+ }
+
+ dtest_num = job->dtest_num;
+ ntsave = ntuple;
+ ntuple = job->ntuple;
+ ks_pvalue_save = job->ks_pvalues;
+ job->pvalue = execute_test(dtest_num);
+ ks_pvalue_save = NULL;
+ ntuple = ntsave;
+ Seed = Ssave;
+
+}
+
+/*
+ * Reseed rng (switching generators first in a batch) for job.
+ */
+static void seed_job(Job *job)
+{
+
+ seed = job->seed;
+ if(job->gennum >= 0){
+   select_batch_rng(job->gennum,seed);
+ } else {
+   gsl_rng_set(rng,seed);
+   reset_bit_buffers();
+ }
+ MYDEBUG(D_SEED){
+   fprintf(stdout,"# run_jobs(): worker for test %d seeded with %lu\n",
+           job->dtest_num,seed);
+ }
+
+}
+
+/*
+ * There is only one file (or pipe) to read from, so file_input and
+ * stdin_input_raw (alone or inside XOR) can neither be reseeded per job
+ * nor shared by workers.
+ */
+static int shared_input(void)
+{
+
+ return(fromfile || strncmp("stdin_input_raw",gsl_rng_name(rng),15) == 0);
+
+}
+
+/*
+ * Draw all of the job seeds up front, in job order, from the run seed.
+ * We go back to Seed when it is set, as time_rng() may have replaced
+ * seed with a random one since choose_rng().  In a batch each generator
+ * starts over from its own run seed, the one its header job carries, so
+ * its tests get the seeds they would get run on their own.
+ */
+static void seed_jobs(Job *job,unsigned int njobs)
+{
+
+ unsigned int j;
+ uint64_t state;
+
+ state = Seed ? Seed : seed;
+ for(j=0;j<njobs;j++){
+   if(job[j].kind == JOB_HEADER){
+     state = job[j].seed;
+   } else if(job[j].kind == JOB_TEST){
+     job[j].seed = splitmix64_next(&state);
+   }
+   job[j].out = NULL;
+   job[j].err = NULL;
+   job[j].pid = 0;
+   job[j].done = NO;
+ }
+
+}
+
+#if !defined(_WIN32)
+/*
+ * Copy a finished worker's output (in tmp) through to our own stream
+ * fp, and close it.
+ */
+static void replay_file(FILE **tmp,FILE *fp)
+{
+
+ char buf[PAGE];
+ size_t n;
+
+ if(*tmp == NULL) return;
+ rewind(*tmp);
+ while((n = fread(buf,1,sizeof(buf),*tmp)) > 0){
+   fwrite(buf,1,n,fp);
+ }
+ fflush(fp);
+ fclose(*tmp);
+ *tmp = NULL;
+
+}
+
+static void replay_job(Job *job)
+{
+
+ replay_file(&job->out,stdout);
+ replay_file(&job->err,stderr);
+
+}
+
+/*
+ * Fork a worker for job j.  The child reseeds its copy of rng and
+ * never returns.  Returns -1 (with nothing started) if we could not
+ * get the tmpfiles or fork.
+ */
+static int start_job(Job *job,unsigned int j,double *pvalue)
+{
+
+ pid_t pid;
+
+ job[j].done = NO;
+ if(job[j].group < 0){
+   job[j].done = YES;
+   return(0);
+ }
+
+ if((job[j].out = tmpfile()) == NULL) return(-1);
+ if((job[j].err = tmpfile()) == NULL){
+   fclose(job[j].out);
+   job[j].out = NULL;
+   return(-1);
+ }
+ fflush(stdout);
+ fflush(stderr);
+ pid = fork();
+ if(pid < 0){
+   fclose(job[j].out);
+   fclose(job[j].err);
+   job[j].out = job[j].err = NULL;
+   return(-1);
+ }
+
+ if(pid == 0){
+   dup2(fileno(job[j].out),STDOUT_FILENO);
+   dup2(fileno(job[j].err),STDERR_FILENO);
+   seed_job(&job[j]);
+   run_job(&job[j]);
+   pvalue[j] = job[j].pvalue;
+   fflush(stdout);
+   fflush(stderr);
+   _exit(0);
+ }
+
+ job[j].pid = pid;
+ return(0);
+
+}
+#endif
+
+void run_jobs(Job *job,unsigned int njobs)
+{
+
+ unsigned int j,seeded;
+#if !defined(_WIN32)
+ unsigned int next,nprint,running;
+ double *pvalue;
+ pid_t pid;
+ int status;
+#endif
+
+ seeded = (workers > 0 && !shared_input());
+
+#if !defined(_WIN32)
+ if(workers > 1 && shared_input()){
+   fprintf(stderr,"# run_jobs(): %s input cannot be shared by workers, running one test at a time\n",
+           gsl_rng_name(rng));
+ } else if(workers > 1 && checkpoint_file != NULL){
+   fprintf(stderr,"# run_jobs(): -K checkpoints one test at a time, running them in order\n");
+ } else if(workers > 1 && njobs > 1){
+
+   pvalue = (double *) mmap(NULL,njobs*sizeof(double),PROT_READ|PROT_WRITE,
+                            MAP_SHARED|MAP_ANONYMOUS,-1,0);
+   if(pvalue != MAP_FAILED){
+
+     seed_jobs(job,njobs);
+
+     if(job[0].kind != JOB_HEADER){
+       output_header();
+     }
+
+     next = nprint = running = 0;
+     while(nprint < njobs){
+       while(running < workers && next < njobs){
+         if(start_job(job,next,pvalue) < 0) break;
+         if(job[next].group >= 0) running++;
+         next++;
+       }
+
+       /*
+        * If we could not start anything at all, run the next job right
+        * here in the parent (everything before it has been replayed).
+        */
+       if(running == 0 && next < njobs && nprint == next){
+         fprintf(stderr,"# run_jobs(): cannot fork a worker for test %d, running it here\n",
+                 job[next].dtest_num);
+         seed_job(&job[next]);
+         run_job(&job[next]);
+         pvalue[next] = job[next].pvalue;
+         job[next].done = YES;
+         next++;
+       }
+
+       if(running){
+         pid = wait(&status);
+         if(pid < 0) continue;
+         for(j=0;j<next;j++){
+           if(job[j].pid == pid && !job[j].done) break;
+         }
+         if(j == next) continue;
+         running--;
+         job[j].done = YES;
+         if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+           replay_file(&job[j].err,stderr);
+           fprintf(stderr,"Error: worker for test %d (ntuple = %u) exited abnormally.\n",
+                   job[j].dtest_num,job[j].ntuple);
+           for(j=0;j<next;j++){
+             if(!job[j].done) kill(job[j].pid,SIGTERM);
+           }
+           Exit(1);
+         }
+       }
+
+       /*
+        * Replay everything that is done, in order.
+        */
+       while(nprint < next && job[nprint].done){
+         if(job[nprint].group < 0){
+           run_job(&job[nprint]);
+         } else {
+           replay_job(&job[nprint]);
+           job[nprint].pvalue = pvalue[nprint];
+         }
+         nprint++;
+       }
+     }
+
+     munmap(pvalue,njobs*sizeof(double));
+     return;
+
+   }
+ }
+#endif
+
+ /*
+  * One at a time, from wherever --resume left off, checkpointing (-K)
+  * as each job is done.  With -j each test gets the seed a worker would
+  * have given it.
+  */
+ if(seeded) seed_jobs(job,njobs);
+ for(j=resume_jobs(job,njobs);j<njobs;j++){
+   checkpoint_jobs(job,njobs,j);
+   if(seeded && job[j].kind == JOB_TEST && job[j].group >= 0) seed_job(&job[j]);
+   run_job(&job[j]);
+ }
+
+}
@@ -0,0 +1,139 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * run_sweep() runs the -d test once from each of -E nseeds seeds,
+ * Seed, Seed+1, ..., Seed+nseeds-1 (from a random first seed if -S is
+ * not set), and then asks whether the generator is as good from one
+ * seed as from another:  if it is, each of the test's ks_pvalues is
+ * uniform over the seeds, so we run kstest() and kstest_kuiper() on
+ * the nseeds values of each one, a second level test.  The Kuiper
+ * pvalue is asymptotic and strays outside [0,1] for few values, so it
+ * is clamped, and not shown at all for fewer than SWEEP_KUIPER_MIN
+ * seeds.
+ *
+ * The runs are just a list of jobs for run_jobs() (see dieharder.h),
+ * so with -j they run side by side, each in its own process with its
+ * own instance of the generator, and are reported in seed order.  Each
+ * job keeps its ks_pvalues in a shared page so a forked worker can hand
+ * them back.
+ *========================================================================
+ */
+
+#include "dieharder.h"
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+#define SWEEP_KUIPER_MIN 10
+
+void run_sweep()
+{
+
+ unsigned int i,k,nkps;
+ unsigned long int first;
+ size_t size;
+ double *ks,*p,pks,pkuiper;
+ char kuiper[16];
+ Job *job;
+
+ if(!select_test()){
+   fprintf(stderr,"Error:  Invalid dtest_num = %d.  No test found.\n",dtest_num);
+   exit(1);
+ }
+ if(fromfile || strncmp("stdin_input_raw",gsl_rng_name(rng),15) == 0){
+   fprintf(stderr,"Error: -E sweeps seeds, but %s input has no seed to sweep.\n",
+           gsl_rng_name(rng));
+   exit(1);
+ }
+ nkps = dh_test_types[dtest_num]->nkps;
+
+ size = (size_t)sweep_seeds*nkps*sizeof(double);
+#if !defined(_WIN32)
+ ks = (double *) mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+ if(ks == MAP_FAILED){
+   fprintf(stderr,"Error: run_sweep() cannot map %zu bytes for the ks_pvalues.\n",size);
+   exit(1);
+ }
+#else
+ ks = (double *) malloc(size);
+#endif
+ job = (Job *) calloc(sweep_seeds,sizeof(Job));
+ p = (double *) malloc(sweep_seeds*sizeof(double));
+
+ /*
+  * Every run reseeds (-s 1) from its own seed, so each table line
+  * shows the seed it came from.
+  */
+ first = Seed ? Seed : random_seed();
+ if(strategy == 0) strategy = 1;
+ for(k=0;k<sweep_seeds;k++){
+   job[k].dtest_num = dtest_num;
+   job[k].ntuple = ntuple;
+   job[k].group = k;
+   job[k].seed = first + k;
+   job[k].done = NO;
+   job[k].gennum = -1;
+   job[k].kind = JOB_SWEEP;
+   job[k].ks_pvalues = &ks[(size_t)k*nkps];
+ }
+
+ run_jobs(job,sweep_seeds);
+
+ /*
+  * The second level test, one line per ks_pvalue of the test.
+  */
+ fprintf(stdout,"#=============================================================================#\n");
+ fprintf(stdout,"# Seed sweep: %u seeds from %lu, second level test of each ks_pvalue\n",
+         sweep_seeds,first);
+ fprintf(stdout,"#=============================================================================#\n");
+ if(tflag & TNO_WHITE){
+   fprintf(stdout,"#test_name%cstat%cseeds%cKS p-value%cKuiper p-value%cAssessment\n",
+           table_separator,table_separator,table_separator,table_separator,
+           table_separator);
+ } else {
+   fprintf(stdout,"#%19s%c%4s%c%8s%c%10s%c%10s%c%10s\n","test_name  ",
+           table_separator,"stat",table_separator,"seeds",table_separator,
+           "KS p-value",table_separator,"Kuiper p",table_separator,"Assessment");
+ }
+ for(i=0;i<nkps;i++){
+   for(k=0;k<sweep_seeds;k++) p[k] = ks[(size_t)k*nkps + i];
+   pks = kstest(p,sweep_seeds);
+   for(k=0;k<sweep_seeds;k++) p[k] = ks[(size_t)k*nkps + i];
+   pkuiper = kstest_kuiper(p,sweep_seeds);
+   if(pkuiper < 0.0) pkuiper = 0.0;
+   if(pkuiper > 1.0) pkuiper = 1.0;
+   if(sweep_seeds < SWEEP_KUIPER_MIN){
+     snprintf(kuiper,sizeof(kuiper),"n/a");
+   } else {
+     snprintf(kuiper,sizeof(kuiper),"%.8f",pkuiper);
+   }
+   if(tflag & TNO_WHITE){
+     fprintf(stdout,"%s%c%u%c%u%c%.8f%c%s%c%s\n",dh_test_types[dtest_num]->sname,
+             table_separator,i,table_separator,sweep_seeds,table_separator,
+             pks,table_separator,kuiper,table_separator,
+             (pks < Xfail || pks > 1.0 - Xfail) ? "FAILED" :
+             (pks < Xweak || pks > 1.0 - Xweak) ? "WEAK" : "PASSED");
+   } else {
+     fprintf(stdout,"%20s%c%4u%c%8u%c%10.8f%c%10s%c%10s\n",dh_test_types[dtest_num]->sname,
+             table_separator,i,table_separator,sweep_seeds,table_separator,
+             pks,table_separator,kuiper,table_separator,
+             (pks < Xfail || pks > 1.0 - Xfail) ? "FAILED  " :
+             (pks < Xweak || pks > 1.0 - Xweak) ? "WEAK   " : "PASSED  ");
+   }
+ }
+ fflush(stdout);
+
+ free(p);
+ free(job);
+#if !defined(_WIN32)
+ munmap(ks,size);
+#else
+ free(ks);
+#endif
+
+}
@@ -6,7 +6,11 @@
 
 #include "dieharder.h"
 
-void run_test()
+/*
+ * Resolve a -d test name to dtest_num; returns 0 if there is no such
+ * test.
+ */
+int select_test()
 {
 
  unsigned int i;
@@ -28,8 +32,16 @@ void run_test()
      }
    }
  }
- if(dtest_num >= 0 && dtest_num < MAXTESTS && dh_test_types[dtest_num]){
+ return(dtest_num >= 0 && dtest_num < MAXTESTS && dh_test_types[dtest_num]);
+
+}
+
+void run_test()
+{
+
+ if(select_test()){
    (void)execute_test(dtest_num);
+   checkpoint_done();
  } else {
    fprintf(stderr,"Error:  Invalid dtest_num = %d.  No test found.\n",dtest_num);
    exit(1);
@@ -88,6 +100,13 @@ double execute_test(int dtest_num)
   */
  dieharder_test = create_test(dh_test_types[dtest_num],tsamples,psamples);
 
+ /*
+  * With --resume this may be the test that was in progress, in which
+  * case it gets back all of its pvalues (and rng its state) and the
+  * loop below just goes on to the next step.
+  */
+ (void)resume_test(dh_test_types[dtest_num],dieharder_test);
+
  /*
   * We now have to implement Xtrategy.  Since std_test is now smart enough
   * to be able to differentiate a first call after creation or clear from
@@ -142,6 +161,13 @@ double execute_test(int dtest_num)
        if(dieharder_test[0]->psamples >= Xoff) need_more_p = NO;
        break;
    }
+   if(need_more_p) checkpoint_test(dh_test_types[dtest_num],dieharder_test);
+ }
+
+ if(ks_pvalue_save != NULL){
+   for(i = 0; i < dh_test_types[dtest_num]->nkps ; i++){
+     ks_pvalue_save[i] = dieharder_test[i]->ks_pvalue;
+   }
  }
 
  destroy_test(dh_test_types[dtest_num],dieharder_test);
@@ -21,7 +21,7 @@ unsigned int output_file;
 unsigned int output_format;
 unsigned int overlap;
 unsigned int psamples;
-unsigned int Seed;
+unsigned long int Seed;
 off_t tsamples;
 double Xweak;
 double Xfail;
@@ -60,6 +60,7 @@ void set_globals()
  dtest_name[0] = (char)0; /* empty test name is also default */
  filename[0] = (char)0; /* No input file */
  fromfile = 0;          /* Not from an input file */
+ file_input_cache = 0;  /* Parse ASCII input files every time */
  ks_test = 0;           /* Default is 0, Symmetrized KS test */
  output_file = 0;       /* No output file */
  output_format = 1;     /* uint output format if you use -o alone */
@@ -89,6 +90,14 @@ void set_globals()
    TPSAMPLES + TTSAMPLES + TPVALUES + TASSESSMENT + TRATE + TSEED + TDBLRATE;
  tflag = 0;             /* We START with this zero so we can accumulate */
  verbose = 0;		/* Default is not to be verbose. */
+ workers = 0;           /* -a(ll) runs one test at a time, unseeded, without -j */
+ bitdist_sweep = 0;     /* -a(ll) runs rgb_bitdist once per ntuple */
+ batch_list = NULL;     /* no -G batch of generators */
+ sweep_seeds = 0;       /* no -E seed sweep */
+ ks_pvalue_save = NULL;
+ checkpoint_file = NULL; /* no -K checkpoints */
+ resume = NO;           /* and no --resume from one */
+ checkpoint_interval = 60; /* seconds between checkpoints of a test */
  /*
   * These are controls for Test To Destruction (TTD) and Resolve Ambiguity
   * (RA) modes (as well as normal test reporting).  They arguably should
@@ -0,0 +1,33 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * This is the Dbitmatrix struct, a binary matrix over GF(2) stored in
+ * one contiguous block, each row nwords 64 bit words long.  Column j
+ * of row i is bit j%64 of data[i*nwords + j/64]; bits past ncols in the
+ * last word of a row are ignored.  bitmatrix_rank() finds its rank by
+ * elimination a whole word of columns at a time.
+ *
+ * Small matrices (up to 32 or 64 columns, one word per row) don't need
+ * the struct at all:  binary_rank32() and binary_rank64() take a plain
+ * array of rows and keep the elimination in registers, and
+ * binary_rank32_batch() ranks many of them, stored back to back, in one
+ * call.  All of these destroy the matrix they are handed.
+ */
+typedef struct {
+  unsigned int nrows;
+  unsigned int ncols;
+  unsigned int nwords;         /* 64 bit words per row */
+  uint64_t *data;              /* nrows*nwords words, row after row */
+} Dbitmatrix;
+
+Dbitmatrix *bitmatrix_create(unsigned int nrows, unsigned int ncols);
+void bitmatrix_destroy(Dbitmatrix *m);
+unsigned int bitmatrix_rank(Dbitmatrix *m);
+unsigned int binary_rank32(unsigned int *rows, unsigned int mrows, unsigned int ncols);
+unsigned int binary_rank64(uint64_t *rows, unsigned int mrows, unsigned int ncols);
+void binary_rank32_batch(unsigned int *rows, unsigned int mrows, unsigned int ncols,
+                         unsigned int nmtx, unsigned int *ranks);
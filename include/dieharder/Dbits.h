@@ -0,0 +1,41 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * This is the Dbits struct, a bit reader on one rng.  It holds the
+ * partially used rands that get_uint_rand(), get_rand_bits() and
+ * get_rand_bits_uint() (static_get_bits.c) need to hand out the "next
+ * N bits" of the stream without dropping any, so two tests reading
+ * bits from two generators no longer share (and scramble) one set of
+ * static buffers.  Each test context carries one (ctx->bits), and it
+ * is emptied whenever a test is created, so a test's bits no longer
+ * depend on which test ran before it.
+ *
+ * Bits are delivered in exactly the same left to right order as before.
+ */
+#define BITS_BRBUF 6
+
+typedef struct {
+  gsl_rng *rng;                /* The rng we are reading bits from */
+  unsigned int rmax_bits;      /* Number of valid bits in each rand */
+  /* get_rand_bits_uint() */
+  unsigned int bit_buffer;
+  unsigned int bits_left;      /* Bits left in bit_buffer */
+  /* get_uint_rand() */
+  unsigned int bits_rand[2];   /* A buffer that can handle partial returns */
+  int bleft;                   /* Number of bits we still need in bits_rand[1] */
+  /* get_rand_bits() */
+  unsigned int randbuf[BITS_BRBUF];  /* circulating buffer of uint rands */
+  unsigned int output[BITS_BRBUF];
+  int brindex;                 /* line containing LAST return */
+  int iclear;                  /* region being backfilled */
+  int bitindex;                /* the last (most significant) returned bit */
+} Dbits;
+
+void bits_init(Dbits *bits, gsl_rng *rng, unsigned int rmax_bits);
+void bits_reset(Dbits *bits);
+unsigned int bits_get_uint_rand(Dbits *bits);
+void bits_get_rand_bits(Dbits *bits, void *result, unsigned int rsize, unsigned int nbits);
@@ -0,0 +1,31 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * This is the Dbitset struct, a flat table of nbits one bit "seen"
+ * flags packed into 64 bit words.  It is the word table behind the
+ * diehard "missing words" tests (bitstream, opso, oqso, dna):  each
+ * word the generator produces is bitset_set() by its index, and at
+ * the end bitset_missing() counts the words that never turned up by
+ * popcount, a word of flags at a time.  A 2^20 word table is 128K,
+ * small enough to stay in cache while it is being filled.
+ */
+typedef struct {
+  uint64_t *words;
+  size_t nbits;
+  size_t nwords;
+} Dbitset;
+
+Dbitset *bitset_create(size_t nbits);
+void bitset_destroy(Dbitset *b);
+void bitset_clear(Dbitset *b);
+size_t bitset_count(Dbitset *b);
+size_t bitset_missing(Dbitset *b);
+
+static inline void bitset_set(Dbitset *b, size_t i)
+{
+  b->words[i >> 6] |= (uint64_t)1 << (i & 63);
+}
@@ -0,0 +1,47 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * This is the Dcontext struct.  It carries everything a test reads
+ * from its caller besides its own Test struct:  the generator being
+ * tested, the number of valid bits it returns, the bit reader that
+ * hands out those bits, and the command line tunables that used to be
+ * read straight out of the global variables of the same name.  A test
+ * finds its context in test[i]->ctx, which create_test_ctx() fills in,
+ * so two tests (each with its own context and its own rng) can be run
+ * at the same time in one process.
+ *
+ * create_test() and friends without a context still work exactly as
+ * they always have.  They use the default context, which is a copy
+ * of the globals refreshed every time a test is created or run.
+ */
+typedef struct {
+  gsl_rng *rng;                /* The generator being tested */
+  unsigned long int seed;      /* Its seed, for tests that reseed it */
+  unsigned int rmax_bits;      /* Number of valid bits in rng */
+  unsigned int rmax_mask;      /* Mask for valid section of unsigned int */
+  unsigned int all;            /* Use standard tsamples and psamples */
+  unsigned int tsamples;       /* Samples per test run (0 = default) */
+  unsigned int psamples;       /* Test runs per final KS p-value (0 = default) */
+  double multiply_p;           /* Multiplier for default psamples in -a(ll) */
+  unsigned int ntuple;         /* n-tuple size for n-tuple tests */
+  unsigned int overlap;        /* 1 use overlapping samples, 0 don't */
+  unsigned int ks_test;        /* Selects the KS test to be used */
+  unsigned int Xtrategy;       /* Strategy used in TTD/RA mode */
+  unsigned int Xstep;          /* Number of additional psamples in TTD/RA mode */
+  unsigned int Xoff;           /* Max number of psamples in TTD/RA mode */
+  double x_user;               /* Reserved general purpose test inputs */
+  double y_user;
+  double z_user;
+  Dbits bits;                  /* Bit reader on rng (see Dbits.h) */
+} Dcontext;
+
+Dcontext *create_context(gsl_rng *rng);
+void destroy_context(Dcontext *ctx);
+void context_set_rng(Dcontext *ctx, gsl_rng *rng);
+void context_reseed(Dcontext *ctx, unsigned long int s);
+Dcontext *default_context();
+int is_default_context(Dcontext *ctx);
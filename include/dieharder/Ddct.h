@@ -0,0 +1,30 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * This is the Ddct struct, a "plan" for the unnormalized type II DCT
+ *
+ *   out[k] = sum_j in[j] cos((pi/n)(j + 1/2) k)
+ *
+ * of vectors of n unsigned ints, n a power of 2 (at least 4).  dct_create() works out
+ * the twiddle factors and bit reversal for n once and allocates the
+ * scratch space; dct2_batch() then transforms nvec vectors stored back
+ * to back, with no allocation or trig calls per vector.  The transform
+ * is done directly at length n, as an n/2 point complex FFT.
+ */
+typedef struct {
+  unsigned int n;
+  unsigned int h;              /* n/2, the complex FFT length */
+  unsigned int *rev;           /* h bit reversal permutation */
+  double *fft_tw;              /* h/2 complex FFT twiddles, re,im */
+  double *real_tw;             /* h+1 real split twiddles, re,im */
+  double *dct_tw;              /* h+1 DCT shift twiddles, cos,sin */
+  double *z;                   /* h complex scratch, re,im */
+} Ddct;
+
+Ddct *dct_create(unsigned int n);
+void dct_destroy(Ddct *p);
+void dct2_batch(Ddct *p, const unsigned int *in, double *out, unsigned int nvec);
@@ -24,8 +24,9 @@ static Dtest diehard_2dsphere_dtest __attribute__((unused)) = {
 # are printed but the KSTEST is based on the full set of 100    \n\
 # random choices of 8000 points in the 10000x10000 square.      \n\
 #\n\
-# This test uses a fixed number of samples -- tsamples is ignored.\n\
-# It also uses the default value of 100 psamples in the final\n\
+# tsamples (default 8000) sets the number of points.  For other\n\
+# than 8000 the mean of d^2 is scaled by (8000/tsamples)^2.  It\n\
+# uses the default value of 100 psamples in the final\n\
 # KS test, for once agreeing precisely with Diehard.\n\
 #==================================================================\n",
   100,
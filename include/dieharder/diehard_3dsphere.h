@@ -23,8 +23,9 @@ static Dtest diehard_3dsphere_dtest __attribute__((unused)) = {
 # to a uniform variable by means of 1-exp(-r^3/30.), then a     \n\
 #  KSTEST is done on the 20 p-values.                           \n\
 #\n\
-# This test ignores tsamples, and runs the usual default 100\n\
-# psamples to use in the final KS test.\n\
+# tsamples (default 4000) sets the number of points.  For other\n\
+# than 4000 the mean of r^3 is scaled by (4000/tsamples)^2.  The\n\
+# test runs the usual default 100 psamples in the final KS test.\n\
 #==================================================================\n",
   100,
   4000,
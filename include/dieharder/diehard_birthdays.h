@@ -30,7 +30,9 @@ static Dtest diehard_birthdays_dtest __attribute__((unused)) = {
 # Similarly, nbits \"should\" 24, but we can really make it anything\n\
 # we want that's less than or equal to rmax_bits = 32.  It can be\n\
 # reset to a new value with -y nbits.  Both default to diehard's\n\
-# values if no -x or -y options are used.\n\
+# values if no -x or -y options are used.  Keep the expected number\n\
+# of repeats, lambda = nms^3/2^(nbits+2), small (diehard's is 2),\n\
+# e.g. -x 2048 -y 30.\n\
 #==================================================================\n",
   100,
   100,
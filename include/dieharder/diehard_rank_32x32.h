@@ -23,6 +23,11 @@ static Dtest diehard_rank_32x32_dtest __attribute__((unused)) = {
 #\n\
 # As always, the test is repeated and a KS test applied to the\n\
 # resulting p-values to verify that they are approximately uniform.\n\
+#\n\
+# With -d 2 -n N for N > 32 the matrices are NxN instead (e.g. -n\n\
+# 1024), and the counts for ranks N,N-1,N-2 and <=N-3 are compared to\n\
+# the exact probabilities for that N.  tsamples then defaults to 1000.\n\
+# -n is ignored here under -a, where it is meant for the ntuple tests.\n\
 #==================================================================\n",
   100,
   40000,
@@ -44,6 +44,11 @@ typedef unsigned int            uint;
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_eigen.h>
 #include <dieharder/Dtest.h>
+#include <dieharder/Dbits.h>
+#include <dieharder/Dbitset.h>
+#include <dieharder/Dcontext.h>
+#include <dieharder/Ddct.h>
+#include <dieharder/Dbitmatrix.h>
 #include <dieharder/parse.h>
 #include <dieharder/verbose.h>
 #include <dieharder/Xtest.h>
@@ -51,6 +56,9 @@ typedef unsigned int            uint;
 #include <dieharder/std_test.h>
 #include <dieharder/tests.h>
 #include <dieharder/dieharder_rng_types.h>
+#include <dieharder/rng_fill.h>
+#include <dieharder/rng_discard.h>
+#include <dieharder/popcount.h>
 #include <dieharder/dieharder_test_types.h>
 extern int is_genuine_intel();
 
@@ -118,6 +126,10 @@ extern double chisq_pearson(double *observed,double *expected,unsigned int kmax)
 extern double sample(void *testfunc());
 extern double kstest(double *pvalue,int count);
 extern double kstest_kuiper(double *pvalue,int count);
+extern double kstest_dmax(const double *pvalue,int count);
+extern double kstest_p(int count,double dmax);
+extern double kstest_kuiper_v(const double *pvalue,int count);
+extern double kstest_kuiper_p(int count,double v);
 extern double q_ks(double x);
 extern double q_ks_kuiper(double x,int count);
 
@@ -153,6 +165,12 @@ extern void reset_bit_buffers();
 extern void add_lib_rngs();
 
 extern int binary_rank(unsigned int **mtx,int mrows,int ncols);
+#define PERM_RANK_KMAX 12
+extern unsigned int perm_rank(const unsigned int *perm, unsigned int k);
+extern void perm_unrank(unsigned int rank, unsigned int k, unsigned int *perm);
+extern unsigned int perm_rank_order(const double *v, unsigned int k, unsigned int *ties);
+extern void radix_sort_uint(unsigned int *data, unsigned int *scratch, size_t n);
+extern double min_distance2(const double *x,unsigned int n,unsigned int dim,double side,int torus);
 
  /*
   *========================================================================
@@ -203,7 +221,7 @@ extern unsigned int psamples;         /* Number of test runs in final KS test */
 extern unsigned int quiet;            /* quiet flag -- surpresses full output report */
 extern unsigned int rgb;              /* rgb test number */
 extern unsigned int sts;              /* sts test number */
-extern unsigned int Seed;             /* user selected seed.  Surpresses reseeding per sample.*/
+extern unsigned long int Seed;        /* user selected seed.  Surpresses reseeding per sample.*/
 extern off_t tsamples;        /* Generally should be "a lot".  off_t is u_int64_t. */
 extern unsigned int user;             /* user defined test number */
 extern int verbose;           /* Default is not to be verbose. */
@@ -250,6 +268,7 @@ extern char **fields;
 extern unsigned int file_input_get_rewind_cnt(gsl_rng *rng);
 extern off_t file_input_get_rtot(gsl_rng *rng);
 extern void file_input_set_rtot(gsl_rng *rng,unsigned int value);
+extern const unsigned int *file_input_map(const char *name, off_t nwords);
 
 #ifndef RNG_FILE_INPUT_C
 extern char filename[K];      /* Input file name */
@@ -263,6 +282,7 @@ extern int filenumbits;	/* number of bits per integer */
   */
 extern off_t filecount;	/* number of rands in file */
 extern char filetype;         /* file type */
+extern int file_input_cache;	/* keep a raw binary copy of an ASCII file */
 #endif
 
 /*
@@ -275,6 +295,11 @@ extern char filetype;         /* file type */
  *  rtot is a count of rands returned since the file was opened
  *  rewind_cnt is a count of how many times the file was rewound
  *     since its last open.
+ *  map is the whole file mmap'd (file_input_raw, regular files only),
+ *     or the binary cache of a file_input file, or NULL if we are
+ *     reading the file through fp.
+ *  buf, bpos and bend are file_input's read buffer, the start of
+ *     the next line in it and the end of the data in it.
  */
  typedef struct {
 	FILE *fp;
@@ -282,8 +307,14 @@ extern char filetype;         /* file type */
 	off_t rptr;
 	off_t rtot;
 	unsigned int rewind_cnt;
+	const unsigned int *map;
+	char *buf;
+	size_t bpos;
+	size_t bend;
   } file_input_state_t;
 
+extern void file_input_unmap(file_input_state_t *state);
+
 
  /*
   * rng global vectors and variables for setup and tests.
@@ -0,0 +1,25 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * Population count kernels for the bit counting tests, run over whole
+ * buffers of rands at a time.
+ *
+ *   popcount_u32(buf,n)             total number of 1 bits in buf[0..n-1]
+ *   popcount_u32_each(buf,cnt,n)    cnt[i] = 1 bits in buf[i]
+ *   popcount_bytes_lut(buf,out,n,lut)
+ *                                   out[4i+k] = lut[1 bits in byte k of
+ *                                   buf[i]], byte 0 the least significant
+ *                                   (the diehard count-the-1s "letters")
+ *
+ * Each picks an AVX-512, AVX2 or plain (popcnt) kernel at run time from
+ * what the CPU and OS support, as x86_simd_level() (cpu_features.c)
+ * reports it.
+ */
+uint64_t popcount_u32(const unsigned int *buf, size_t n);
+void popcount_u32_each(const unsigned int *buf, unsigned char *cnt, size_t n);
+void popcount_bytes_lut(const unsigned int *buf, unsigned char *out, size_t n,
+                        const unsigned char lut[16]);
@@ -6,6 +6,12 @@
  * function prototype
  */
 int rgb_bitdist(Test **test, unsigned int irun);
+int rgb_bitdist_sweep(Test **test, unsigned int irun);
+
+/*
+ * The widest ntuple in the rgb_bitdist_sweep series (and in -a).
+ */
+#define RGB_BITDIST_NMAX 12
 
 static Dtest rgb_bitdist_dtest __attribute__((unused)) = {
   "RGB Bit Distribution Test",
@@ -35,3 +41,24 @@ static Dtest rgb_bitdist_dtest __attribute__((unused)) = {
   0
 };
 
+
+static Dtest rgb_bitdist_sweep_dtest __attribute__((unused)) = {
+  "RGB Bit Distribution Sweep",
+  "rgb_bitdist_sweep",
+  "\n\
+#========================================================================\n\
+#                 RGB Bit Distribution Sweep\n\
+# This is the RGB Bit Distribution Test (-d 200) for every ntuple from\n\
+# 1 to 12 at once, one pvalue per ntuple.  Each sample draws the bits\n\
+# the 12 bit ntuples need, and every narrower ntuple is histogrammed\n\
+# from the front of the same bits, so the whole series is one pass over\n\
+# the data instead of twelve.  The price is that the twelve pvalues\n\
+# are not independent of one another.  -a uses it in place of the\n\
+# -d 200 -n 1..12 series when run with -b.\n\
+#\n",
+  100,     /* Default psamples */
+  100000,  /* Default tsamples */
+  RGB_BITDIST_NMAX,  /* One pvalue per ntuple */
+  rgb_bitdist_sweep,
+  0
+};
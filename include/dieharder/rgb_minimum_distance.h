@@ -36,6 +36,11 @@ static Dtest rgb_minimum_distance_dtest __attribute__((unused)) = {
 # as thoroughly as one likes subject to the generous constraints\n\
 # associated with the eventual need for still higher order corrections\n\
 # as n and p are made large enough.\n\
+#\n\
+# The cost is about linear in n (-t) in any dimension.  Use -x 1 to put\n\
+# the points on a d-torus (periodic boundary conditions) instead of in\n\
+# the unit d-cube.  This is ignored under -a, where -x is meant for the\n\
+# other tests.\n\
 #\n",
   1000,
   10000,
@@ -20,7 +20,8 @@ static Dtest rgb_operm_dtest __attribute__((unused)) = {
 # sample p-value.  Note that this is one possible functional replacement\n\
 # for the broken/defunct diehard operm5 test, but one that permits k (the\n\
 # number of numbers in the overlapping permutation window) to be varied\n\
-# from 2 to perhaps 8.\n\
+# from 2 to 4 with -n k (default 3).  The exact matrix steps through all\n\
+# (3k-2)! orderings, 13! of them already at k = 5, so larger k are refused.\n\
 #\n",
   100,     /* Default psamples */
   100000,  /* Default tsamples */
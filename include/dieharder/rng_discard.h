@@ -0,0 +1,95 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * Discards.  rng_discard(rng,n) leaves rng exactly where n calls to
+ * gsl_rng_get(rng) would, and rng_discard_uniform(rng,n) exactly where
+ * n calls to gsl_rng_uniform(rng) would (the two differ for generators
+ * that use two returns per double).  A generator with a native discard
+ * gets there without generating all n numbers:  the counter based ones
+ * (philox, threefry, chacha, AES-CTR) just add to their counter, the
+ * LCG based ones (pcg, drand48, splitmix64, wyrand) raise the multiplier
+ * to the nth power, and the xoshiro/xoroshiro family jumps with the
+ * polynomial x^n mod its characteristic polynomial (see below).  Every
+ * other generator is stepped n times.
+ *
+ * That includes some that are linear over GF(2) and could jump the
+ * same way:  mt19937 (and its GSL variants), mt64, sfmt and the like.
+ * Their states (19937 bits for mt19937) are far bigger than
+ * RNG_GF2_MAXDEG, and the jump would need the degree 19937 minimal
+ * polynomial and a state addition that knows their circular buffers,
+ * so they are stepped for now.
+ *
+ * Like the fills (see rng_fill.h) the native ones are looked up by type
+ * in a table in rng_discard.c.  per_double is the number of returns of
+ * the generator that go into each gsl_rng_uniform().
+ */
+typedef void (*rng_discard_t)(void *vstate, uint64_t n);
+
+typedef struct {
+  const gsl_rng_type **type;
+  rng_discard_t discard;
+  unsigned int per_double;
+} rng_discard_type;
+
+void rng_discard(gsl_rng *rng, uint64_t n);
+void rng_discard_uniform(gsl_rng *rng, uint64_t n);
+rng_discard_t rng_get_discard(const gsl_rng_type *type);
+
+/*
+ * Jumps for a generator whose state (the first size bytes of vstate)
+ * is advanced by a linear map T over GF(2), size a multiple of 8.  T^n s = r(T) s where
+ * r(x) = x^n mod p(x), p the characteristic polynomial of T, so n steps
+ * cost about degree steps and some polynomial arithmetic.  p is found
+ * the first time (by Berlekamp-Massey on the generator's own state
+ * bits) and kept in *poly, which must start out zeroed, along with
+ * x^n mod p for the last n.  Short discards
+ * are simply stepped.  *poly is shared by every generator of its type
+ * and rewritten by the discards, so they are not thread-safe.
+ */
+#define RNG_GF2_MAXDEG 256
+
+typedef struct {
+  unsigned int degree;
+  uint64_t p[RNG_GF2_MAXDEG/64 + 1];
+  uint64_t n;                          /* the last n discarded */
+  uint64_t r[RNG_GF2_MAXDEG/64 + 1];   /* and x^n mod p */
+} rng_gf2_poly;
+
+void rng_discard_gf2(void *vstate, size_t size, unsigned long int (*get)(void *),
+                     unsigned int degree, rng_gf2_poly *poly, uint64_t n);
+
+/*
+ * The native discards.
+ */
+void philox2x32_discard(void *vstate, uint64_t n);
+void philox4x32_discard(void *vstate, uint64_t n);
+void philox2x64_discard(void *vstate, uint64_t n);
+void philox4x64_discard(void *vstate, uint64_t n);
+void threefry2x32_discard(void *vstate, uint64_t n);
+void threefry4x32_discard(void *vstate, uint64_t n);
+void threefry2x64_discard(void *vstate, uint64_t n);
+void threefry4x64_discard(void *vstate, uint64_t n);
+void chacha_discard(void *vstate, uint64_t n);
+void aesni_discard(void *vstate, uint64_t n);
+void pcg32_discard(void *vstate, uint64_t n);
+void pcg64_discard(void *vstate, uint64_t n);
+void pcg64_cmdxsm_discard(void *vstate, uint64_t n);
+void pcg64_dxsm_discard(void *vstate, uint64_t n);
+void drand48_discard(void *vstate, uint64_t n);
+void splitmix64_discard(void *vstate, uint64_t n);
+void wyrand_discard(void *vstate, uint64_t n);
+void xoshiro128_pp_discard(void *vstate, uint64_t n);
+void xoshiro128_ss_discard(void *vstate, uint64_t n);
+void xoshiro128_p_discard(void *vstate, uint64_t n);
+void xoroshiro64_ss_discard(void *vstate, uint64_t n);
+void xoroshiro64_s_discard(void *vstate, uint64_t n);
+void xoshiro256_pp_discard(void *vstate, uint64_t n);
+void xoshiro256_ss_discard(void *vstate, uint64_t n);
+void xoshiro256_p_discard(void *vstate, uint64_t n);
+void xoroshiro128_pp_discard(void *vstate, uint64_t n);
+void xoroshiro128_ss_discard(void *vstate, uint64_t n);
+void xoroshiro128_p_discard(void *vstate, uint64_t n);
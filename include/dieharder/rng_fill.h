@@ -0,0 +1,64 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ * Bulk fills.  fill_u32(rng,buf,n) puts the next n returns of rng into
+ * buf, truncated to unsigned int exactly as buf[i] = gsl_rng_get(rng)
+ * would, so a test gets the same numbers either way.  It just gets
+ * them a lot faster from a generator that has a native fill, which
+ * runs the generator on a local copy of its state with no indirect
+ * call per word.  Every other generator goes through gsl_rng_get().
+ *
+ * The counter based generators (philox, threefry, chacha, AES-CTR) make
+ * 8 or 16 blocks per call with AVX2 or AVX-512 (VAES for AES-CTR) when
+ * the build and the cpu both have it (see cpu_features.h), a block per
+ * vector lane, writing them straight into buf.
+ *
+ * A gsl_rng_type has no room for a fill routine, so the native ones
+ * are looked up by type in a table in rng_fill.c.
+ */
+typedef void (*rng_fill_u32_t)(void *vstate, unsigned int *buf, size_t n);
+
+typedef struct {
+  const gsl_rng_type **type;
+  rng_fill_u32_t fill_u32;
+} rng_fill_type;
+
+void fill_u32(gsl_rng *rng, unsigned int *buf, size_t n);
+rng_fill_u32_t rng_get_fill_u32(const gsl_rng_type *type);
+
+/*
+ * The native fills.
+ */
+void wyrand_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void splitmix64_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoshiro128_pp_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoshiro128_ss_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoshiro128_p_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoroshiro64_ss_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoroshiro64_s_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoshiro256_pp_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoshiro256_ss_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoshiro256_p_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoroshiro128_pp_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoroshiro128_ss_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void xoroshiro128_p_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void romuduojr_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void romuduo_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void romutrio_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void romuquad_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void philox2x32_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void philox4x32_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void philox2x64_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void philox4x64_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void threefry2x32_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void threefry4x32_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void threefry2x64_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void threefry4x64_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void chacha_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void aesni_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void file_input_raw_fill_u32(void *vstate, unsigned int *buf, size_t n);
+void stdin_input_raw_fill_u32(void *vstate, unsigned int *buf, size_t n);
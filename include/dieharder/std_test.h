@@ -23,10 +23,15 @@ typedef struct {
   double x;            /* Extra variable passed on command line */
   double y;            /* Extra variable passed on command line */
   double z;            /* Extra variable passed on command line */
+  Dcontext *ctx;       /* The rng and tunables the test is run with */
+  unsigned int ks_sorted;  /* pvalues[0..ks_sorted) are in order from the last KS */
+  double *ks_tail;         /* scratch for merging in the new ones */
+  unsigned int ks_tailsize;   /* (room for this many) */
 } Test;
 
 
 Test **create_test(Dtest *dtest, unsigned int tsamples, unsigned int psamples);
+Test **create_test_ctx(Dcontext *ctx, Dtest *dtest, unsigned int tsamples, unsigned int psamples);
 void destroy_test(Dtest *dtest, Test **test);
 void std_test(Dtest *dtest, Test **test);
 
@@ -54,6 +54,11 @@ static Dtest sts_serial_dtest __attribute__((unused)) = {
 # containing 00's MUST be imbalanced as well relative to ones that do\n\
 # not, so we really only need to check n=24 bit results to get all\n\
 # the rest for free, so to speak.\n\
+#\n\
+# By default it tests n=1 to n=16.  -n 17 to -n 24 counts wider patterns,\n\
+# reporting n=1 and the fifteen orders up to the one asked for (and\n\
+# raising the default tsamples to 2^(n-3) so there are enough bits).\n\
+# All orders come from a single pass over the bits.\n\
 #\n",
   100,     /* Default psamples */
   100000,  /* Default tsamples */
@@ -0,0 +1,140 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * Test contexts (see Dcontext.h).  A UI that wants to run more than one
+ * test at a time creates a context per test (per thread) with
+ * create_context(), sets whatever it likes in it, and passes it to
+ * create_test_ctx().  The tests themselves read only their context.
+ *
+ * Everybody else gets the default context, which is simply a copy of
+ * the old globals of the same names.  It is refreshed by create_test()
+ * and std_test() so setting a global between calls works as it always
+ * has.  It is, of course, no more reentrant than the globals it copies.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+static Dcontext dh_default_ctx;
+
+/*
+ * Count the valid bits in a generator's return (it may be less than
+ * 32 for some of the older generators).
+ */
+void context_set_rng(Dcontext *ctx, gsl_rng *rng)
+{
+
+ unsigned long int rmax;
+
+ ctx->rng = rng;
+ ctx->rmax_bits = 0;
+ ctx->rmax_mask = 0;
+ if(rng != NULL){
+   rmax = gsl_rng_max(rng);
+   while(rmax && ctx->rmax_bits < 32){
+     rmax >>= 1;
+     ctx->rmax_mask = ctx->rmax_mask << 1;
+     ctx->rmax_mask++;
+     ctx->rmax_bits++;
+   }
+ }
+ bits_init(&ctx->bits,ctx->rng,ctx->rmax_bits);
+
+}
+
+/*
+ * Reseed ctx->rng with s.  A test that does this on the default
+ * context also updates the global seed, as it always has, so the UI
+ * reports the seed that was actually used.
+ */
+void context_reseed(Dcontext *ctx, unsigned long int s)
+{
+
+ ctx->seed = s;
+ gsl_rng_set(ctx->rng,s);
+ if(ctx == &dh_default_ctx) seed = s;
+
+}
+
+/*
+ * Copy the globals into ctx.  The bit reader follows rng but keeps
+ * whatever bits it holds.
+ */
+static void context_from_globals(Dcontext *ctx)
+{
+
+ ctx->rng = rng;
+ ctx->seed = seed;
+ ctx->rmax_bits = rmax_bits;
+ ctx->rmax_mask = rmax_mask;
+ ctx->all = all;
+ ctx->tsamples = tsamples;
+ ctx->psamples = psamples;
+ ctx->multiply_p = multiply_p;
+ ctx->ntuple = ntuple;
+ ctx->overlap = overlap;
+ ctx->ks_test = ks_test;
+ ctx->Xtrategy = Xtrategy;
+ ctx->Xstep = Xstep;
+ ctx->Xoff = Xoff;
+ ctx->x_user = x_user;
+ ctx->y_user = y_user;
+ ctx->z_user = z_user;
+ ctx->bits.rng = ctx->rng;
+ ctx->bits.rmax_bits = ctx->rmax_bits;
+
+}
+
+/*
+ * Create a new context for rng.  Everything else starts out with the
+ * current value of the corresponding global, so a context made in the
+ * dieharder UI after the command line is parsed needs no further work.
+ */
+Dcontext *create_context(gsl_rng *rng)
+{
+
+ Dcontext *ctx;
+
+ ctx = (Dcontext *)malloc(sizeof(Dcontext));
+ context_from_globals(ctx);
+ context_set_rng(ctx,rng);
+
+ MYDEBUG(D_STD_TEST){
+   fprintf(stdout,"# create_context(): rng %s with %u valid bits\n",
+           rng ? gsl_rng_name(rng) : "(none)",ctx->rmax_bits);
+ }
+
+ return(ctx);
+
+}
+
+void destroy_context(Dcontext *ctx)
+{
+
+ if(ctx == NULL || ctx == &dh_default_ctx) return;
+ free(ctx);
+
+}
+
+/*
+ * Return the default context, brought up to date with the globals.
+ */
+Dcontext *default_context()
+{
+
+ context_from_globals(&dh_default_ctx);
+ return(&dh_default_ctx);
+
+}
+
+int is_default_context(Dcontext *ctx)
+{
+
+ return(ctx == &dh_default_ctx);
+
+}
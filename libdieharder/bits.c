@@ -410,6 +410,15 @@ void fill_uint_buffer(unsigned int *data,unsigned int buflength)
  unsigned int bdelta;
  unsigned int i,tmp1,tmp2,mask;
 
+ /*
+  * A full 32 bit generator needs no packing at all (and used to throw
+  * away every other rand below), so take the bulk path.
+  */
+ if(rmax_bits == 32){
+   fill_u32(rng,data,buflength);
+   return;
+ }
+
  bdelta = sizeof(unsigned int)*CHAR_BIT - rmax_bits;
  mask = 0;
  for(i=0;i<bdelta;i++) {
@@ -874,12 +883,12 @@ void get_ntuple_cyclic(unsigned int *input,unsigned int ilen,
  * The last thing I need to make (well, it may not be the last thing,
  * we'll see) is a routine that
  *
- *   a) fills an internal static circulating buffer with random bits pulled
+ *   a) fills an internal circulating buffer with random bits pulled
  * from the current rng.
  *
  *   b) returns a rand of any requested size (a void * routine with a
  * size parameter in bits or bytes) using the previous routine, keep
- * track of the current position in the periodic buffer with a static
+ * track of the current position in the periodic buffer with a
  * pointer.
  *
  *   c) refills the circulating buffer from the current rng.
@@ -893,32 +902,67 @@ void get_ntuple_cyclic(unsigned int *input,unsigned int ilen,
  * without artificial gaps or compression.
  *
  * Note that this routine is NOT portable (although it could be made to
- * be portable) and requires that global rng exist and be set up ready to go
- * by the calling routine.
+ * be portable) and requires that the reader's rng exist and be set up
+ * ready to go by the calling routine.
+ */
+
+/*
+ * All of the state for this lives in a Dbits bit reader (see Dbits.h),
+ * one per stream, instead of in static variables.
  */
+void bits_init(Dbits *bits, gsl_rng *rng, unsigned int rmax_bits)
+{
 
-static unsigned int bits_rand[2];   /* A buffer that can handle partial returns */
-static int bleft = -1; /* Number of bits we still need in rand[1] */
+ bits->rng = rng;
+ bits->rmax_bits = rmax_bits;
+ bits_reset(bits);
 
-unsigned int get_uint_rand(gsl_rng *gsl_rng)
+}
+
+/*
+ * Empty the reader so that the next bits come straight from the rng.
+ * This must be done to get consistent results from a rng reseed on.
+ */
+void bits_reset(Dbits *bits)
+{
+
+ int i;
+
+ bits->bit_buffer = 0;
+ bits->bits_left = 0;
+ bits->bits_rand[0] = bits->bits_rand[1] = 0;
+ bits->bleft = -1;
+ for(i = 0;i<BITS_BRBUF;i++){
+   bits->randbuf[i] = 0;
+   bits->output[i] = 0;
+ }
+ bits->brindex = -1;
+ bits->iclear = -1;
+ bits->bitindex = -1;
+
+}
+
+unsigned int bits_get_uint_rand(Dbits *bits)
 {
 
- static unsigned int bl,bu,tmp;
+ unsigned int bl,bu,tmp;
+ unsigned int rmax_bits = bits->rmax_bits;
+ unsigned int *bits_rand = bits->bits_rand;
+
+ /* e.g. 32 */
+ bu = sizeof(unsigned int)*CHAR_BIT;
+ /* e.g. 32 - 31 = 1 for a generator that returns 31 bits */
+ bl = bu - rmax_bits;
 
  /*
-  * First call -- initialize/fill bits_rand from current rng.  bl and bu
-  * should be static so they are preserved for later calls.
+  * First call -- initialize/fill bits_rand from current rng.
   */
- if(bleft == -1){
-   /* e.g. 32 */
-   bu = sizeof(unsigned int)*CHAR_BIT;
-   /* e.g. 32 - 31 = 1 for a generator that returns 31 bits */
-   bl = bu - rmax_bits;
+ if(bits->bleft == -1){
    /* For the first call, we start with bits_rand[1] all or partially filled */
    bits_rand[0] = 0;
-   bits_rand[1] = gsl_rng_get(gsl_rng);
+   bits_rand[1] = gsl_rng_get(bits->rng);
    /* This is how many bits we still need. */
-   bleft = bu - rmax_bits;
+   bits->bleft = bu - rmax_bits;
    /*
 	* The state of the generator is now what it would be on a
 	* typical running call.  bits_rand[1] contains the leftover bits from the
@@ -942,45 +986,45 @@ unsigned int get_uint_rand(gsl_rng *gsl_rng)
   * We have to iterate into range because it is quite possible that
   * rmax_bits won't be enough to fill bits_rand[1].
   */
- while((unsigned)bleft > rmax_bits){
+ while((unsigned)bits->bleft > rmax_bits){
    /* Get a bits_rand's worth (rmax_bits) into bits_rand[0] */
-   bits_rand[0] = gsl_rng_get(gsl_rng);
+   bits_rand[0] = gsl_rng_get(bits->rng);
    MYDEBUG(D_BITS) {
-	 printf("before %2d: |",bleft);
+	 printf("before %2d: |",bits->bleft);
 	 dumpbits(&bits_rand[0],bu);
 	 printf("|");
 	 dumpbits(&bits_rand[1],bu);
 	 printf("|\n");
    }
    /* get the good bits only and fill in bits_rand[1] */
-   bits_rand[1] += b_window(bits_rand[0],bu-rmax_bits,bu-1,bleft-rmax_bits);
+   bits_rand[1] += b_window(bits_rand[0],bu-rmax_bits,bu-1,bits->bleft-rmax_bits);
    MYDEBUG(D_BITS) {
-	 printf(" after %2d: |",bleft);
+	 printf(" after %2d: |",bits->bleft);
 	 dumpbits(&bits_rand[0],bu);
 	 printf("|");
 	 dumpbits(&bits_rand[1],bu);
 	 printf("|\n");
    }
-   bleft -= rmax_bits;  /* Number of bits we still need to fill bits_rand[1] */
+   bits->bleft -= rmax_bits;  /* Number of bits we still need to fill bits_rand[1] */
  }
 
  /*
   * We are now in range.  We get just the number of bits we need, from
   * the right of course, and add them to bits_rand[1].
   */
- bits_rand[0] = gsl_rng_get(gsl_rng);
+ bits_rand[0] = gsl_rng_get(bits->rng);
  MYDEBUG(D_BITS) {
-   printf("before %2d: |",bleft);
+   printf("before %2d: |",bits->bleft);
    dumpbits(&bits_rand[0],bu);
    printf("|");
    dumpbits(&bits_rand[1],bu);
    printf("|\n");
  }
- if(bleft != 0) {
-   bits_rand[1] += b_window(bits_rand[0],bu-bleft,bu-1,0);
+ if(bits->bleft != 0) {
+   bits_rand[1] += b_window(bits_rand[0],bu-bits->bleft,bu-1,0);
  }
  MYDEBUG(D_BITS) {
-   printf(" after %2d: |",bleft);
+   printf(" after %2d: |",bits->bleft);
    dumpbits(&bits_rand[0],bu);
    printf("|");
    dumpbits(&bits_rand[1],bu);
@@ -994,13 +1038,13 @@ unsigned int get_uint_rand(gsl_rng *gsl_rng)
   * exactly filled the return with ALL the bits in rand[0] then we
   * need to start over on the next one.
   */
- if((unsigned)bleft == rmax_bits){
-   bleft = bu;
+ if((unsigned)bits->bleft == rmax_bits){
+   bits->bleft = bu;
  } else {
-   bits_rand[1] = b_window(bits_rand[0],bu-rmax_bits,bu-bleft-1,bu-rmax_bits+bleft);
-   bleft = bu - rmax_bits + bleft;
+   bits_rand[1] = b_window(bits_rand[0],bu-rmax_bits,bu-bits->bleft-1,bu-rmax_bits+bits->bleft);
+   bits->bleft = bu - rmax_bits + bits->bleft;
    MYDEBUG(D_BITS) {
-	 printf("  done %2d: |",bleft);
+	 printf("  done %2d: |",bits->bleft);
 	 dumpbits(&bits_rand[0],bu);
 	 printf("|");
 	 dumpbits(&bits_rand[1],bu);
@@ -1018,29 +1062,21 @@ unsigned int get_uint_rand(gsl_rng *gsl_rng)
  * of arbitrary size -- we make the return a void pointer whose size is
  * specified by the caller (and guaranteed to be big enough to hold
  * the result).
- */
-
-/*
- * We'll use a BIG static circulating buffer so we can handle BIG
+ *
+ * We use a BIG circulating buffer (bits->randbuf) so we can handle BIG
  * lags without worrying too much about it.  Space is cheap in the
  * one-page range.
  */
-#define BRBUF 6
-static unsigned int bits_randbuf[BRBUF];
-static unsigned int bits_output[BRBUF];
-/* pointer to line containing LAST return */
-static int brindex = -1;
-/* pointer to region being backfilled */
-static int iclear = -1;
-/* pointer to the last (most significant) returned bit */
-static int bitindex = -1;
+#define BRBUF BITS_BRBUF
 
-void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *gsl_rng)
+void bits_get_rand_bits(Dbits *bits, void *result, unsigned int rsize, unsigned int nbits)
 {
 
  unsigned int i,offset;
  unsigned int bu;
  char *output,*resultp;
+ unsigned int *bits_randbuf = bits->randbuf;
+ unsigned int *bits_output = bits->output;
 
  /*
   * Zero the return.  Note rsize is in characters/bytes.
@@ -1068,7 +1104,7 @@ void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *g
    return;   /* Unlikely, but possible */
  }
 
- if(brindex == -1){
+ if(bits->brindex == -1){
    /*
 	* First call, fill the buffer BACKWARDS.  I know this looks odd,
 	* but we have to think of bits coming off the generator from least
@@ -1077,7 +1113,7 @@ void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *g
 	* a de-facto shuffle for generators with rmax_bits < 32.
 	*/
    for(i=BRBUF-1;i!=0;i--) {
-	 bits_randbuf[i] = get_uint_rand(gsl_rng);
+	 bits_randbuf[i] = bits_get_uint_rand(bits);
 	 /* printf("bits_randbuf[%d] = %u\n",i,bits_randbuf[i]); */
    }
    /*
@@ -1085,11 +1121,11 @@ void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *g
 	* last bit.  Note that iclear should always start equal to brindex
 	* as one enters the next code segment.
 	*/
-   brindex = BRBUF;
-   iclear = brindex-1;
-   bitindex = 0;
+   bits->brindex = BRBUF;
+   bits->iclear = bits->brindex-1;
+   bits->bitindex = 0;
    MYDEBUG(D_BITS) {
-	 printf("Initialization: iclear = %d  brindex = %d   bitindex = %d\n",iclear,brindex,bitindex);
+	 printf("Initialization: iclear = %d  brindex = %d   bitindex = %d\n",bits->iclear,bits->brindex,bits->bitindex);
    }
  }
  MYDEBUG(D_BITS) {
@@ -1113,39 +1149,39 @@ void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *g
   * modulus/remainder, then handle a negative result (borrow), then finally
   * deal with wraparound of the main index as well.
   */
- brindex -= nbits/bu;
- bitindex = bitindex - nbits%bu;
- if(bitindex < 0) {
+ bits->brindex -= nbits/bu;
+ bits->bitindex = bits->bitindex - nbits%bu;
+ if(bits->bitindex < 0) {
    /* Have to borrow from previous uint */
-   brindex--;                /* So we push back one more */
-   bitindex += bu;           /* and find the new bitindex */
+   bits->brindex--;                /* So we push back one more */
+   bits->bitindex += bu;           /* and find the new bitindex */
  }
- if(brindex < 0) brindex += BRBUF;  /* Oops, need to wrap around */
+ if(bits->brindex < 0) bits->brindex += BRBUF;  /* Oops, need to wrap around */
  MYDEBUG(D_BITS) {
-   printf("  Current Call: iclear = %d  brindex = %d   bitindex = %d\n",iclear,brindex,bitindex);
+   printf("  Current Call: iclear = %d  brindex = %d   bitindex = %d\n",bits->iclear,bits->brindex,bits->bitindex);
  }
 
  /*
   * OK, so we want a window nbits long, starting in the uint indexed
   * by brindex, displaced by bitindex.
   */
- offset = brindex*bu + bitindex;
+ offset = bits->brindex*bu + bits->bitindex;
  MYDEBUG(D_BITS) {
    printf("   Window Call: tuple = %d  offset = %u\n",nbits,offset);
  }
  get_ntuple_cyclic(bits_randbuf,BRBUF,bits_output,BRBUF,nbits,offset);
  /* Handle case where we returned whole uint at brindex location */
  MYDEBUG(D_BITS) {
-   printf("   Cleaning up:  iclear = %d  brindex = %d  bitindex = %d\n",iclear,brindex,bitindex);
+   printf("   Cleaning up:  iclear = %d  brindex = %d  bitindex = %d\n",bits->iclear,bits->brindex,bits->bitindex);
  }
 
  /*
   * Time to backfill.  We walk backwards, filling until we reach
   * the current index.
   */
- while(iclear != brindex){
-   bits_randbuf[iclear--] = get_uint_rand(gsl_rng);
-   if(iclear < 0) iclear += BRBUF;  /* wrap on around */
+ while(bits->iclear != bits->brindex){
+   bits_randbuf[bits->iclear--] = bits_get_uint_rand(bits);
+   if(bits->iclear < 0) bits->iclear += BRBUF;  /* wrap on around */
  }
  /*
   * Dump the refilled buffer
@@ -1193,6 +1229,37 @@ void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *g
 
 }
 
+/*
+ * The original interface:  get_uint_rand() and get_rand_bits() read
+ * from one bit reader shared by all callers, on whatever rng they are
+ * passed.  It is reset when the rng changes or by reset_bit_buffers().
+ * Tests use their own context's reader instead (test[0]->ctx->bits).
+ */
+static Dbits shared_bits = {NULL,0,0,0,{0,0},-1,{0},{0},-1,-1,-1};
+
+static Dbits *get_shared_bits(gsl_rng *gsl_rng)
+{
+
+ if(shared_bits.rng != gsl_rng) bits_init(&shared_bits,gsl_rng,rmax_bits);
+ shared_bits.rmax_bits = rmax_bits;
+ return(&shared_bits);
+
+}
+
+unsigned int get_uint_rand(gsl_rng *gsl_rng)
+{
+
+ return(bits_get_uint_rand(get_shared_bits(gsl_rng)));
+
+}
+
+void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *gsl_rng)
+{
+
+ bits_get_rand_bits(get_shared_bits(gsl_rng),result,rsize,nbits);
+
+}
+
 /*
  * OK, I CLEARLY need this.  What it will do is take a source and
  * destination address and BIT level offsets therein and copy
@@ -1274,13 +1341,12 @@ void mybitadd(char *dst, int doffset, char *src, int soffset, int slen)
 /* static unsigned int pattern_output[BRBUF]; */
 
 void get_rand_pattern(void *result,unsigned int rsize,int *pattern,
-                      UNUSED_PARAM gsl_rng *gsl_rng)
+                      gsl_rng *gsl_rng)
 {
 
  unsigned int i,j,pindex,poffset;
  unsigned int bu,nbits,tmpuint;
  char *resultp;
- UNUSED_ARG(gsl_rng)
 
  MYDEBUG(D_BITS) {
    printf("# get_rand_pattern: Initializing with rsize = %u\n",rsize);
@@ -1367,7 +1433,7 @@ void get_rand_pattern(void *result,unsigned int rsize,int *pattern,
 	 j = pattern[i];
 	 while(j>bu) {
 
-	   get_rand_bits(&tmpuint,sizeof(unsigned int),bu,rng);
+	   get_rand_bits(&tmpuint,sizeof(unsigned int),bu,gsl_rng);
 	   /*
 		* Pack this whole uint into result at the offset.
 	*/
@@ -1381,7 +1447,7 @@ void get_rand_pattern(void *result,unsigned int rsize,int *pattern,
 
 	 }
 
-	 get_rand_bits(&tmpuint,sizeof(unsigned int),j,rng);
+	 get_rand_bits(&tmpuint,sizeof(unsigned int),j,gsl_rng);
 	 /*
 	  * Pack this partial uint into resultp
 	  */
@@ -1398,12 +1464,12 @@ void get_rand_pattern(void *result,unsigned int rsize,int *pattern,
 	 j = -pattern[i];
 	 while(j>bu) {
 	   /* skip whole uint's worth */
-	   get_rand_bits(&tmpuint,sizeof(unsigned int),bu,rng);
+	   get_rand_bits(&tmpuint,sizeof(unsigned int),bu,gsl_rng);
 	   j -= bu;
 
 	 }
 	 /* skip final remaining <bu chunk */
-	 get_rand_bits(&tmpuint,sizeof(unsigned int),j,rng);
+	 get_rand_bits(&tmpuint,sizeof(unsigned int),j,gsl_rng);
 
    } else {
 
@@ -1420,23 +1486,13 @@ void get_rand_pattern(void *result,unsigned int rsize,int *pattern,
 }
 
 /*
- * The bits.c module doesn't malloc anything, but it does maintain some
- * static buffers that must be cleared in order to achieve consistent
- * results from a rng reseed on, per run.
+ * The bits.c module doesn't malloc anything, but the shared bit reader
+ * used by get_uint_rand() and get_rand_bits() must be cleared in order
+ * to achieve consistent results from a rng reseed on, per run.
  */
 void reset_bit_buffers()
 {
 
-  int i;
-
-  bits_rand[0] = bits_rand[1] = 0;
-  bleft = -1;
-  for(i = 0;i<BRBUF;i++){
-	bits_randbuf[i] = 0;
-	bits_output[i] = 0;
-  }
-  brindex = -1;
-  iclear = -1;
-  bitindex = -1;
+ bits_reset(&shared_bits);
 
 }
@@ -0,0 +1,80 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The flat bitset (see Dbitset.h) the "missing words" tests use in
+ * place of a byte (or ten levels of pointers) per word.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+static inline unsigned int bitset_popcount(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+ return(__builtin_popcountll(x));
+#else
+ x = x - ((x >> 1) & 0x5555555555555555ULL);
+ x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+ x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+ return((unsigned int)((x * 0x0101010101010101ULL) >> 56));
+#endif
+}
+
+Dbitset *bitset_create(size_t nbits)
+{
+
+ Dbitset *b;
+
+ b = (Dbitset *)malloc(sizeof(Dbitset));
+ b->nbits = nbits;
+ b->nwords = (nbits + 63)/64;
+ b->words = (uint64_t *)calloc(b->nwords,sizeof(uint64_t));
+ return(b);
+
+}
+
+void bitset_destroy(Dbitset *b)
+{
+
+ if(b == NULL) return;
+ free(b->words);
+ free(b);
+
+}
+
+void bitset_clear(Dbitset *b)
+{
+
+ memset(b->words,0,b->nwords*sizeof(uint64_t));
+
+}
+
+/*
+ * The number of bits set.  Bits past nbits are never set.
+ */
+size_t bitset_count(Dbitset *b)
+{
+
+ size_t i,count = 0;
+
+ for(i=0;i<b->nwords;i++){
+   count += bitset_popcount(b->words[i]);
+ }
+ return(count);
+
+}
+
+/*
+ * The number of bits NOT set, i.e. missing words.
+ */
+size_t bitset_missing(Dbitset *b)
+{
+
+ return(b->nbits - bitset_count(b));
+
+}
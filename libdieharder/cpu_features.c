@@ -87,6 +87,126 @@ uint32_t x86_feature_flags(int major)
     }
 }
 
+/*
+ * The same for CPUID leaf 7 (subleaf 0), the "extended features" leaf
+ * where AVX2 (EBX bit 5), AVX-512F (EBX bit 16), AVX-512BW (EBX bit 30)
+ * and AVX-512 VPOPCNTDQ (ECX bit 14) live.
+ */
+uint32_t x86_feature_flags7(int major)
+{
+#if defined(HAVE_CPUID) && HAVE_CPUID
+#if defined(__clang__) || defined(__GNUC__)
+    uint32_t num_ids = 0, eax = 0, ebx = 0, ecx = 0, edx = 0;
+    num_ids = __get_cpuid_max(0, &ebx);
+    ebx = 0;
+    if (num_ids >= 7)
+    {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    }
+#elif defined(_MSC_VER) && defined(_WIN32)
+    int cpu_info[4] = {0};
+    int num_ids, eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __cpuid(cpu_info, 0);
+    num_ids = (int)cpu_info[0];
+    if (num_ids >= 7)
+    {
+        __cpuidex(cpu_info, 7, 0);
+        eax = cpu_info[0];
+        ebx = cpu_info[1];
+        ecx = cpu_info[2];
+        edx = cpu_info[3];
+    }
+#endif
+#else
+    uint32_t eax, ebx, ecx, edx;
+    eax = 0; ebx = 0; ecx = 0; edx = 0;
+#endif
+    switch(major){
+    case 0:
+      return eax;
+    case 1:
+      return ebx;
+    case 2:
+      return ecx;
+    case 3:
+      return edx;
+    default:
+      return 0;
+    }
+}
+
+/*
+ * XCR0, the register state the OS saves on a context switch.  The AVX
+ * feature bits only mean the CPU has the instructions; they are usable
+ * only if the OS saves the YMM (bits 1,2) and for AVX-512 also the ZMM
+ * and mask (bits 5,6,7) registers.  0 if we can't tell.
+ */
+uint64_t x86_xcr0(void)
+{
+#if defined(HAVE_CPUID) && HAVE_CPUID
+    /* OSXSAVE, leaf 1 ECX bit 27, says xgetbv is there to call */
+    if (!x86_feature_set(x86_feature_flags(DH_ECX), 27))
+      return 0;
+#if defined(__clang__) || defined(__GNUC__)
+    {
+      uint32_t lo, hi;
+      __asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+      return ((uint64_t)hi << 32) | lo;
+    }
+#elif defined(_MSC_VER) && defined(_WIN32)
+    return _xgetbv(0);
+#else
+    return 0;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/*
+ * AVX2 is leaf 7 EBX bit 5 and needs the YMM state saved, AVX-512F is
+ * EBX bit 16 and needs the ZMM and mask state too.  Computed once.
+ */
+int x86_simd_level(void)
+{
+    static int level = -1;
+    uint32_t ebx7;
+    uint64_t xcr0;
+
+    if (level >= 0)
+      return level;
+    level = X86_SIMD_NONE;
+    ebx7 = x86_feature_flags7(DH_EBX);
+    xcr0 = x86_xcr0();
+    if (x86_feature_set(ebx7, 5) && (xcr0 & 0x06) == 0x06)
+      level = X86_SIMD_AVX2;
+    if (level == X86_SIMD_AVX2 && x86_feature_set(ebx7, 16) && (xcr0 & 0xe6) == 0xe6)
+      level = X86_SIMD_AVX512;
+    return level;
+}
+
+/* VAES, leaf 7 ECX bit 9:  AES rounds on every 128 bit lane of a ymm
+   (or, with AVX-512, zmm) register. */
+int x86_has_vaes(void)
+{
+    return x86_simd_level() > X86_SIMD_NONE &&
+           x86_feature_set(x86_feature_flags7(DH_ECX), 9) != 0;
+}
+
+/* AVX-512 BW (leaf 7 EBX bit 30) and VPOPCNTDQ (ECX bit 14), for the
+   popcount kernels.  Computed once. */
+int x86_has_avx512_popcnt(void)
+{
+    static int has = -1;
+
+    if (has >= 0)
+      return has;
+    has = x86_simd_level() >= X86_SIMD_AVX512 &&
+          x86_feature_set(x86_feature_flags7(DH_EBX), 30) &&
+          x86_feature_set(x86_feature_flags7(DH_ECX), 14);
+    return has;
+}
+
 int is_genuine_intel()
 {
 #if defined(HAVE_CPUID) && HAVE_CPUID
@@ -52,8 +52,31 @@
   -1 if unknown, no CPUID insn */
 extern int is_genuine_intel();
 uint32_t x86_feature_flags(int major);
+uint32_t x86_feature_flags7(int major);
+uint64_t x86_xcr0(void);
 #define x86_feature_set(flags, i) ((flags) & (1 << (i)))
 
+/* The widest vector unit the OS lets us use, for the multi-lane
+   generator kernels (see rng_fill.h), and whether it has VAES. */
+#define X86_SIMD_NONE 0
+#define X86_SIMD_AVX2 1
+#define X86_SIMD_AVX512 2
+int x86_simd_level(void);
+int x86_has_vaes(void);
+int x86_has_avx512_popcnt(void);
+
+/* GCC/clang vector types for those kernels:  y for the 256 bit (AVX2)
+   and z for the 512 bit (AVX-512) registers, named to fit the uint##W##_t
+   of the Random123 templates. */
+#if defined(__GNUC__) && defined(__AVX2__)
+typedef uint32_t uinty32_t __attribute__((vector_size(32)));
+typedef uint64_t uinty64_t __attribute__((vector_size(32)));
+#endif
+#if defined(__GNUC__) && defined(__AVX512F__)
+typedef uint32_t uintz32_t __attribute__((vector_size(64)));
+typedef uint64_t uintz64_t __attribute__((vector_size(64)));
+#endif
+
 /* need bswap_64 */
 
 #if defined(__APPLE__)
@@ -31,6 +31,7 @@
 #define TABLE_SIZE (256 * SAMP_TOTAL)
 
 int dab_bytedistrib(Test **test, unsigned int irun) {
+ Dcontext *ctx = test[0]->ctx;
  Vtest vtest;
  unsigned int t,i,j;
  unsigned int counts[TABLE_SIZE];
@@ -46,7 +47,7 @@ int dab_bytedistrib(Test **test, unsigned int irun) {
      /*
       * Generate a word; this word will be used for SAMP_PER_WORD bytes.
       */
-     unsigned int word = gsl_rng_get(rng);
+     unsigned int word = gsl_rng_get(ctx->rng);
      unsigned char currentShift = 0;
      for (j = 0; j < SAMP_PER_WORD; j++) {
 
@@ -60,7 +61,7 @@ int dab_bytedistrib(Test **test, unsigned int irun) {
         * shift amounts correctly (at least I think it does; confirmed for
         * SAMP_PER_WORD==3 and a variety of rmax_bits values).
         */
-       unsigned char shiftAmount = ((j+1) * (rmax_bits - 8)) / (SAMP_PER_WORD - 1);
+       unsigned char shiftAmount = ((j+1) * (ctx->rmax_bits - 8)) / (SAMP_PER_WORD - 1);
        unsigned int v = word & 0x0ff;    /* v is the byte sampled from the word */
        word >>= shiftAmount - currentShift;
        currentShift += shiftAmount;
@@ -23,7 +23,9 @@
  * the randomNNN generators having three copies.
  *
  * Limitations: ntuple is required to be a power of 2, because a radix 2
- * algorithm is used to calculate the DCT.
+ * algorithm is used to calculate the DCT.  The DCT (see dct.c) is done
+ * directly at length ntuple from a plan made once per run, many
+ * vectors per call.
  *
  * False positives: targets are (mostly) calculated exactly, however it
  * will still return false positives when ntuple is small and tsamples is
@@ -36,7 +38,10 @@
 
 #include <dieharder/libdieharder.h>
 
-#define RotL(x,N)    (rmax_mask & (((x) << (N)) | ((x) >> (rmax_bits-(N)))))
+/* Words per batch of transforms */
+#define DCT_BATCH 16384
+
+#define RotL(x,N)    (ctx->rmax_mask & (((x) << (N)) | ((x) >> (ctx->rmax_bits-(N)))))
 
 void fDCT2(const unsigned int input[], double output[], size_t len);
 void iDCT2(const double input[], double output[], size_t len);
@@ -78,13 +83,15 @@ double evalMostExtreme(double *pvalue, unsigned int num);
 
 int dab_dct(Test **test, unsigned int irun)
 {
+ Dcontext *ctx = test[0]->ctx;
  double *dct;
  unsigned int *input;
  double *pvalues = NULL;
- unsigned int i, j;
- unsigned int len = (ntuple == 0) ? 256 : ntuple;
+ unsigned int i, j, b, nbatch;
+ Ddct *plan = NULL;
+ unsigned int len = (ctx->ntuple == 0) ? 256 : ctx->ntuple;
  int rotAmount = 0;
- const unsigned bits = rmax_bits - 1;
+ const unsigned bits = ctx->rmax_bits - 1;
  unsigned int v = 1U << bits;
  double mean = (double) len * (v - 0.5);
 
@@ -105,8 +112,14 @@ int dab_dct(Test **test, unsigned int irun)
  Xtest ptest;
  double sd = sqrt((1.0/6.0) * len) * v;
 
- dct = (double *) malloc(sizeof(double) * len);
- input = (unsigned int *) malloc(sizeof(unsigned int) * len);
+ /* The transforms are done DCT_BATCH words' worth of vectors at a
+  * time, with one plan for the whole run.  Lengths below 4 use the
+  * direct O(n^2) DCT.
+  */
+ nbatch = (len < DCT_BATCH) ? DCT_BATCH / len : 1;
+ if (len >= 4) plan = dct_create(len);
+ dct = (double *) malloc(sizeof(double) * len * nbatch);
+ input = (unsigned int *) malloc(sizeof(unsigned int) * len * nbatch);
  positionCounts = (double *) malloc(sizeof(double) * len);
 
  if (useFallbackMethod) {
@@ -127,48 +140,60 @@ int dab_dct(Test **test, unsigned int irun)
   * (tsamples * ntuple) words will be read from the RNG.
   */
  //fprintf (stderr, "rmax_bits: %u, rotl: %u\n", rmax_bits, rotAmount);
- for (j=0; j<test[0]->tsamples; j++) {
-   unsigned int pos = 0;
-   double max = 0;
-
-   /* Change the rotation amount after each quarter of the samples
-    * have been used.
-    */
-   if (j != 0 && (j % (test[0]->tsamples / 4) == 0)) {
-	 rotAmount += rmax_bits/4;
+ for (j=0; j<test[0]->tsamples; j+=nbatch) {
+
+   if (j + nbatch > test[0]->tsamples) nbatch = test[0]->tsamples - j;
+
+   for (b=0; b<nbatch; b++) {
+     /* Change the rotation amount after each quarter of the samples
+      * have been used.
+      */
+     if (j+b != 0 && ((j+b) % (test[0]->tsamples / 4) == 0)) {
+       rotAmount += ctx->rmax_bits/4;
+     }
+
+     /* Read (and rotate) the actual rng words. */
+     for (i=0; i<len; i++) {
+       input[b*len + i] = gsl_rng_get(ctx->rng);
+       if (rotAmount)
+         input[b*len + i] = RotL(input[b*len + i], rotAmount);
+     }
    }
 
-   /* Read (and rotate) the actual rng words. */
-   for (i=0; i<len; i++) {
-	 input[i] = gsl_rng_get(rng);
-         if (rotAmount)
-           input[i] = RotL(input[i], rotAmount);
+   /* Perform the DCTs */
+   if (plan) {
+     dct2_batch(plan, input, dct, nbatch);
+   } else {
+     for (b=0; b<nbatch; b++) fDCT2(input + b*len, dct + b*len, len);
    }
 
-   /* Perform the DCT */
-   fDCT2_fft(input, dct, len);
-
-   /* Adjust the first value (the DC coefficient). */
-   dct[0] -= mean;
-   dct[0] /= sqrt(2);  // Experimental + guess; seems to be correct.
-
-   if (!useFallbackMethod) {
-	 /* Primary method: find the position of the largest value. */
-	 for (i=0; i<len; i++) {
-	   if (fabs(dct[i]) > max) {
-		 pos = i;
-		 max = fabs(dct[i]);
-	   }
-	 }
-	 /* And record it. */
-	 positionCounts[pos]++;
-   } else {
-	 /* Fallback method: convert all values to pvalues. */
-	 for (i=0; i<len; i++) {
-	   ptest.x = dct[i] / sd;
-	   Xtest_eval(&ptest);
-	   pvalues[j*len + i] = ptest.pvalue;
-	 }
+   for (b=0; b<nbatch; b++) {
+     double *d = dct + b*len;
+     unsigned int pos = 0;
+     double max = 0;
+
+     /* Adjust the first value (the DC coefficient). */
+     d[0] -= mean;
+     d[0] /= sqrt(2);  // Experimental + guess; seems to be correct.
+
+     if (!useFallbackMethod) {
+       /* Primary method: find the position of the largest value. */
+       for (i=0; i<len; i++) {
+         if (fabs(d[i]) > max) {
+           pos = i;
+           max = fabs(d[i]);
+         }
+       }
+       /* And record it. */
+       positionCounts[pos]++;
+     } else {
+       /* Fallback method: convert all values to pvalues. */
+       for (i=0; i<len; i++) {
+         ptest.x = d[i] / sd;
+         Xtest_eval(&ptest);
+         pvalues[(j+b)*len + i] = ptest.pvalue;
+       }
+     }
    }
  }
 
@@ -193,6 +218,7 @@ int dab_dct(Test **test, unsigned int irun)
  nullfree(pvalues);  /* Conditional; only used in fallback */
  nullfree(input);
  nullfree(dct);
+ if (plan) dct_destroy(plan);
 
  return(0);
 }
@@ -208,6 +234,8 @@ int gsl_fft_real_radix2_transform (double data[], size_t stride, size_t n);
 /*
  * Perform a type-II DCT using GSL's FFT function.
  * Assumes len is a power of 2
+ * No longer used by the test (see dct.c), but kept as the reference
+ * main_dab_dct() checks against.
  */
 void fDCT2_fft(const unsigned int input[], double output[], size_t len) {
  double *fft_data;
@@ -22,7 +22,7 @@
  */
 #include <dieharder/libdieharder.h>
 
-#define RotL(x,N)    (rmax_mask & (((x) << (N)) | ((x) >> (rmax_bits-(N)))))
+#define RotL(x,N)    (ctx->rmax_mask & (((x) << (N)) | ((x) >> (ctx->rmax_bits-(N)))))
 #define CYCLES 4
 
 static double targetData1[] __attribute__((unused)) = {
@@ -38,7 +38,8 @@ static inline int insert(double x, double *array, unsigned int startVal);
 
 // FIXME: this test is broken. Always use dab_filltree2
 int dab_filltree(Test **test,unsigned int irun) {
- unsigned int size = (ntuple == 0) ? 32 : ntuple;
+ Dcontext *ctx = test[0]->ctx;
+ unsigned int size = (ctx->ntuple == 0) ? 32 : ctx->ntuple;
  unsigned int target = sizeof(targetData)/sizeof(double);
  int startVal = (size / 2) - 1;
  double *array = (double *) malloc(sizeof(double) * size);
@@ -90,9 +91,9 @@ int dab_filltree(Test **test,unsigned int irun) {
    memset(array, 0, sizeof(double) * size);
    i = 0;
    do {
-     unsigned int v = gsl_rng_get(rng);
+     unsigned int v = gsl_rng_get(ctx->rng);
 
-     x = (double) (rotAmount ? RotL(v, rotAmount) / rmax_mask : (v / rmax_mask));
+     x = (double) (rotAmount ? RotL(v, rotAmount) / ctx->rmax_mask : (v / ctx->rmax_mask));
      i++;
      if (i > size * 2) {
        test[0]->pvalues[irun] = 0;
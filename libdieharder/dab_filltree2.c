@@ -95,7 +95,8 @@ static double targetData[128] = {  // size=128, generated from 6e9 samples
 static inline int insertBit(uint x, uchar *array, uint *i, uint *d);
 
 int dab_filltree2(Test **test, unsigned int irun) {
- unsigned int size = (ntuple == 0) ? 128 : ntuple;
+ Dcontext *ctx = test[0]->ctx;
+ unsigned int size = (ctx->ntuple == 0) ? 128 : ctx->ntuple;
  uint target = sizeof(targetData)/sizeof(double);
  int startVal = (size / 2) - 1;
  uchar *array = (uchar *) malloc(sizeof(*array) * size);
@@ -141,8 +142,8 @@ int dab_filltree2(Test **test, unsigned int irun) {
  }
  start++;
 
- x = gsl_rng_get(rng);
- bitCount = rmax_bits;
+ x = gsl_rng_get(ctx->rng);
+ bitCount = ctx->rmax_bits;
  for (j = 0; j < test[0]->tsamples; j++) {
    int ret;
    memset(array, 0, sizeof(*array) * size);
@@ -158,8 +159,8 @@ int dab_filltree2(Test **test, unsigned int irun) {
        ret = insertBit(x & 0x01, array, &index, &d);  /* Keep going */
        x >>= 1;
        if (--bitCount == 0) {
-         x = gsl_rng_get(rng);
-         bitCount = rmax_bits;
+         x = gsl_rng_get(ctx->rng);
+         bitCount = ctx->rmax_bits;
        }
      } while (ret == -2);  /* End of path. */
 
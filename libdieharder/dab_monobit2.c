@@ -19,18 +19,22 @@
 
 #include <dieharder/libdieharder.h>
 #define BLOCK_MAX (16)
+#define MONOBIT2_BUF (4096)
 
 /* The evalMostExtreme function is in dab_dct.c */
 extern double evalMostExtreme(double *pvalue, uint num);
 
 int dab_monobit2(Test **test, unsigned int irun)
 {
+ Dcontext *ctx = test[0]->ctx;
  uint i, j;
- uint blens = rmax_bits;
- uint ntup = ntuple;
+ uint blens = ctx->rmax_bits;
+ uint ntup = ctx->ntuple;
  double *counts;
  uint *tempCount;
  double pvalues[BLOCK_MAX];
+ uint *buf, nbuf;
+ unsigned char *bitCount;
 
  /* First, find out the maximum block size to use.
   * The maximum size will be 2^ntup words.
@@ -52,22 +56,21 @@ int dab_monobit2(Test **test, unsigned int irun)
  tempCount = (uint *) malloc(sizeof(*tempCount) * ntup);
  memset(tempCount, 0, sizeof(*tempCount) * ntup);
 
+ buf = (uint *) malloc(sizeof(*buf) * MONOBIT2_BUF);
+ bitCount = (unsigned char *) malloc(sizeof(*bitCount) * MONOBIT2_BUF);
+
  for(i=0;i<test[0]->tsamples;i++) {
-   uint n = gsl_rng_get(rng);
+   uint n;
    uint t = 1;
 
-   // Begin: count bits
-   n -= (n >> 1) & 0x55555555;
-   n = (n & 0x33333333) + ((n >> 2) & 0x33333333);
-   n = (n + (n >> 4)) & 0x0f0f0f0f;
-
-   if (0) {
-     n = (n * 0x01010101) >> 24;
-  } else {
-     n = n + (n >> 8);
-     n = (n + (n >> 16)) & 0x3f;
-  }
-  // End: count bits
+   // Count bits a buffer of rands at a time (see popcount.c)
+   if (i % MONOBIT2_BUF == 0) {
+     nbuf = test[0]->tsamples - i;
+     if (nbuf > MONOBIT2_BUF) nbuf = MONOBIT2_BUF;
+     fill_u32(ctx->rng, buf, nbuf);
+     popcount_u32_each(buf, bitCount, nbuf);
+   }
+   n = bitCount[i % MONOBIT2_BUF];
 
   for (j = 0; j < ntup; j++) {
     tempCount[j] += n;  // Update block count
@@ -94,6 +97,8 @@ int dab_monobit2(Test **test, unsigned int irun)
 
  nullfree(counts);
  nullfree(tempCount);
+ nullfree(buf);
+ nullfree(bitCount);
 
  return(0);
 }
@@ -0,0 +1,190 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The type II DCT (see Ddct.h) behind dab_dct.
+ *
+ * A length n DCT-II is a length n DFT of the input reordered as
+ *
+ *   v[m] = x[2m],  v[n-1-m] = x[2m+1],   m < n/2
+ *
+ * followed by a quarter wave phase shift,
+ *
+ *   X[k] = Re( exp(-i pi k/2n) V[k] )
+ *
+ * (Makhoul, 1980).  v is real, so V is got from an n/2 point complex
+ * FFT of z[m] = v[2m] + i v[2m+1] and the usual even/odd split.  That
+ * is an eighth of the work of the old way, a 4n point real FFT of the
+ * symmetric extension of x, and all the trig is done in dct_create().
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+Ddct *dct_create(unsigned int n)
+{
+
+ Ddct *p;
+ unsigned int i,j,b,h;
+
+ if(n < 4 || (n & (n-1)) != 0){
+   fprintf(stderr,"Error: dct_create() needs a power of 2 length of at least 4, not %u.\n",n);
+   exit(0);
+ }
+
+ p = (Ddct *)malloc(sizeof(Ddct));
+ p->n = n;
+ p->h = h = n/2;
+ p->rev = (unsigned int *)malloc(h*sizeof(unsigned int));
+ p->fft_tw = (double *)malloc((h/2 + 1)*2*sizeof(double));
+ p->real_tw = (double *)malloc((h+1)*2*sizeof(double));
+ p->dct_tw = (double *)malloc((h+1)*2*sizeof(double));
+ p->z = (double *)malloc(h*2*sizeof(double));
+
+ for(i=0;i<h;i++){
+   for(j=0,b=1;b<h;b<<=1){
+     j = (j << 1) | ((i & b) ? 1 : 0);
+   }
+   p->rev[i] = j;
+ }
+ for(i=0;i<h/2;i++){
+   p->fft_tw[2*i]   = cos(2.0*M_PI*i/h);
+   p->fft_tw[2*i+1] = -sin(2.0*M_PI*i/h);
+ }
+ for(i=0;i<=h;i++){
+   p->real_tw[2*i]   = cos(2.0*M_PI*i/n);
+   p->real_tw[2*i+1] = -sin(2.0*M_PI*i/n);
+   p->dct_tw[2*i]    = cos(M_PI*i/(2.0*n));
+   p->dct_tw[2*i+1]  = sin(M_PI*i/(2.0*n));
+ }
+
+ return(p);
+
+}
+
+void dct_destroy(Ddct *p)
+{
+
+ free(p->z);
+ free(p->dct_tw);
+ free(p->real_tw);
+ free(p->fft_tw);
+ free(p->rev);
+ free(p);
+
+}
+
+/*
+ * In place iterative radix 2 FFT of the h points in z[], which are
+ * already in bit reversed order.
+ */
+static void dct_fft(Ddct *p)
+{
+
+ unsigned int h = p->h;
+ unsigned int len,half,step,i,j;
+ double *z = p->z;
+ double wr,wi,ur,ui,tr,ti;
+
+ for(len=2;len<=h;len<<=1){
+   half = len/2;
+   step = h/len;
+   for(i=0;i<h;i+=len){
+     for(j=0;j<half;j++){
+       wr = p->fft_tw[2*j*step];
+       wi = p->fft_tw[2*j*step+1];
+       ur = z[2*(i+j)];
+       ui = z[2*(i+j)+1];
+       tr = wr*z[2*(i+j+half)] - wi*z[2*(i+j+half)+1];
+       ti = wr*z[2*(i+j+half)+1] + wi*z[2*(i+j+half)];
+       z[2*(i+j)]        = ur + tr;
+       z[2*(i+j)+1]      = ui + ti;
+       z[2*(i+j+half)]   = ur - tr;
+       z[2*(i+j+half)+1] = ui - ti;
+     }
+   }
+ }
+
+}
+
+void dct2_batch(Ddct *p, const unsigned int *in, double *out, unsigned int nvec)
+{
+
+ unsigned int n = p->n, h = p->h;
+ unsigned int v,m,k,r;
+ const unsigned int *x;
+ double *X,*z = p->z;
+ double ar,ai,br,bi,er,ei,or_,oi,wr,wi,vr,vi,c,s;
+
+ for(v=0;v<nvec;v++){
+   x = in + (size_t) v*n;
+   X = out + (size_t) v*n;
+
+   /*
+    * z[m] = v[2m] + i v[2m+1], dropped straight into bit reversed
+    * order.  v[2m] is x[4m] for 2m < h, x[2n-4m-1] after that (and the
+    * same with 4m+2 for v[2m+1]).
+    */
+   for(m=0;m<h;m++){
+     r = p->rev[m];
+     z[2*r]   = (2*m < h) ? x[4*m]   : x[2*n - 4*m - 1];
+     z[2*r+1] = (2*m < h) ? x[4*m+2] : x[2*n - 4*m - 3];
+   }
+   dct_fft(p);
+
+   /*
+    * Split Z into the transforms of the even and odd points of v,
+    * E[k] = (Z[k] + conj(Z[h-k]))/2, O[k] = (Z[k] - conj(Z[h-k]))/2i,
+    * so V[k] = E[k] + exp(-2 pi i k/n) O[k], and V[n-k] = conj(V[k]).
+    * Then shift:  X[k] = Re V[k] cos + Im V[k] sin, and
+    * X[n-k] = Re V[k] sin - Im V[k] cos, at angle pi k/2n.
+    */
+   for(k=0;k<=h/2;k++){
+     ar = z[2*(k%h)];
+     ai = z[2*(k%h)+1];
+     br = z[2*((h-k)%h)];
+     bi = z[2*((h-k)%h)+1];
+
+     /* V[k] */
+     er = 0.5*(ar + br);
+     ei = 0.5*(ai - bi);
+     or_ = 0.5*(ai + bi);
+     oi = -0.5*(ar - br);
+     wr = p->real_tw[2*k];
+     wi = p->real_tw[2*k+1];
+     vr = er + wr*or_ - wi*oi;
+     vi = ei + wr*oi + wi*or_;
+     c = p->dct_tw[2*k];
+     s = p->dct_tw[2*k+1];
+     X[k] = vr*c + vi*s;
+     if(k > 0) X[n-k] = vr*s - vi*c;
+
+     if(k == 0 || 2*k == h) continue;
+
+     /* V[h-k], from the same pair the other way round */
+     er = 0.5*(br + ar);
+     ei = 0.5*(bi - ai);
+     or_ = 0.5*(bi + ai);
+     oi = -0.5*(br - ar);
+     wr = p->real_tw[2*(h-k)];
+     wi = p->real_tw[2*(h-k)+1];
+     vr = er + wr*or_ - wi*oi;
+     vi = ei + wr*oi + wi*or_;
+     c = p->dct_tw[2*(h-k)];
+     s = p->dct_tw[2*(h-k)+1];
+     X[h-k] = vr*c + vi*s;
+     X[n-h+k] = vr*s - vi*c;
+   }
+
+   /*
+    * V[h] = E[0] - O[0], real.
+    */
+   vr = z[0] - z[1];
+   X[h] = vr*p->dct_tw[2*h];
+ }
+
+}
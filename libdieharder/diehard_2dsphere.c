@@ -34,7 +34,11 @@
  * convince themselves that this is so.
  *
  * I did make one set of changes to this test to make it considerably more
- * efficient at extracting the minimum distance.
+ * efficient at extracting the minimum distance.  It is now found by
+ * min_distance2(), which only compares neighboring points, so tsamples
+ * can be made much larger than 8000 without the cost going quadratic.
+ * The mean of d^2 scales like (10000/n)^2, so for n other than 8000 we
+ * scale Marsaglia's .995 to match.
  * ========================================================================
  */
 
@@ -44,32 +48,23 @@
 #define POINTS_2D 8000
 #define DIM_2D 2
 
-typedef struct {
-  double x[DIM_2D];
-} C3_2D;
- 
-int compare_points(const dTuple *a,const dTuple *b);
-double distance(const dTuple a,const dTuple b,uint dim);
-
 int diehard_2dsphere(Test **test, unsigned int irun)
 {
 
- unsigned int i,j,d,t;
+ unsigned int d,t;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
-  * These are the vector of points and the current point being
-  * considered.  We may or may not need to restructure the vectors
-  * to be able to do the sort.  I'm going to TRY to implement
-  * Fischler's suggested algorithm here that is NlogN instead of doing
-  * the straightforward N^2 algorithm, but we'll see.
+  * The points, coordinate by coordinate (x[d*tsamples + t]) the way
+  * min_distance2() wants them.
   */
- dTuple *points;
- double dist,mindist;
+ double *x;
+ double scale,mindist;
 
  /*
   * for display only.
   */
- test[0]->ntuple = ntuple;
+ test[0]->ntuple = ctx->ntuple;
 
  /*
   * Generate d-tuples of tsamples random coordinates in the range 0-10000
@@ -79,7 +74,7 @@ int diehard_2dsphere(Test **test, unsigned int irun)
   * independent tests, per dimension.
   */
  test[0]->ntuple = 2;      /* 2 dimensional test, of course */
- points = (dTuple *)malloc(test[0]->tsamples*sizeof(dTuple));
+ x = (double *)malloc(DIM_2D*test[0]->tsamples*sizeof(double));
 
 
  if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
@@ -93,10 +88,10 @@ int diehard_2dsphere(Test **test, unsigned int irun)
    if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
        printf("points[%u]: (",t);
    }
-   for(d=0;d<2;d++) {
-     points[t].c[d] = gsl_rng_uniform_pos(rng)*10000;
+   for(d=0;d<DIM_2D;d++) {
+     x[d*test[0]->tsamples + t] = gsl_rng_uniform_pos(ctx->rng)*10000;
      if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
-       printf("%6.4f",points[t].c[d]);
+       printf("%6.4f",x[d*test[0]->tsamples + t]);
        if(d == 1){
          printf(")\n");
        } else {
@@ -107,51 +102,13 @@ int diehard_2dsphere(Test **test, unsigned int irun)
  }
 
  /*
-  * Now we sort the points using gsl_heapsort and a comparator
-  * on the first coordinate only.  Don't know how to get rid
-  * of the gcc prototype warning.  Probably need a cast of some
-  * sort.
+  * One thing to experiment with here (very much) is whether or not
+  * we need periodic wraparound.  For the moment we omit it, although
+  * distributing the points on a euclidean d-torus seems more symmetric
+  * than not and checks to be sure that points are correct on or very
+  * near a boundary.
   */
- gsl_heapsort(points,test[0]->tsamples,sizeof(dTuple),
-                    (gsl_comparison_fn_t) compare_points);
-
- if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
-   printf("List of points sorted by first coordinate:\n");
-   for(t=0;t<test[0]->tsamples;t++){
-     printf("points[%u]: (",t);
-     for(d=0;d<2;d++) {
-       printf("%6.4f",points[t].c[d]);
-       if(d == 1){
-         printf(")\n");
-       } else {
-         printf(",");
-       }
-     }
-   }
- }
-
- /*
-  * Now we do the SINGLE PASS through to determine mindist
-  */
- mindist = 10000.0;
- for(i=0;i<test[0]->tsamples;i++){
-   /*
-    * One thing to experiment with here (very much) is
-    * whether or not we need periodic wraparound.  For
-    * the moment we omit it, although distributing
-    * the points on a euclidean d-torus seems more symmetric
-    * than not and checks to be sure that points are correct
-    * on or very near a boundary.
-    */
-   for(j=i+1;j<test[0]->tsamples;j++){
-     if(points[j].c[0] - points[i].c[0] > mindist) break;
-     dist = distance(points[j],points[i],2);
-     MYDEBUG(D_DIEHARD_2DSPHERE) {
-       printf("d(%d,%d) = %16.10e\n",i,j,dist);
-     }
-     if( dist < mindist) mindist = dist;
-   }
- }
+ mindist = sqrt(min_distance2(x,test[0]->tsamples,DIM_2D,10000.0,0));
  MYDEBUG(D_DIEHARD_2DSPHERE) {
    printf("Found minimum distance = %16.10e\n",mindist);
  }
@@ -167,9 +124,10 @@ int diehard_2dsphere(Test **test, unsigned int irun)
   * the qarg correction piece.  Hmmm, I could do that by hacking
   * its value to 1.0 in rgb_minimum_distance now, couldn't I?
   */
- test[0]->pvalues[irun] = 1.0 - exp(-mindist*mindist/0.995);
+ scale = (double) POINTS_2D/test[0]->tsamples;
+ test[0]->pvalues[irun] = 1.0 - exp(-mindist*mindist/(0.995*scale*scale));
 
- free(points);
+ free(x);
 
  MYDEBUG(D_DIEHARD_2DSPHERE) {
    printf("# diehard_2dsphere(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
@@ -35,6 +35,10 @@
  * each variable by one bit position in between a simple run of the test.
  * A full run will therefore be 32 simple (rotated) runs on bits 1-24, and
  * we can do -p psamples runs to get a final set of p-values to evaluate.
+ *
+ * Both sorts are done with radix_sort_uint(), which is linear in nms,
+ * so nms (-x) can be raised well past diehard's 512 (with nbits (-y)
+ * raised to keep lambda near 2) at little extra cost.
  *========================================================================
  */
 
@@ -43,16 +47,16 @@
 #define NMS   512
 #define NBITS 24
 
-static double lambda;
-static unsigned int *intervals;
-static unsigned int nms,nbits,kmax;
-
 int diehard_birthdays(Test **test, unsigned int irun)
 {
 
  uint i,k,t,m,mnext;
  uint *js;
- uint rand_uint[NMS];
+ uint *rand_uint;
+ uint nms,nbits,kmax;
+ uint *intervals,*scratch;
+ double lambda;
+ Dcontext *ctx = test[0]->ctx;
  
  double binfreq;
 
@@ -62,16 +66,14 @@ int diehard_birthdays(Test **test, unsigned int irun)
  test[0]->ntuple = 0;
 
  /*
-  * We are taking a small step backwards and fixing these
-  * so that they are the old diehard values until we figure
-  * out how to deal with variable argument lists, which may be
-  * never in the CLI version.
+  * These are the old diehard values unless they are reset with
+  * -x nms and -y nbits.
   */
- /* Cruft nms = diehard_birthdays_nms; */
  nms = NMS;
- /* Cruft nbits = diehard_birthdays_nbits; */
+ if(ctx->x_user >= 2.0) nms = (uint) ctx->x_user;
  nbits = NBITS;
- if(nbits>rmax_bits) nbits = rmax_bits;
+ if(ctx->y_user >= 1.0 && ctx->y_user <= 32.0) nbits = (uint) ctx->y_user;
+ if(nbits>ctx->rmax_bits) nbits = ctx->rmax_bits;
 
  /*
   * This is the one thing that matters.  We're going to make the
@@ -87,9 +89,12 @@ int diehard_birthdays(Test **test, unsigned int irun)
  lambda = (double)nms*nms*nms/pow(2.0,(double)nbits+2.0);
 
  /*
-  * Allocate memory for intervals
+  * Allocate memory for the birthdays, their intervals, and the
+  * scratch space both sorts share.
   */
+ rand_uint = (unsigned int *)malloc(nms*sizeof(unsigned int));
  intervals = (unsigned int *)malloc((nms+1)*sizeof(unsigned int));
+ scratch = (unsigned int *)malloc(nms*sizeof(unsigned int));
 
  /*
   * This should be more than twice as many slots as we really
@@ -135,7 +140,7 @@ int diehard_birthdays(Test **test, unsigned int irun)
       *
       * Note -- removed all reference to overlap.
       */
-     get_rand_bits(&rand_uint[m],sizeof(uint),nbits,rng);
+     bits_get_rand_bits(&ctx->bits,&rand_uint[m],sizeof(uint),nbits);
      MYDEBUG(D_DIEHARD_BDAY){
        printf("  %d-bit int = ",nbits);
        /* Should count dump from the right, sorry */
@@ -153,7 +158,7 @@ int diehard_birthdays(Test **test, unsigned int irun)
        printf("Before sort %u:  %u\n",m,rand_uint[m]);
      }
    }
-   gsl_sort_uint(rand_uint,1,nms);
+   radix_sort_uint(rand_uint,scratch,nms);
    MYDEBUG(D_DIEHARD_BDAY){
      for(m=0;m<nms;m++){
        printf("After sort %u:  %u\n",m,rand_uint[m]);
@@ -168,7 +173,7 @@ int diehard_birthdays(Test **test, unsigned int irun)
    for(m=1;m<nms;m++){
      intervals[m] = rand_uint[m] - rand_uint[m-1];
    }
-   gsl_sort_uint(intervals,1,nms);
+   radix_sort_uint(intervals,scratch,nms);
    MYDEBUG(D_DIEHARD_BDAY){
      for(m=0;m<nms;m++){
        printf("Sorted Intervals %u:  %u\n",m,intervals[m]);
@@ -250,7 +255,9 @@ int diehard_birthdays(Test **test, unsigned int irun)
    printf("# diehard_birthdays(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
+ nullfree(rand_uint);
  nullfree(intervals);
+ nullfree(scratch);
  nullfree(js);
 
  return(0);
@@ -46,10 +46,11 @@ int diehard_bitstream(Test **test, unsigned int irun)
 
  uint i,j,t,boffset,coffset;
  Xtest ptest;
- char *w;
+ Dbitset *w;
  uint *bitstream,w20,wscratch,newbyte;
  unsigned char *cbitstream = 0;
  uint overlap = 1;  /* Leftovers/Cruft */
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
@@ -81,9 +82,7 @@ int diehard_bitstream(Test **test, unsigned int irun)
  if(overlap){
    ptest.sigma = 428.0;
    bitstream = (uint *)malloc(BS_OVERLAP*sizeof(uint));
-   for(i = 0; i < BS_OVERLAP; i++){
-     bitstream[i] = get_rand_bits_uint(32,0xffffffff,rng);
-   }
+   get_rand_bits_uints(bitstream,BS_OVERLAP,&ctx->bits);
    MYDEBUG(D_DIEHARD_BITSTREAM) {
      printf("# diehard_bitstream: Filled bitstream with %u rands for overlapping\n",BS_OVERLAP);
      printf("# diehard_bitstream: samples.  Target is mean 141909, sigma = 428.\n");
@@ -91,9 +90,7 @@ int diehard_bitstream(Test **test, unsigned int irun)
  } else {
    ptest.sigma = 290.0;
    bitstream = (uint *)malloc(BS_NO_OVERLAP*sizeof(uint));
-   for(i = 0; i < BS_NO_OVERLAP; i++){
-     bitstream[i] = get_rand_bits_uint(32,0xffffffff,rng);
-   }
+   get_rand_bits_uints(bitstream,BS_NO_OVERLAP,&ctx->bits);
    cbitstream = (unsigned char *)bitstream;   /* To allow us to access it by bytes */
    MYDEBUG(D_DIEHARD_BITSTREAM) {
      printf("# diehard_bitstream: Filled bitstream with %u rands for non-overlapping\n",BS_NO_OVERLAP);
@@ -103,18 +100,17 @@ int diehard_bitstream(Test **test, unsigned int irun)
 
  /*
   * We now make test[0]->tsamples measurements, as usual, to generate the
-  * missing statistic.  The easiest way to proceed is to just increment a
-  * vector of length 2^20 using the generated ntuples as the indices of
-  * the slot being incremented.  Then we zip through the vector counting
-  * the remaining zeros.  This is horribly nonlocal but then, these ARE
-  * random numbers, right?
+  * missing statistic.  The easiest way to proceed is to just set a bit
+  * in a bitset of length 2^20 using the generated ntuples as the indices
+  * of the bit being set.  Then we count the remaining zeros.  This is
+  * horribly nonlocal but then, these ARE random numbers, right?  At
+  * least the whole bitset (128K) fits in cache.
   */
 
- w = (char *)malloc(M*sizeof(char));
- memset(w,0,M*sizeof(char));
+ w = bitset_create(M);
 
  MYDEBUG(D_DIEHARD_BITSTREAM) {
-   printf("# diehard_bitstream: w[] (counter vector) is allocated and zeroed\n");
+   printf("# diehard_bitstream: w (bitset) is allocated and zeroed\n");
  }
 
  i = 0;
@@ -169,7 +165,7 @@ int diehard_bitstream(Test **test, unsigned int irun)
        dumpuintbits(&w20, 1);
        printf("\n");
      }
-     w[w20]++;
+     bitset_set(w,w20);
 
    } else {
 
@@ -235,7 +231,7 @@ int diehard_bitstream(Test **test, unsigned int irun)
          printf("\n");
        }
      }
-     w[w20]++;
+     bitset_set(w,w20);
 
    }
  }
@@ -243,13 +239,7 @@ int diehard_bitstream(Test **test, unsigned int irun)
  /*
   * Now we count the holes, so to speak
   */
- ptest.x = 0;
- for(i=0;i<M;i++){
-   if(w[i] == 0){
-     ptest.x++;
-     /* printf("ptest.x = %f  Hole: w[%u] = %u\n",ptest.x,i,w[i]); */
-   }
- }
+ ptest.x = bitset_missing(w);
  if(verbose == D_DIEHARD_BITSTREAM || verbose == D_ALL){
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
  }
@@ -271,7 +261,7 @@ int diehard_bitstream(Test **test, unsigned int irun)
   * Don't forget to free or we'll leak.  Hate to have to wear
   * depends...
   */
- nullfree(w);
+ bitset_destroy(w);
  nullfree(bitstream);
 
  return(0);
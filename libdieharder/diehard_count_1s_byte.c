@@ -155,13 +155,18 @@ const double pb[]={
  */
 #define LSHIFT5(old,new) (old*5 + new)
 
+/* Samples (of five rands each) per buffer */
+#define COUNT1S_BYTE_BUF 1024
+
 int diehard_count_1s_byte(Test **test, unsigned int irun)
 {
 
  uint i,j,k,index5=0,index4,letter,t;
- uint boffset;
+ uint boffset,n,nt;
+ uint *buf;
  Vtest vtest4,vtest5;
  Xtest ptest;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * count_1s in specific bytes is straightforward after looking over
@@ -255,45 +260,55 @@ int diehard_count_1s_byte(Test **test, unsigned int irun)
  }
 
  /*
-  * Here is the test.  We cycle boffset through test[0]->tsamples
+  * Here is the test.  We cycle boffset through test[0]->tsamples.  Each
+  * sample takes its five bytes from five successive rands, which we
+  * draw a buffer at a time -- the same rands in the same order as one
+  * at a time, but without a trip through the generator for each one.
   */
- boffset = 0;
- for(t=0;t<test[0]->tsamples;t++){
+ buf = (uint *)malloc(5*COUNT1S_BYTE_BUF*sizeof(uint));
+ for(t=0;t<test[0]->tsamples;){
+   nt = test[0]->tsamples - t;
+   if(nt > COUNT1S_BYTE_BUF) nt = COUNT1S_BYTE_BUF;
+   get_rand_bits_uints(buf,5*nt,&ctx->bits);
+   for(n=0;n<nt;n++,t++){
 
-   boffset = t%32;  /* Remember that get_bit_ntuple periodic wraps the uint */
-   /*
-    * Get the next five bytes and make an index5 out of them, no
-    * overlap.
-    */
-   for(k=0;k<5;k++){
-     i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
-     if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-       dumpbits(&i,32);
-     }
+     boffset = t%32;  /* Remember that get_bit_ntuple periodic wraps the uint */
      /*
-      * get next byte from the last rand we generated.
-      * Bauer fix - 
-      *   Cruft: j = get_bit_ntuple_from_uint(i,8,0x000000FF,boffset);
+      * Get the next five bytes and make an index5 out of them, no
+      * overlap.
       */
-     j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,boffset);
-     index5 = LSHIFT5(index5,b5b[j]);
-     if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-       printf("b5b[%u] = %u, index5 = %u\n",j,b5b[j],index5);
-       dumpbits(&j,8);
+     for(k=0;k<5;k++){
+       i = buf[5*n+k];
+       if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
+         dumpbits(&i,32);
+       }
+       /*
+        * get next byte from the last rand we generated.
+        * Bauer fix - 
+        *   Cruft: j = get_bit_ntuple_from_uint(i,8,0x000000FF,boffset);
+        */
+       j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,boffset);
+       index5 = LSHIFT5(index5,b5b[j]);
+       if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
+         printf("b5b[%u] = %u, index5 = %u\n",j,b5b[j],index5);
+         dumpbits(&j,8);
+       }
      }
+     /*
+      * We use modulus to throw away the sixth digit in the left-shifted
+      * base 5 index value, keeping the value of the 5-digit base 5 number
+      * in the range 0 to 5^5-1 or 0 to 3124 decimal.  We repeat for the
+      * four digit index.  At this point we increment the counts for index4
+      * and index5.  Tres simple, no?
+      */
+     index5 = index5%3125;
+     index4 = index5%625;
+     vtest4.x[index4]++;
+     vtest5.x[index5]++;
    }
-   /*
-    * We use modulus to throw away the sixth digit in the left-shifted
-    * base 5 index value, keeping the value of the 5-digit base 5 number
-    * in the range 0 to 5^5-1 or 0 to 3124 decimal.  We repeat for the
-    * four digit index.  At this point we increment the counts for index4
-    * and index5.  Tres simple, no?
-    */
-   index5 = index5%3125;
-   index4 = index5%625;
-   vtest4.x[index4]++;
-   vtest5.x[index5]++;
  }
+ free(buf);
+
  /*
   * OK, all that is left now is to figure out the statistic.
   */
@@ -143,6 +143,15 @@ const double ps[]={
 0.218750000,
 0.144531250};
 
+/*
+ * The same map from the NUMBER of 1's in a byte (0-8) to its letter,
+ * for popcount_bytes_lut().
+ */
+const unsigned char b5lut[16] = {0,0,0,1,2,3,4,4,4,0,0,0,0,0,0,0};
+
+/* Rands per buffer in the overlapping test */
+#define COUNT1S_BUF 4096
+
 #define LSHIFT5(old,new) (old*5 + new)
 
 int diehard_count_1s_stream(Test **test, unsigned int irun)
@@ -153,6 +162,9 @@ int diehard_count_1s_stream(Test **test, unsigned int irun)
  Vtest vtest4,vtest5;
  Xtest ptest;
  uint overlap = 1; /* leftovers/cruft */
+ uint *buf,nw;
+ unsigned char *letters;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * Count a Stream of 1's is a very complex way of generating a statistic.
@@ -254,99 +266,61 @@ int diehard_count_1s_stream(Test **test, unsigned int irun)
    }
  }
 
- /*
-  * Preload index with the four bytes of the first rand if overlapping
-  * only.
-  */
  if(overlap){
-   i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
-   MYDEBUG(D_DIEHARD_COUNT_1S_STREAM){
-     dumpbits(&i,32);
-   }
-   /* 1st byte */
    /*
-    * Bauer fix.  I don't think he likes my getting ntuples sequentially
-    * from the stream in diehard tests, which is fair enough...;-)
-    * In the raw bit distribution tests, however, it is essential.
-    * j = get_bit_ntuple_from_uint(i,8,0x000000FF,0);
+    * Overlapping 5-letter words, a letter per byte, according to the
+    * diehard prescription (designed to work with a very small input
+    * file of rands).  The bytes of each rand are taken least significant
+    * first.  We draw the rands a buffer at a time and turn all of their
+    * bytes into letters in one call (see popcount.c).  The first rand
+    * preloads the first four letters of index5; after that each sample
+    * shifts in one more, so we use exactly 1 + tsamples/4 (rounded up)
+    * rands, just as when we drew them one at a time.
     */
-   j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,0);
-   index5 = b5s[j];
-   if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-     printf("b5s[%u] = %u, index5 = %u\n",j,b5s[j],index5);
-     dumpbits(&j,8);
-   }
-   /* 2nd byte */
-   /* Cruft:  See above.  j = get_bit_ntuple_from_uint(i,8,0x000000FF,8); */
-   j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,8);
-   index5 = LSHIFT5(index5,b5s[j]);
-   if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-     printf("b5s[%u] = %u, index5 = %u\n",j,b5s[j],index5);
-     dumpbits(&j,8);
-   }
-   /* 3rd byte */
-   /* Cruft:  See above. j = get_bit_ntuple_from_uint(i,8,0x000000FF,16); */
-   j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,16);
-   index5 = LSHIFT5(index5,b5s[j]);
+   buf = (uint *)malloc(COUNT1S_BUF*sizeof(uint));
+   letters = (unsigned char *)malloc(4*COUNT1S_BUF);
+
+   get_rand_bits_uints(buf,1,&ctx->bits);
+   popcount_bytes_lut(buf,letters,1,b5lut);
    if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-     printf("b5s[%u] = %u, index5 = %u\n",j,b5s[j],index5);
-     dumpbits(&j,8);
+     dumpbits(&buf[0],32);
    }
-   /* 4th byte */
-   /* Cruft:  See above. j = get_bit_ntuple_from_uint(i,8,0x000000FF,24); */
-   j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,24);
-   index5 = LSHIFT5(index5,b5s[j]);
-   if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-     printf("b5s[%u] = %u, index5 = %u\n",j,b5s[j],index5);
-     dumpbits(&j,8);
+   for(k=0;k<4;k++){
+     index5 = LSHIFT5(index5,letters[k]);
+     if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
+       printf("letter[%u] = %u, index5 = %u\n",k,letters[k],index5);
+     }
    }
- }
 
- boffset = 0;
- for(t=0;t<test[0]->tsamples;t++){
-
-   /*
-    * OK, we now have to do a simple modulus decision as to whether or not
-    * a new random uint is required AND to track the byte offset.  We also
-    * have to determine whether or not to use overlapping bytes.  I
-    * actually think that we may need to turn index5 into a subroutine
-    * where each successive call returns the next morphed index5,
-    * overlapping or not.
-    */
-   if(overlap){
-     /*
-      * Use overlapping bytes to generate the next index5 according to
-      * the diehard prescription (designed to work with a very small
-      * input file of rands).
-      */
-     if(boffset%32 == 0){
+   for(t=0;t<test[0]->tsamples;){
+     nw = (test[0]->tsamples - t + 3)/4;
+     if(nw > COUNT1S_BUF) nw = COUNT1S_BUF;
+     get_rand_bits_uints(buf,nw,&ctx->bits);
+     popcount_bytes_lut(buf,letters,nw,b5lut);
+     for(k=0;k<4*nw && t<test[0]->tsamples;k++,t++){
        /*
-        * We need a new rand to get our next byte.
+        * We use modulus to throw away the sixth digit in the left-shifted
+        * base 5 index value, keeping the value of the 5-digit base 5
+        * number in the range 0 to 5^5-1 or 0 to 3124 decimal.  We repeat
+        * for the four digit index.  At this point we increment the counts
+        * for index4 and index5.  Tres simple, no?
         */
-       boffset = 0;
-       i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
+       index5 = LSHIFT5(index5,letters[k]) % 3125;
+       index4 = index5%625;
        if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-         dumpbits(&i,32);
+         if(k%4 == 0) dumpbits(&buf[k/4],32);
+         printf("letter[%u] = %u, index5 = %u\n",k,letters[k],index5);
        }
+       vtest4.x[index4]++;
+       vtest5.x[index5]++;
      }
-     /*
-      * get next byte from the last rand we generated.
-      */
-     /* Cruft:  See above.  j = get_bit_ntuple_from_uint(i,8,0x000000FF,boffset); */
-     j = get_bit_ntuple_from_whole_uint(i,8,0x000000FF,boffset);
-     index5 = LSHIFT5(index5,b5s[j]);
-     /*
-      * I THINK that this basically throws away the sixth digit in the
-      * left-shifted base 5 value, keeping the value of the 5-digit base 5
-      * number in the range 0 to 5^5-1 or 0 to 3124 decimal.
-      */
-     index5 = index5%3125;
-     if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
-       printf("b5s[%u] = %u, index5 = %u\n",j,b5s[j],index5);
-       dumpbits(&j,8);
-     }
-     boffset+=8;
-   } else {
+   }
+
+   free(letters);
+   free(buf);
+ } else {
+   boffset = 0;
+   for(t=0;t<test[0]->tsamples;t++){
      /*
       * Get the next five bytes and make an index5 out of them, no
       * overlap.
@@ -354,10 +328,10 @@ int diehard_count_1s_stream(Test **test, unsigned int irun)
      for(k=0;k<5;k++){
        if(boffset%32 == 0){
          /*
-	  * We need a new rand to get our next byte.
-	  */
+          * We need a new rand to get our next byte.
+          */
          boffset = 0;
-         i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
+         i = get_rand_bits_uint(32, 0xFFFFFFFF, &ctx->bits);
          if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
            dumpbits(&i,32);
          }
@@ -374,18 +348,11 @@ int diehard_count_1s_stream(Test **test, unsigned int irun)
        }
        boffset+=8;
      }
+     index5 = index5%3125;
+     index4 = index5%625;
+     vtest4.x[index4]++;
+     vtest5.x[index5]++;
    }
-   /*
-    * We use modulus to throw away the sixth digit in the left-shifted
-    * base 5 index value, keeping the value of the 5-digit base 5 number
-    * in the range 0 to 5^5-1 or 0 to 3124 decimal.  We repeat for the
-    * four digit index.  At this point we increment the counts for index4
-    * and index5.  Tres simple, no?
-    */
-   index5 = index5%3125;
-   index4 = index5%625;
-   vtest4.x[index4]++;
-   vtest5.x[index5]++;
  }
  /*
   * OK, all that is left now is to figure out the statistic.
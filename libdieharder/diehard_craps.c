@@ -27,7 +27,7 @@
 
 #include <dieharder/libdieharder.h>
 
-uint roll(){
+uint roll(gsl_rng *rng){
   uint d = 1 + gsl_rng_uniform_int(rng,6);
   return d;
 }
@@ -40,6 +40,7 @@ int diehard_craps(Test **test, unsigned int irun)
  double sum,p;
  Xtest ptest;
  Vtest vtest;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * This is just for output display.
@@ -105,7 +106,7 @@ int diehard_craps(Test **test, unsigned int irun)
     * This is the point count we have to make, the sum of two rolled
     * dice.
     */
-   point = roll() + roll();
+   point = roll(ctx->rng) + roll(ctx->rng);
    tries = 0;
 
    if(point == 7 || point == 11) {
@@ -132,7 +133,7 @@ int diehard_craps(Test **test, unsigned int irun)
 	* then freezes it.
         */
        (tries<20)?tries++:tries;
-       throw = roll() + roll();
+       throw = roll(ctx->rng) + roll(ctx->rng);
        if(throw == 7){
          vtest.x[tries]++;
 	 break;
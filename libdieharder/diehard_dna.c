@@ -37,15 +37,15 @@
 
 #include <dieharder/libdieharder.h>
 #include "static_get_bits.c"
-static uint mask;
 
 int diehard_dna(Test **test, unsigned int irun)
 {
 
- uint i,j,k,l,m,n,o,p,q,r,t,boffset;
+ uint i,j,k,l,m,n,o,p,q,r,t,boffset,mask;
  uint i0,j0,k0,l0,m0,n0,o0,p0,q0,r0;
  Xtest ptest;
- char **********w;
+ Dbitset *w;
+ Dcontext *ctx = test[0]->ctx;
 
  MYDEBUG(D_DIEHARD_DNA){
    fprintf(stdout,"# diehard_dna(): Starting test.\n");
@@ -59,16 +59,16 @@ int diehard_dna(Test **test, unsigned int irun)
  /*
   * This is pointless, I think, but it shuts -Wall up and is harmless.
   */
- i0 = gsl_rng_get(rng);
- j0 = gsl_rng_get(rng);
- k0 = gsl_rng_get(rng);
- l0 = gsl_rng_get(rng);
- m0 = gsl_rng_get(rng);
- n0 = gsl_rng_get(rng);
- o0 = gsl_rng_get(rng);
- p0 = gsl_rng_get(rng);
- q0 = gsl_rng_get(rng);
- r0 = gsl_rng_get(rng);
+ i0 = gsl_rng_get(ctx->rng);
+ j0 = gsl_rng_get(ctx->rng);
+ k0 = gsl_rng_get(ctx->rng);
+ l0 = gsl_rng_get(ctx->rng);
+ m0 = gsl_rng_get(ctx->rng);
+ n0 = gsl_rng_get(ctx->rng);
+ o0 = gsl_rng_get(ctx->rng);
+ p0 = gsl_rng_get(ctx->rng);
+ q0 = gsl_rng_get(ctx->rng);
+ r0 = gsl_rng_get(ctx->rng);
  boffset = 0;
 
  /*
@@ -87,39 +87,11 @@ int diehard_dna(Test **test, unsigned int irun)
  /*
   * We now make tsamples measurements, as usual, to generate the missing
   * statistic.  Wow!  10 dimensions!  I don't think even my tensor()
-  * package will do that...;-)
+  * package will do that...;-)  So we don't try:  the ten letters are
+  * simply the ten 2-bit digits of a 20 bit index into a flat bitset
+  * of 4^10 "seen" bits.
   */
-
- w = (char **********)malloc(4*sizeof(char *********));
- for(i=0;i<4;i++){
-   w[i] = (char *********)malloc(4*sizeof(char ********));
-   for(j=0;j<4;j++){
-     w[i][j] = (char ********)malloc(4*sizeof(char *******));
-     for(k=0;k<4;k++){
-       w[i][j][k] = (char *******)malloc(4*sizeof(char******));
-       for(l=0;l<4;l++){
-         w[i][j][k][l] = (char ******)malloc(4*sizeof(char*****));
-         for(m=0;m<4;m++){
-           w[i][j][k][l][m] = (char *****)malloc(4*sizeof(char****));
-           for(n=0;n<4;n++){
-             w[i][j][k][l][m][n] = (char ****)malloc(4*sizeof(char***));
-             for(o=0;o<4;o++){
-               w[i][j][k][l][m][n][o] = (char ***)malloc(4*sizeof(char**));
-               for(p=0;p<4;p++){
-                 w[i][j][k][l][m][n][o][p] = (char **)malloc(4*sizeof(char*));
-                 for(q=0;q<4;q++){
-                   w[i][j][k][l][m][n][o][p][q] = (char *)malloc(4*sizeof(char));
-                   /* Zero the column */
-                   memset(w[i][j][k][l][m][n][o][p][q],0,4*sizeof(char));
-		 }
-	       }
-	     }
-	   }
-	 }
-       }
-     }
-   }
- }
+ w = bitset_create(1 << 20);
 
  /*
   * To minimize the number of rng calls, we use each j and k mod 32
@@ -127,7 +99,7 @@ int diehard_dna(Test **test, unsigned int irun)
   * periodic wraparound) to be used for the next iteration.  We
   * therefore have to "seed" the process with a random l
   */
- q = gsl_rng_get(rng);
+ q = gsl_rng_get(ctx->rng);
  /* mask = ((2 << 1)-1); */
  mask = 0x3;
  for(t=0;t<test[0]->tsamples;t++){
@@ -140,16 +112,16 @@ int diehard_dna(Test **test, unsigned int irun)
     * the tsamples loop at tsamples = 2^15...
     */
    if(t%32 == 0) {
-     i0 = gsl_rng_get(rng);
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
-     l0 = gsl_rng_get(rng);
-     m0 = gsl_rng_get(rng);
-     n0 = gsl_rng_get(rng);
-     o0 = gsl_rng_get(rng);
-     p0 = gsl_rng_get(rng);
-     q0 = gsl_rng_get(rng);
-     r0 = gsl_rng_get(rng);
+     i0 = gsl_rng_get(ctx->rng);
+     j0 = gsl_rng_get(ctx->rng);
+     k0 = gsl_rng_get(ctx->rng);
+     l0 = gsl_rng_get(ctx->rng);
+     m0 = gsl_rng_get(ctx->rng);
+     n0 = gsl_rng_get(ctx->rng);
+     o0 = gsl_rng_get(ctx->rng);
+     p0 = gsl_rng_get(ctx->rng);
+     q0 = gsl_rng_get(ctx->rng);
+     r0 = gsl_rng_get(ctx->rng);
      boffset = 0;
    }
    /*
@@ -166,38 +138,15 @@ int diehard_dna(Test **test, unsigned int irun)
    q = get_bit_ntuple_from_uint(q0,2,mask,boffset);
    r = get_bit_ntuple_from_uint(r0,2,mask,boffset);
    /* printf("%u:   %u  %u  %u  %u  %u\n",t,i,j,k,l,boffset); */
-   w[i][j][k][l][m][n][o][p][q][r]++;
+   bitset_set(w,(i << 18) | (j << 16) | (k << 14) | (l << 12) | (m << 10) |
+                (n << 8) | (o << 6) | (p << 4) | (q << 2) | r);
    boffset++;
  }
 
  /*
   * Now we count the holes, so to speak
   */
- ptest.x = 0;
- for(i=0;i<4;i++){
-   for(j=0;j<4;j++){
-     for(k=0;k<4;k++){
-       for(l=0;l<4;l++){
-         for(m=0;m<4;m++){
-           for(n=0;n<4;n++){
-             for(o=0;o<4;o++){
-               for(p=0;p<4;p++){
-                 for(q=0;q<4;q++){
-                   for(r=0;r<4;r++){
-                     if(w[i][j][k][l][m][n][o][p][q][r] == 0){
-                       ptest.x += 1.0;
-                       /* printf("ptest.x = %f  Hole: w[%u][%u][%u][%u] = %u\n",ptest.x,i,j,k,l,w[i][j][k][l]); */
-		     }
-		   }
-		 }
-	       }
-	     }
-	   }
-	 }
-       }
-     }
-   }
- }
+ ptest.x = bitset_missing(w);
  MYDEBUG(D_DIEHARD_DNA) {
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
  }
@@ -209,37 +158,7 @@ int diehard_dna(Test **test, unsigned int irun)
    printf("# diehard_dna(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
- /*
-  * Don't forget to free w when done, in reverse order
-  */
- for(i=0;i<4;i++){
-   for(j=0;j<4;j++){
-     for(k=0;k<4;k++){
-       for(l=0;l<4;l++){
-         for(m=0;m<4;m++){
-           for(n=0;n<4;n++){
-             for(o=0;o<4;o++){
-               for(p=0;p<4;p++){
-                 for(q=0;q<4;q++){
-                   free(w[i][j][k][l][m][n][o][p][q]);
-		 }
-		 free(w[i][j][k][l][m][n][o][p]);
-	       }
-               free(w[i][j][k][l][m][n][o]);
-	     }
-             free(w[i][j][k][l][m][n]);
-	   }
-           free(w[i][j][k][l][m]);
-	 }
-         free(w[i][j][k][l]);
-       }
-       free(w[i][j][k]);
-     }
-     free(w[i][j]);
-   }
-   free(w[i]);
- }
- free(w);
+ bitset_destroy(w);
 
  return(0);
 
@@ -57,15 +57,19 @@
  * process!  Thank you Ifni, Goddess of Luck and Numbers!  And anybody
  * who wants to tackle the remaining diehard "problem" tests, (sums in
  * particular) should feel free to play through...
+ *
+ * The pseudoinverse is built for Marsaglia's own numbering of the 120
+ * orderings, which is what kperm() computes.  It is a fixed relabeling
+ * of the lexicographic (Lehmer code) rank, so operm5_index() takes the
+ * faster perm_rank_order() route through a 120 entry table instead,
+ * falling back on kperm() only for the (rare) samples with ties, where
+ * kperm()'s tie breaking is path dependent.
  *========================================================================
  */
 
 
 #include <dieharder/libdieharder.h>
 
-static int tflag=0;
-static double tcount[120];
-
 /*
 * kperm computes the permutation number of a vector of five integers
 * passed to it.
@@ -121,6 +125,39 @@ int kperm(uint v[],uint voffset)
 
 }
 
+/*
+ * kperm(v,voffset) for samples without ties:  lehmer[] maps the rank of
+ * the sample's ordering to kperm()'s index for it.
+ */
+static inline uint operm5_index(uint v[],uint voffset,const uint *lehmer)
+{
+
+ uint i,j,c,ties,r;
+ int w[5];
+
+ /*
+  * kperm() compares the values as (signed) ints, so we do too.  This is
+  * perm_rank_order() unrolled on ints for k = 5.
+  */
+ for(i=0;i<5;i++){
+   w[i] = (int) v[(i+voffset)%5];
+ }
+ r = 0;
+ ties = 0;
+ for(i=0;i<5;i++){
+   c = 0;
+   for(j=i+1;j<5;j++){
+     c += (w[j] < w[i]);
+     ties += (w[j] == w[i]);
+   }
+   r = r*(5-i) + c;
+ }
+ if(ties) return(kperm(v,voffset));
+
+ return(lehmer[r]);
+
+}
+
 int diehard_operm5(Test **test, unsigned int irun)
 {
 
@@ -128,26 +165,35 @@ int diehard_operm5(Test **test, unsigned int irun)
  uint v[5];
  double count[120];
  double av,norm,x[120],chisq,ndof;
+ uint lehmer[120],perm[5];
+ double w[5];
+ Dcontext *ctx = test[0]->ctx;
+
+ /*
+  * Build the rank to kperm() index table by running kperm() on one
+  * sample of each ordering.
+  */
+ for(i=0;i<120;i++){
+   perm_unrank(i,5,perm);
+   for(j=0;j<5;j++) w[j] = perm[j];
+   lehmer[perm_rank_order(w,5,NULL)] = kperm(perm,0);
+ }
 
  /*
   * Zero count vector, was t(120) in diehard.f90.
   */
  for(i=0;i<120;i++) {
    count[i] = 0.0;
-   if(tflag == 0){
-     tcount[i] = 0.0;
-     tflag = 1;
-   }
  }
 
- if(overlap){
+ if(ctx->overlap){
    for(i=0;i<5;i++){
-     v[i] = gsl_rng_get(rng);
+     v[i] = gsl_rng_get(ctx->rng);
    }
    vind = 0;
  } else {
    for(i=0;i<5;i++){
-     v[i] = gsl_rng_get(rng);
+     v[i] = gsl_rng_get(ctx->rng);
    }
  }
 
@@ -160,25 +206,20 @@ int diehard_operm5(Test **test, unsigned int irun)
     * determine whether or not to refill the entire v vector or just
     * rotate bytes.
     */
-  if(overlap){
-    kp = kperm(v,vind);
+  if(ctx->overlap){
+    kp = operm5_index(v,vind,lehmer);
     count[kp] += 1;
-    v[vind] = gsl_rng_get(rng);
+    v[vind] = gsl_rng_get(ctx->rng);
     vind = (vind+1)%5;
   } else {
     for(i=0;i<5;i++){
-      v[i] = gsl_rng_get(rng);
+      v[i] = gsl_rng_get(ctx->rng);
     }
-    kp = kperm(v,0);
+    kp = operm5_index(v,0,lehmer);
     count[kp] += 1;
   }
  }
 
- for(i=0;i<120;i++){
-   tcount[i] += count[i];
-   /* printf("%u: %f\n",i,tcount[i]); */
- }
-
  chisq = 0.0;
  av = test[0]->tsamples/120.0;
  norm = test[0]->tsamples; // this belongs to the pseudoinverse
@@ -189,14 +230,14 @@ int diehard_operm5(Test **test, unsigned int irun)
   * equation C*P*C = C
   */
 	
- if(overlap==0){
+ if(ctx->overlap==0){
    norm = av;
  }
  for(i=0;i<120;i++){
    x[i] = count[i] - av;
  }
 
- if(overlap){
+ if(ctx->overlap){
    for(i=0;i<120;i++){
      for(j=0;j<120;j++){
        chisq = chisq + x[i]*pseudoInv[i][j]*x[j];
@@ -204,7 +245,7 @@ int diehard_operm5(Test **test, unsigned int irun)
    }
  }
 
- if(overlap==0){
+ if(ctx->overlap==0){
    for(i=0;i<120;i++){
      chisq = chisq + x[i]*x[i];
    }
@@ -228,12 +269,12 @@ int diehard_operm5(Test **test, unsigned int irun)
  chisq = fabs(chisq / norm);
 
  ndof = 96; /* the rank of the covariancematrix and the pseudoinverse */
- if(overlap == 0){
+ if(ctx->overlap == 0){
    ndof = 120-1;
  }
 
  MYDEBUG(D_DIEHARD_OPERM5){
-   printf("# diehard_operm5(): chisq[%u] = %10.5f\n",kspi,chisq);
+   printf("# diehard_operm5(): chisq[%u] = %10.5f\n",irun,chisq);
  }
 
  test[0]->pvalues[irun] = gsl_sf_gamma_inc_Q((double)(ndof)/2.0,chisq/2.0);
@@ -242,8 +283,6 @@ int diehard_operm5(Test **test, unsigned int irun)
    printf("# diehard_operm5(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
- kspi++;
-
  return(0);
 
 }
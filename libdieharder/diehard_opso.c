@@ -45,9 +45,11 @@ int diehard_opso(Test **test, unsigned int irun)
  uint j0=0,k0=0,j,k,t;
  Xtest ptest;
  /*
-  * Fixed test size for speed and as per diehard.
+  * Fixed test size for speed and as per diehard.  w is a 1024x1024
+  * bit matrix, one bit per two letter word.
   */
- char w[1024][1024];
+ Dbitset *w;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
@@ -77,10 +79,10 @@ int diehard_opso(Test **test, unsigned int irun)
  /*
   * We now make test[0]->tsamples measurements, as usual, to generate the
   * missing statistic.  The easiest way to proceed, I think, will
-  * be to generate a simple char matrix 1024x1024 in size and empty.
-  * Each pair of "letters" generated become indices, and a (char) 1
-  * is inserted there.  At the end we just loop the matrix and count
-  * the zeros.
+  * be to generate a simple bit matrix 1024x1024 in size and empty.
+  * Each pair of "letters" generated become indices, and a 1 bit
+  * is set there.  At the end we just count the zeros (by popcount,
+  * 64 at a time).
   *
   * Of course doing it THIS way it is pretty obvious that we could,
   * say, display the 2-color 1024x1024 bitmap this represented graphically.
@@ -93,7 +95,7 @@ int diehard_opso(Test **test, unsigned int irun)
   * I have some fairly serious doubts about this, though.
   */
 
- memset(w,0,sizeof(char)*1024*1024);
+ w = bitset_create(1024*1024);
 
  k = 0;
  for(t=0;t<test[0]->tsamples;t++){
@@ -106,8 +108,8 @@ int diehard_opso(Test **test, unsigned int irun)
     * the test[0]->tsamples loop at test[0]->tsamples = 2^15...
     */
    if(t%2 == 0) {
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
+     j0 = gsl_rng_get(ctx->rng);
+     k0 = gsl_rng_get(ctx->rng);
      j = j0 & 0x03ff;
      k = k0 & 0x03ff;
    } else {
@@ -118,21 +120,14 @@ int diehard_opso(Test **test, unsigned int irun)
     * Get two "letters" (indices into w)
     */
    /* printf("%u:   %u  %u  %u\n",t,j,k,boffset); */
-   w[j][k] = 1;
+   bitset_set(w,(j << 10) | k);
  }
  
  /*
   * Now we count the holes, so to speak
   */
- ptest.x = 0;
- for(j=0;j<1024;j++){
-   for(k=0;k<1024;k++){
-     if(w[j][k] == 0){
-       ptest.x += 1.0;
-       /* printf("ptest.x = %f  Hole: w[%u][%u] = %u\n",ptest.x,j,k,w[j][k]); */
-     }
-   }
- }
+ ptest.x = bitset_missing(w);
+ bitset_destroy(w);
  MYDEBUG(D_DIEHARD_OPSO) {
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
  }
@@ -39,7 +39,8 @@ int diehard_oqso(Test **test, unsigned int irun)
 
  uint i,j,k,l,i0=0,j0=0,k0=0,l0=0,t,boffset=0;
  Xtest ptest;
- char w[32][32][32][32];
+ Dbitset *w;              /* 32x32x32x32 bits, one per word */
+ Dcontext *ctx = test[0]->ctx;
 
 
  /*
@@ -73,7 +74,7 @@ int diehard_oqso(Test **test, unsigned int irun)
   * Programming.
   */
 
- memset(w,0,sizeof(char)*32*32*32*32);
+ w = bitset_create(32*32*32*32);
 
  /*
   * To minimize the number of rng calls, we use each j and k mod 32
@@ -83,10 +84,10 @@ int diehard_oqso(Test **test, unsigned int irun)
   */
  for(t=0;t<test[0]->tsamples;t++){
    if(t%6 == 0) {
-     i0 = gsl_rng_get(rng);
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
-     l0 = gsl_rng_get(rng);
+     i0 = gsl_rng_get(ctx->rng);
+     j0 = gsl_rng_get(ctx->rng);
+     k0 = gsl_rng_get(ctx->rng);
+     l0 = gsl_rng_get(ctx->rng);
      boffset = 0;
    }
    /*
@@ -97,7 +98,7 @@ int diehard_oqso(Test **test, unsigned int irun)
    k = (k0 >> boffset) & 0x01f;
    l = (l0 >> boffset) & 0x01f;
 
-   w[i][j][k][l]=1;
+   bitset_set(w,(i << 15) | (j << 10) | (k << 5) | l);
    boffset+=5;
 
  }
@@ -105,20 +106,8 @@ int diehard_oqso(Test **test, unsigned int irun)
  /*
   * Now we count the holes, so to speak
   */
- t = 0;
- for(i=0;i<32;i++){
-   for(j=0;j<32;j++){
-     for(k=0;k<32;k++){
-       for(l=0;l<32;l++){
-         if(w[i][j][k][l] == 0){
-           t++;
-           /* printf("ptest.x = %f  Hole: w[%u][%u][%u][%u] = %u\n",t,i,j,k,l,w[i][j][k][l]); */
-	 }
-       }
-     }
-   }
- }
- ptest.x = t;
+ ptest.x = bitset_missing(w);
+ bitset_destroy(w);
 
  MYDEBUG(D_DIEHARD_OQSO){
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
@@ -67,27 +67,54 @@
 
 #include <dieharder/libdieharder.h>
 
+/*
+ * The lot is LOT x LOT and we try to park ATTEMPTS helicopters in it.
+ * The crash test looks only at the 3x3 block of unit cells around the
+ * new arrival, as anything it can crash into (within 1.0 in both x and
+ * y) must be parked in one of them.  Two parked cars can never share a
+ * unit cell (they would have crashed), so each cell just holds the
+ * index of the car parked in it, or -1.  Crashes come out exactly as
+ * they did from the old scan of every parked car, in a time that grows
+ * with ATTEMPTS rather than ATTEMPTS^2.
+ */
+#define LOT 100
+#define ATTEMPTS 12000
+
 typedef struct {
   double x;
   double y;
 } Cars;
 
+/*
+ * A few of our generators can return exactly 1.0 from get_double, so
+ * x can be LOT.  It goes in the last cell, which is still next to
+ * everything it can crash into.
+ */
+static inline int lot_cell(double x)
+{
+ int c = (int) x;
+ return(c < LOT ? c : LOT - 1);
+}
+
 int diehard_parking_lot(Test **test, unsigned int irun)
 {
 
  /*
   * This is the most that could under any circumstances be parked.
   */
- Cars parked[12000];
- uint k,n,i,crashed;
+ Cars parked[ATTEMPTS];
+ int cell[LOT][LOT];
+ int cx,cy,i,j,c;
+ uint k,n,crashed;
  double xtry,ytry;
  Xtest ptest;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
   */
  test[0]->ntuple = 0;
- test[0]->tsamples = 12000;
+ test[0]->tsamples = ATTEMPTS;
 
  /*
   * ptest.x = (double) k
@@ -101,35 +128,41 @@ int diehard_parking_lot(Test **test, unsigned int irun)
  /*
   * Clear the parking lot the fast way.
   */
- memset(parked,0,12000*sizeof(Cars));
+ memset(parked,0,ATTEMPTS*sizeof(Cars));
+ memset(cell,0xff,sizeof(cell));
 
  /*
   * Park a single car to have something to avoid and count it.
   */
- parked[0].x = 100.0*gsl_rng_uniform(rng);
- parked[0].y = 100.0*gsl_rng_uniform(rng);
+ parked[0].x = (double) LOT*gsl_rng_uniform(ctx->rng);
+ parked[0].y = (double) LOT*gsl_rng_uniform(ctx->rng);
+ cell[lot_cell(parked[0].x)][lot_cell(parked[0].y)] = 0;
  k = 1;
  
 
  /*
   * This is now a really simple test.  Park them cars!  We try to park
-  * 12000 times, and increment k (the number successfully parked) on
-  * successes.  We brute force the crash test.
+  * ATTEMPTS times, and increment k (the number successfully parked) on
+  * successes.
   */
- for(n=1;n<12000;n++){
-   xtry = 100.0*gsl_rng_uniform(rng);
-   ytry = 100.0*gsl_rng_uniform(rng);
+ for(n=1;n<ATTEMPTS;n++){
+   xtry = (double) LOT*gsl_rng_uniform(ctx->rng);
+   ytry = (double) LOT*gsl_rng_uniform(ctx->rng);
+   cx = lot_cell(xtry);
+   cy = lot_cell(ytry);
    crashed = 0;
-   for(i=0;i<k;i++){
-     /*
-      * We do this REASONABLY efficiently.  As soon as we know we didn't
-      * crash we move on until we learn that we crashed, trying to skip
-      * arithmetic.  Once we've crashed, we break out of the loop.
-      * Uncrashed survivors join the parked list.
-      */
-     if( (fabs(parked[i].x - xtry) <= 1.0) && (fabs(parked[i].y - ytry) <= 1.0)){
-       crashed = 1;  /* We crashed! */
-       break;        /* So quit the loop here */
+   for(i=cx-1;i<=cx+1 && !crashed;i++){
+     if(i < 0 || i >= LOT) continue;
+     for(j=cy-1;j<=cy+1;j++){
+       if(j < 0 || j >= LOT || (c = cell[i][j]) < 0) continue;
+       /*
+        * Once we've crashed, we break out of the loop.  Uncrashed
+        * survivors join the parked list.
+        */
+       if( (fabs(parked[c].x - xtry) <= 1.0) && (fabs(parked[c].y - ytry) <= 1.0)){
+         crashed = 1;  /* We crashed! */
+         break;        /* So quit the loop here */
+       }
      }
    }
    /*
@@ -138,7 +171,7 @@ int diehard_parking_lot(Test **test, unsigned int irun)
    if(crashed == 0){
      parked[k].x = xtry;
      parked[k].y = ytry;
-     crashed = 0;
+     cell[cx][cy] = k;
      k++;
    }
  }
@@ -154,4 +187,3 @@ int diehard_parking_lot(Test **test, unsigned int irun)
  return(0);
 
 }
-
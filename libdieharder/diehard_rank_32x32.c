@@ -18,6 +18,21 @@
  * re test is performed on counts for ranks 31,30,29 and <=28.   ::
  *
  *                          Comments
+ *
+ * The matrices are generated and ranked RANK_BATCH at a time, with the
+ * word-parallel binary_rank32_batch().
+ *
+ * With -d 2 -n N for N > 32 this instead becomes an NxN rank test, counting
+ * ranks N, N-1, N-2 and <= N-3 against the exact probabilities for a
+ * random NxN matrix over GF(2):
+ *
+ *   P(rank = N-k) = 2^(-k^2) prod_{i=k+1}^{N} (1-2^-i)^2 / prod_{i=1}^{N-k} (1-2^-i)
+ *
+ * (which gives the 32x32 numbers below for N = 32).  Large matrices test
+ * for linear dependencies over a much longer stretch of the stream than
+ * 32 rands.  Each one costs N^3/64 word operations, so if tsamples isn't
+ * set on the command line it is RANK_NXN_TSAMPLES rather than 40000.
+ * Under -a(ll) -n is meant for the ntuple tests, so it is ignored here.
  * ========================================================================
  */
 
@@ -29,24 +44,31 @@
  */
 #include "static_get_bits.c"
 
+#define RANK_BATCH 1024
+#define RANK_NXN_TSAMPLES 1000
+
+static int diehard_rank_nxn(Test **test, unsigned int irun, unsigned int n);
+
 int diehard_rank_32x32(Test **test, unsigned int irun)
 {
 
- unsigned int i,t,rank;
- uint bitstring;
- /* uint mtx[32][1]; */
- uint **mtx;
+ unsigned int i,t,m,nmtx;
+ uint *mtx;
+ uint ranks[RANK_BATCH];
  Vtest vtest;
+ Dcontext *ctx = test[0]->ctx;
+
+ if(!ctx->all && ctx->ntuple > 32) return(diehard_rank_nxn(test,irun,ctx->ntuple));
 
  /*
   * for display only.  0 means "ignored".
   */
  test[0]->ntuple = 0;
 
- mtx=(uint **)malloc(32*sizeof(uint*));
- for(i=0;i<32;i++){
-   mtx[i] = (uint*)malloc(sizeof(uint));
- }
+ /*
+  * RANK_BATCH matrices of 32 one-word rows, back to back.
+  */
+ mtx = (uint *)malloc(RANK_BATCH*32*sizeof(uint));
 
  MYDEBUG(D_DIEHARD_RANK_32x32){
    fprintf(stdout,"# diehard_rank_32x32(): Starting test\n");
@@ -80,43 +102,120 @@ int diehard_rank_32x32(Test **test, unsigned int irun)
  vtest.x[32] = 0.0;
  vtest.y[32] = test[0]->tsamples*0.2887880952e+00;
 
- for(t=0;t<test[0]->tsamples;t++) {
+ for(t=0;t<test[0]->tsamples;t+=nmtx) {
 
+   nmtx = test[0]->tsamples - t;
+   if(nmtx > RANK_BATCH) nmtx = RANK_BATCH;
+   get_rand_bits_uints(mtx,nmtx*32,&ctx->bits);
    MYDEBUG(D_DIEHARD_RANK_32x32){
-     fprintf(stdout,"# diehard_rank_32x32(): Input random matrix = \n");
-   }
-
-   for(i=0;i<32;i++){
-     MYDEBUG(D_DIEHARD_RANK_32x32){
-       fprintf(stdout,"# ");
+     for(m=0;m<nmtx;m++){
+       fprintf(stdout,"# diehard_rank_32x32(): Input random matrix = \n");
+       for(i=0;i<32;i++){
+         fprintf(stdout,"# ");
+         dumpbits(&mtx[m*32+i],32);
+         fprintf(stdout,"\n");
+       }
      }
+   }
 
-     bitstring = get_rand_bits_uint(32,0xffffffff,rng);
-     mtx[i][0] = bitstring;
+   binary_rank32_batch(mtx,32,32,nmtx,ranks);
 
+   for(m=0;m<nmtx;m++){
      MYDEBUG(D_DIEHARD_RANK_32x32){
-       dumpbits(mtx[i],32);
-       fprintf(stdout,"\n");
+       fprintf(stdout,"# binary rank = %u\n",ranks[m]);
+     }
+     if(ranks[m] <= 29){
+       vtest.x[29]++;
+     } else {
+       vtest.x[ranks[m]]++;
      }
    }
+ }
+
+ /* for(i=0;i<33;i++) printf("vtest.x[%u] =  %f\n",i,vtest.x[i]); */
+
+ Vtest_eval(&vtest);
+ test[0]->pvalues[irun] = vtest.pvalue;
+ MYDEBUG(D_DIEHARD_RANK_32x32) {
+   printf("# diehard_rank_32x32(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
+ }
+
+ Vtest_destroy(&vtest);
+
+ free(mtx);
+
+ return(0);
+
+}
+
+/*
+ * The NxN version.  Bins 0,1,2,3 hold ranks <= N-3, N-2, N-1, N.
+ */
+static int diehard_rank_nxn(Test **test, unsigned int irun, unsigned int n)
+{
+
+ unsigned int i,k,w,t,rank,w32;
+ uint *buf;
+ double p,psum;
+ Dbitmatrix *mtx;
+ Vtest vtest;
+ Dcontext *ctx = test[0]->ctx;
+
+ /*
+  * for display, the matrix size.
+  */
+ test[0]->ntuple = n;
+ if(ctx->tsamples == 0) test[0]->tsamples = RANK_NXN_TSAMPLES;
+
+ MYDEBUG(D_DIEHARD_RANK_32x32){
+   fprintf(stdout,"# diehard_rank_32x32(): Starting %ux%u test\n",n,n);
+ }
+
+ mtx = bitmatrix_create(n,n);
+ w32 = (n + 31)/32;
+ buf = (uint *)malloc(n*w32*sizeof(uint));
+
+ Vtest_create(&vtest,4);
+ vtest.cutoff = 5.0;
+ psum = 0.0;
+ for(k=0;k<3;k++){
+   p = pow(2.0,-1.0*k*k);
+   for(i=k+1;i<=n;i++) p *= (1.0 - pow(2.0,-1.0*i))*(1.0 - pow(2.0,-1.0*i));
+   for(i=1;i<=n-k;i++) p /= (1.0 - pow(2.0,-1.0*i));
+   vtest.x[3-k] = 0.0;
+   vtest.y[3-k] = test[0]->tsamples*p;
+   psum += p;
+ }
+ vtest.x[0] = 0.0;
+ vtest.y[0] = test[0]->tsamples*(1.0 - psum);
+
+ for(t=0;t<test[0]->tsamples;t++) {
 
    /*
-    * This is a silly thing to quiet gcc complaints about twin puns.
+    * Each row is w32 rands, packed two to a 64 bit word.
     */
-   rank = binary_rank(mtx,32,32);
+   get_rand_bits_uints(buf,n*w32,&ctx->bits);
+   for(i=0;i<n;i++){
+     for(w=0;w<mtx->nwords;w++){
+       mtx->data[(size_t)i*mtx->nwords + w] = buf[i*w32 + 2*w];
+       if(2*w+1 < w32){
+         mtx->data[(size_t)i*mtx->nwords + w] |= (uint64_t)buf[i*w32 + 2*w+1] << 32;
+       }
+     }
+   }
+
+   rank = bitmatrix_rank(mtx);
    MYDEBUG(D_DIEHARD_RANK_32x32){
      fprintf(stdout,"# binary rank = %u\n",rank);
    }
 
-   if(rank <= 29){
-     vtest.x[29]++;
+   if(rank + 3 <= n){
+     vtest.x[0]++;
    } else {
-     vtest.x[rank]++;
+     vtest.x[rank + 3 - n]++;
    }
  }
 
- /* for(i=0;i<33;i++) printf("vtest.x[%u] =  %f\n",i,vtest.x[i]); */
-
  Vtest_eval(&vtest);
  test[0]->pvalues[irun] = vtest.pvalue;
  MYDEBUG(D_DIEHARD_RANK_32x32) {
@@ -124,13 +223,9 @@ int diehard_rank_32x32(Test **test, unsigned int irun)
  }
 
  Vtest_destroy(&vtest);
-
- for(i=0;i<32;i++){
-   free(mtx[i]);
- }
- free(mtx);
+ bitmatrix_destroy(mtx);
+ free(buf);
 
  return(0);
 
 }
-
@@ -20,6 +20,8 @@
  * random matrices, and a chi-square test is performed on        ::
  * counts for ranks 6,5 and <=4.                                 ::
  *
+ * The matrices are generated and ranked RANK_BATCH at a time, with the
+ * word-parallel binary_rank32_batch().
  * ===================================================================
  */
 
@@ -30,14 +32,17 @@
  */
 #include "static_get_bits.c"
 
+#define RANK_BATCH 4096
+
 int diehard_rank_6x8(Test **test, unsigned int irun)
 {
 
 
- unsigned int i,t,rank;
- uint bitstring;
- uint **mtx;
+ unsigned int i,t,m,nmtx;
+ uint *mtx;
+ uint ranks[RANK_BATCH];
  Vtest vtest;
+ Dcontext *ctx = test[0]->ctx;
 
  MYDEBUG(D_DIEHARD_RANK_6x8){
    fprintf(stdout,"# diehard_rank_6x8():  Starting test.\n");
@@ -48,10 +53,10 @@ int diehard_rank_6x8(Test **test, unsigned int irun)
   */
  test[0]->ntuple = 0;
 
- mtx = (uint **)malloc(6*sizeof(uint *));
- for(i=0;i<6;i++){
-   mtx[i] = (uint *)malloc(8*sizeof(uint));
- }
+ /*
+  * RANK_BATCH matrices of 6 one-word rows, back to back.
+  */
+ mtx = (uint *)malloc(RANK_BATCH*6*sizeof(uint));
 
  Vtest_create(&vtest,7);
  vtest.cutoff = 5.0;
@@ -70,39 +75,37 @@ int diehard_rank_6x8(Test **test, unsigned int irun)
  vtest.x[6] = 0.0;
  vtest.y[6] = test[0]->tsamples*0.773118E+00;
 
- for(t=0;t<test[0]->tsamples;t++){
+ for(t=0;t<test[0]->tsamples;t+=nmtx){
 
    /*
-    * We generate 6 random rmax_bits-bit integers and put a
-    * randomly chosen byte into the LEFTMOST byte position
-    * of the row/slot of mtx.
+    * We generate 6 random rmax_bits-bit integers per matrix, and
+    * rank the rightmost byte of each (the 6x8 matrix).
     */
+   nmtx = test[0]->tsamples - t;
+   if(nmtx > RANK_BATCH) nmtx = RANK_BATCH;
+   get_rand_bits_uints(mtx,nmtx*6,&ctx->bits);
    MYDEBUG(D_DIEHARD_RANK_6x8){
-     fprintf(stdout,"# diehard_rank_6x8(): Input random matrix = \n");
-   }
-   for(i=0;i<6;i++){
-     MYDEBUG(D_DIEHARD_RANK_6x8){
-       fprintf(stdout,"# ");
+     for(m=0;m<nmtx;m++){
+       fprintf(stdout,"# diehard_rank_6x8(): Input random matrix = \n");
+       for(i=0;i<6;i++){
+         fprintf(stdout,"# ");
+         dumpbits(&mtx[m*6+i],32);
+         fprintf(stdout,"\n");
+       }
      }
+   }
 
-     bitstring = get_rand_bits_uint(32,0xffffffff,rng);
-     mtx[i][0] = bitstring;
+   binary_rank32_batch(mtx,6,8,nmtx,ranks);
 
+   for(m=0;m<nmtx;m++){
      MYDEBUG(D_DIEHARD_RANK_6x8){
-       dumpbits(mtx[i],32);
-       fprintf(stdout,"\n");
+       printf("binary rank = %d\n",ranks[m]);
+     }
+     if(ranks[m] <= 2){
+       vtest.x[2]++;
+     } else {
+       vtest.x[ranks[m]]++;
      }
-   }
-
-   rank = binary_rank(mtx,6,8);
-   MYDEBUG(D_DIEHARD_RANK_6x8){
-     printf("binary rank = %d\n",rank);
-   }
-
-   if(rank <= 2){
-     vtest.x[2]++;
-   } else {
-     vtest.x[rank]++;
    }
  }
 
@@ -116,9 +119,6 @@ int diehard_rank_6x8(Test **test, unsigned int irun)
 
  Vtest_destroy(&vtest);
 
- for(i=0;i<6;i++){
-   free(mtx[i]);
- }
  free(mtx);
 
  return(0);
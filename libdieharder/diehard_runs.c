@@ -82,6 +82,7 @@ int diehard_runs(Test **test, unsigned int irun)
  int upruns[RUN_MAX],downruns[RUN_MAX];
  double uv,dv;
  uint first, last, next = 0;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * This is just for display.
@@ -106,9 +107,9 @@ int diehard_runs(Test **test, unsigned int irun)
  if(verbose){
    printf("j    rand    ucount  dcount\n");
  }
- first = last = gsl_rng_get(rng);
+ first = last = gsl_rng_get(ctx->rng);
  for(t=1;t<test[0]->tsamples;t++) {
-   next = gsl_rng_get(rng);
+   next = gsl_rng_get(ctx->rng);
    if(verbose){
 	 printf("%d:  %10u   %u    %u\n",t,next,ucount,dcount);
    }
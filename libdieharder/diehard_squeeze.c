@@ -56,6 +56,7 @@ int diehard_squeeze(Test **test, unsigned int irun)
 
  unsigned int i,j,k;
  Vtest vtest;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * Squeeze counts the iterations required to reduce 2^31 to
@@ -102,7 +103,7 @@ int diehard_squeeze(Test **test, unsigned int irun)
 
    /* printf("%u:   %d\n",j,k); */
    while((k != 1) && (j < 48)){
-     k = ceil(k*gsl_rng_uniform(rng));
+     k = ceil(k*gsl_rng_uniform(ctx->rng));
      j++;
      /* printf("%u:   %u\n",j,k); */
    }
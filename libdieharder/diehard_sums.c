@@ -56,6 +56,7 @@ int diehard_sums(Test **test, unsigned int irun)
  double *x,*y,*rand_list;
  double newrand;
  double a,b;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
@@ -177,7 +178,7 @@ int diehard_sums(Test **test, unsigned int irun)
    printf("# Initializing initial y[0] and rand_list\n");
  }
  for(t=0;t<m;t++){
-   rand_list[t] = gsl_rng_uniform(rng);
+   rand_list[t] = gsl_rng_uniform(ctx->rng);
    y[0] += rand_list[t];
    if(verbose == D_DIEHARD_SUMS || verbose == D_ALL){
      printf("y[0] =  y[0] + %f = %f\n",rand_list[t],y[0]);
@@ -194,7 +195,7 @@ int diehard_sums(Test **test, unsigned int irun)
     * Each successive sum is the previous one, with its first
     * entry in rand_list[] removed.
     */
-   newrand = gsl_rng_uniform(rng);
+   newrand = gsl_rng_uniform(ctx->rng);
    y[t] = y[t-1] - rand_list[t-1] + newrand;
    if(verbose == D_DIEHARD_SUMS || verbose == D_ALL){
      printf("y[%u] =  %f - %f + %f = %f (raw)\n",t,y[t-1],rand_list[t-1],newrand,y[t]);
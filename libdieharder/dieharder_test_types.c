@@ -182,6 +182,12 @@ void dieharder_test_types()
  ADD_TEST(&rgb_operm_dtest);
  dh_num_other_tests++;
 
+ /*
+  * Not counted:  -a reaches it through -b (see run_all_tests()), not
+  * by looping over dh_num_other_tests.
+  */
+ ADD_TEST(&rgb_bitdist_sweep_dtest);
+
  //ADD_TEST(&rgb_lmn_dtest);
  //dh_num_other_tests++;
 #endif
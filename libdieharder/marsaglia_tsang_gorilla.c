@@ -17,6 +17,7 @@ void marsaglia_tsang_gorilla(Test **test, unsigned int irun)
 
  uint t,i,lag;
  Xtest ptest;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * ptest.x = actual sum of test[0]->tsamples lagged samples from rng
@@ -32,8 +33,8 @@ void marsaglia_tsang_gorilla(Test **test, unsigned int irun)
   * We have to get the (float) value from the user input and set
   * a uint 
   */
- if(x_user){
-   lag = x_user;
+ if(ctx->x_user){
+   lag = ctx->x_user;
  } else {
    lag = 2; /* Why not?  Anything but 0, really... */
  }
@@ -49,10 +50,10 @@ void marsaglia_tsang_gorilla(Test **test, unsigned int irun)
     */
 
    /* Throw away lag-1 per sample */
-   for(i=0;i<(lag-1);i++) gsl_rng_uniform(rng);
+   for(i=0;i<(lag-1);i++) gsl_rng_uniform(ctx->rng);
 
    /* sample only every lag numbers, reset counter */
-   ptest.x += gsl_rng_uniform(rng);
+   ptest.x += gsl_rng_uniform(ctx->rng);
 
  }
 
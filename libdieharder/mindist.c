@@ -0,0 +1,216 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * min_distance2() returns the SQUARE of the smallest distance between
+ * any two of n points in a dim-dimensional cube of edge side.  It is
+ * the engine behind the minimum distance (sphere) tests.  If torus is
+ * nonzero the cube has periodic boundary conditions, so points near
+ * opposite faces are neighbors too.
+ *
+ * The points are passed in "structure of arrays" order:  coordinate d
+ * of point i is x[d*n + i].
+ *
+ * Rather than look at all (n^2-n)/2 pairs, we drop the points into a
+ * grid of about n cells (so about one point per cell) and compare each
+ * point only with the points in its own and the adjacent cells.  Any
+ * pair closer than half a cell edge is certain to be found that way
+ * (rounding in the cell index and all), and for n uniform points the
+ * minimum distance is far smaller than that.  If it ever isn't (tiny
+ * n, or a truly terrible generator that piles its points up somewhere)
+ * we just do all the pairs.
+ *
+ * The squared distance of a pair is accumulated a coordinate at a time
+ * in dimension order, so it comes out bit-for-bit the same as the
+ * straightforward loops it replaces.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+#define MINDIST_MAXDIM RGB_MINIMUM_DISTANCE_MAXDIM
+
+/*
+ * The distance kernel.  Returns the smallest squared distance (or best,
+ * if that is smaller) between point i and points j0..j1-1 of xs.  The
+ * points are contiguous within each coordinate array, so the compiler
+ * is free to vectorize the inner loop.  On a torus each coordinate
+ * difference is the shorter way around.
+ */
+static inline double mindist_kernel(const double *xs,unsigned int n,unsigned int dim,
+                                    double side,int torus,
+                                    unsigned int i,unsigned int j0,unsigned int j1,double best)
+{
+
+ unsigned int j,d;
+ double r2,dx;
+
+ for(j=j0;j<j1;j++){
+   r2 = 0.0;
+   for(d=0;d<dim;d++){
+     dx = xs[d*n + j] - xs[d*n + i];
+     if(torus){
+       dx = fabs(dx);
+       dx = (dx > 0.5*side) ? side - dx : dx;
+     }
+     r2 += dx*dx;
+   }
+   best = (r2 < best) ? r2 : best;
+ }
+
+ return(best);
+
+}
+
+/*
+ * All pairs, for the (rare) case where the grid can't be trusted.
+ */
+static double mindist_allpairs(const double *xs,unsigned int n,unsigned int dim,
+                               double side,int torus)
+{
+
+ unsigned int i;
+ double best = HUGE_VAL;
+
+ for(i=0;i+1<n;i++){
+   best = mindist_kernel(xs,n,dim,side,torus,i,i+1,n,best);
+ }
+
+ return(best);
+
+}
+
+double min_distance2(const double *x,unsigned int n,unsigned int dim,double side,int torus)
+{
+
+ unsigned int i,d,c,cn,m,ncells,n3,noff,p,o;
+ unsigned int *cell,*start,*next;
+ int off[MINDIST_MAXDIM*121],k[MINDIST_MAXDIM],kn,first;
+ double *xs,h,best;
+
+ /*
+  * The grid only goes up to MINDIST_MAXDIM dimensions; any other dim
+  * gets the (slow but correct) all pairs.
+  */
+ if(n < 2) return(HUGE_VAL);
+ if(dim < 1 || dim > MINDIST_MAXDIM) return(mindist_allpairs(x,n,dim,side,torus));
+
+ /*
+  * m cells on a side, m^dim ~ n.  The 0.5 guards against pow()
+  * coming out a hair under an exact integer root.
+  */
+ m = (unsigned int) floor(pow((double) n,1.0/dim) + 0.5);
+ if(m < 1) m = 1;
+
+ /*
+  * On a torus with fewer than three cells a side a cell would be its
+  * own neighbor (or the same neighbor twice), so just do all pairs.
+  */
+ if(torus && m < 3) return(mindist_allpairs(x,n,dim,side,torus));
+ for(ncells=1,d=0;d<dim;d++) ncells *= m;
+ h = side/m;
+
+ if(verbose == D_DIEHARD_2DSPHERE || verbose == D_DIEHARD_3DSPHERE ||
+    verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
+   printf("# min_distance2(): %u points in %u dimensions, %u^%u cells of side %f\n",
+          n,dim,m,dim,h);
+ }
+
+ /*
+  * Counting sort of the points by cell, copied into xs in cell order.
+  */
+ cell = (unsigned int *)malloc(n*sizeof(unsigned int));
+ start = (unsigned int *)calloc(ncells+1,sizeof(unsigned int));
+ next = (unsigned int *)malloc(ncells*sizeof(unsigned int));
+ xs = (double *)malloc(dim*n*sizeof(double));
+
+ for(i=0;i<n;i++){
+   c = 0;
+   for(d=0;d<dim;d++){
+     kn = (int)(x[d*n + i]/h);
+     if(kn < 0) kn = 0;
+     if(kn >= (int)m) kn = m-1;
+     c = c*m + kn;
+   }
+   cell[i] = c;
+   start[c+1]++;
+ }
+ for(c=0;c<ncells;c++){
+   start[c+1] += start[c];
+   next[c] = start[c];
+ }
+ for(i=0;i<n;i++){
+   p = next[cell[i]]++;
+   for(d=0;d<dim;d++) xs[d*n + p] = x[d*n + i];
+ }
+
+ /*
+  * The "forward" half of the neighboring cell offsets:  those whose
+  * first nonzero component is +1.  Each pair of adjacent cells is
+  * then visited exactly once.  o runs over {-1,0,1}^dim in base 3.
+  */
+ for(n3=1,d=0;d<dim;d++) n3 *= 3;
+ noff = 0;
+ for(o=0;o<n3;o++){
+   first = 0;
+   for(c=o,d=0;d<dim;d++,c/=3){
+     off[noff*dim + d] = (int)(c%3) - 1;
+     if(first == 0) first = off[noff*dim + d];
+   }
+   if(first == 1) noff++;
+ }
+
+ /*
+  * Sweep the cells, k[] holding the grid coordinates of cell c.
+  */
+ best = HUGE_VAL;
+ for(d=0;d<dim;d++) k[d] = 0;
+ for(c=0;c<ncells;c++){
+   if(start[c] != start[c+1]){
+     for(p=start[c];p<start[c+1];p++){
+       best = mindist_kernel(xs,n,dim,side,torus,p,p+1,start[c+1],best);
+     }
+     for(o=0;o<noff;o++){
+       cn = 0;
+       for(d=0;d<dim;d++){
+         kn = k[d] + off[o*dim + d];
+         if(torus){
+           if(kn < 0) kn += m;
+           if(kn >= (int)m) kn -= m;
+         } else if(kn < 0 || kn >= (int)m){
+           break;
+         }
+         cn = cn*m + kn;
+       }
+       if(d < dim || start[cn] == start[cn+1]) continue;
+       for(p=start[c];p<start[c+1];p++){
+         best = mindist_kernel(xs,n,dim,side,torus,p,start[cn],start[cn+1],best);
+       }
+     }
+   }
+   for(d=dim;d-- > 0;){
+     if(++k[d] < (int)m) break;
+     k[d] = 0;
+   }
+ }
+
+ if(best >= 0.25*h*h){
+   if(verbose == D_DIEHARD_2DSPHERE || verbose == D_DIEHARD_3DSPHERE ||
+      verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
+     printf("# min_distance2(): %f exceeds half the cell side, checking all pairs\n",sqrt(best));
+   }
+   best = mindist_allpairs(xs,n,dim,side,torus);
+ }
+
+ free(xs);
+ free(next);
+ free(start);
+ free(cell);
+
+ return(best);
+
+}
@@ -0,0 +1,106 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * Ranking and unranking permutations of 0..k-1 in the factorial number
+ * system (the Lehmer code), in O(k^2) with no table of all k! of them.
+ * The rank of a permutation is its place in lexicographic order, the
+ * same order gsl_permutation_next() steps through, so
+ *
+ *   perm_rank(p,k) = sum_i c_i (k-1-i)!,  c_i = #{j > i : p[j] < p[i]}
+ *
+ * perm_rank_order() ranks the order of a k-tuple of values directly,
+ * by comparing every pair of values once instead of sorting them.  The
+ * comparisons are independent of one another (a comparison network
+ * rather than a sort), so for small k the compiler is free to turn them
+ * into SIMD compares.
+ *
+ * Ranks fit in an unsigned int for k <= 12.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+unsigned int perm_rank(const unsigned int *perm, unsigned int k)
+{
+
+ unsigned int i,j,c,rank;
+
+ rank = 0;
+ for(i=0;i<k;i++){
+   c = 0;
+   for(j=i+1;j<k;j++){
+     c += (perm[j] < perm[i]);
+   }
+   rank = rank*(k-i) + c;
+ }
+
+ return(rank);
+
+}
+
+void perm_unrank(unsigned int rank, unsigned int k, unsigned int *perm)
+{
+
+ unsigned int i,j,c;
+ unsigned int digit[PERM_RANK_KMAX];
+ unsigned int used[PERM_RANK_KMAX];
+
+ /*
+  * Peel off the factorial digits, least significant (radix 1) first.
+  */
+ for(i=k;i-- > 0;){
+   digit[i] = rank % (k-i);
+   rank /= (k-i);
+   used[i] = 0;
+ }
+
+ /*
+  * perm[i] is the digit[i]'th smallest value not used yet.
+  */
+ for(i=0;i<k;i++){
+   c = digit[i];
+   for(j=0;j<k;j++){
+     if(used[j]) continue;
+     if(c == 0) break;
+     c--;
+   }
+   perm[i] = j;
+   used[j] = 1;
+ }
+
+}
+
+/*
+ * The rank of the ordering of v[0..k-1]:  the Lehmer code of the values
+ * themselves, c_i = #{j > i : v[j] < v[i]}, which is the Lehmer code of
+ * their ranks.  Equal values count as ordered by position; if ties is
+ * not NULL it returns the number of equal pairs so a caller that needs
+ * some other tie rule can spot them.  Note that this numbers orderings
+ * by the ranks of the values, not by the gsl_sort_index() permutation
+ * (its inverse) -- a different, but equally fixed, labeling.
+ */
+unsigned int perm_rank_order(const double *v, unsigned int k, unsigned int *ties)
+{
+
+ unsigned int i,j,c,neq,rank;
+
+ rank = 0;
+ neq = 0;
+ for(i=0;i<k;i++){
+   c = 0;
+   for(j=i+1;j<k;j++){
+     c += (v[j] < v[i]);
+     neq += (v[j] == v[i]);
+   }
+   rank = rank*(k-i) + c;
+ }
+ if(ties != NULL) *ties = neq;
+
+ return(rank);
+
+}
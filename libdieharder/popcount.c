@@ -0,0 +1,259 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * Population count kernels (see popcount.h).
+ *
+ * The AVX2 kernels are Mula's nibble lookup:  vpshufb looks up the bit
+ * count of the low and high nibble of 32 bytes at once from a 16 entry
+ * table, and vpsadbw sums the byte counts into 64 bit lanes.  The same
+ * byte counts, run through a second vpshufb, classify bytes for the
+ * count-the-1s tests.  With AVX-512 VPOPCNTDQ the hardware counts 64 bit
+ * lanes directly.  The kernels are compiled in if the compiler targets
+ * them and used if cpu_features says the CPU (and OS) can run them;
+ * otherwise everything drops through to the builtin popcount, which is
+ * the popcnt instruction wherever there is one.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+#include "cpu_features.h"
+
+/*
+ * The kernel to use:  the level cpu_features reports, down to one this
+ * build has kernels for.  The AVX-512 ones also need BW and VPOPCNTDQ;
+ * without them AVX2 does.
+ */
+static inline int popcount_kernel(void)
+{
+
+ int level = x86_simd_level();
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+ if(level == X86_SIMD_AVX512 && !x86_has_avx512_popcnt()) level = X86_SIMD_AVX2;
+#else
+ if(level == X86_SIMD_AVX512) level = X86_SIMD_AVX2;
+#endif
+#if !defined(__AVX2__)
+ if(level == X86_SIMD_AVX2) level = X86_SIMD_NONE;
+#endif
+ return(level);
+
+}
+
+static inline unsigned int popcount32(unsigned int x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+ return(__builtin_popcount(x));
+#else
+ x -= (x >> 1) & 0x55555555;
+ x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+ x = (x + (x >> 4)) & 0x0f0f0f0f;
+ return((x * 0x01010101) >> 24);
+#endif
+}
+
+#if defined(__AVX2__)
+/*
+ * Bit counts of the 32 bytes of v, and the same summed into 4 64 bit
+ * lanes.
+ */
+static inline __m256i popcount_avx2_bytes(__m256i v)
+{
+ const __m256i nib = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+                                      0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+ const __m256i low = _mm256_set1_epi8(0x0f);
+ __m256i lo = _mm256_and_si256(v,low);
+ __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v,4),low);
+ return(_mm256_add_epi8(_mm256_shuffle_epi8(nib,lo),_mm256_shuffle_epi8(nib,hi)));
+}
+
+static uint64_t popcount_u32_avx2(const unsigned int *buf, size_t n, size_t *done)
+{
+ __m256i acc = _mm256_setzero_si256();
+ uint64_t lanes[4];
+ size_t i;
+
+ for(i=0;i+8<=n;i+=8){
+   __m256i v = _mm256_loadu_si256((const __m256i *)(buf+i));
+   acc = _mm256_add_epi64(acc,_mm256_sad_epu8(popcount_avx2_bytes(v),_mm256_setzero_si256()));
+ }
+ _mm256_storeu_si256((__m256i *)lanes,acc);
+ *done = i;
+ return(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+/*
+ * Bit counts of 32 uints at a time:  the byte counts summed over each
+ * uint (vpmaddubsw, vpmaddwd), then packed down to bytes.  The packs
+ * work within 128 bit lanes, so a final vpermd puts them in order.
+ */
+static size_t popcount_u32_each_avx2(const unsigned int *buf, unsigned char *cnt, size_t n)
+{
+ const __m256i ones8 = _mm256_set1_epi8(1);
+ const __m256i ones16 = _mm256_set1_epi16(1);
+ const __m256i order = _mm256_setr_epi32(0,4,1,5,2,6,3,7);
+ __m256i c[4],ab,cd;
+ size_t i;
+ int k;
+
+ for(i=0;i+32<=n;i+=32){
+   for(k=0;k<4;k++){
+     __m256i v = _mm256_loadu_si256((const __m256i *)(buf+i+8*k));
+     c[k] = _mm256_madd_epi16(_mm256_maddubs_epi16(popcount_avx2_bytes(v),ones8),ones16);
+   }
+   ab = _mm256_packs_epi32(c[0],c[1]);
+   cd = _mm256_packs_epi32(c[2],c[3]);
+   _mm256_storeu_si256((__m256i *)(cnt+i),
+                       _mm256_permutevar8x32_epi32(_mm256_packus_epi16(ab,cd),order));
+ }
+ return(i);
+}
+
+static size_t popcount_bytes_lut_avx2(const unsigned int *buf, unsigned char *out, size_t n,
+                                      const unsigned char lut[16])
+{
+ __m128i l = _mm_loadu_si128((const __m128i *)lut);
+ __m256i cls = _mm256_broadcastsi128_si256(l);
+ size_t i;
+
+ for(i=0;i+8<=n;i+=8){
+   __m256i v = _mm256_loadu_si256((const __m256i *)(buf+i));
+   _mm256_storeu_si256((__m256i *)(out+4*i),_mm256_shuffle_epi8(cls,popcount_avx2_bytes(v)));
+ }
+ return(i);
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+static uint64_t popcount_u32_avx512(const unsigned int *buf, size_t n, size_t *done)
+{
+ __m512i acc = _mm512_setzero_si512();
+ size_t i;
+
+ for(i=0;i+16<=n;i+=16){
+   acc = _mm512_add_epi64(acc,_mm512_popcnt_epi64(_mm512_loadu_si512((const void *)(buf+i))));
+ }
+ *done = i;
+ return((uint64_t)_mm512_reduce_add_epi64(acc));
+}
+
+static size_t popcount_u32_each_avx512(const unsigned int *buf, unsigned char *cnt, size_t n)
+{
+ size_t i;
+
+ for(i=0;i+16<=n;i+=16){
+   __m512i c = _mm512_popcnt_epi32(_mm512_loadu_si512((const void *)(buf+i)));
+   _mm_storeu_si128((__m128i *)(cnt+i),_mm512_cvtepi32_epi8(c));
+ }
+ return(i);
+}
+
+static size_t popcount_bytes_lut_avx512(const unsigned int *buf, unsigned char *out, size_t n,
+                                        const unsigned char lut[16])
+{
+ const __m512i nib = _mm512_broadcast_i32x4(_mm_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4));
+ const __m512i low = _mm512_set1_epi8(0x0f);
+ __m512i cls = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)lut));
+ size_t i;
+
+ for(i=0;i+16<=n;i+=16){
+   __m512i v = _mm512_loadu_si512((const void *)(buf+i));
+   __m512i lo = _mm512_and_si512(v,low);
+   __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v,4),low);
+   __m512i c = _mm512_add_epi8(_mm512_shuffle_epi8(nib,lo),_mm512_shuffle_epi8(nib,hi));
+   _mm512_storeu_si512((void *)(out+4*i),_mm512_shuffle_epi8(cls,c));
+ }
+ return(i);
+}
+#endif
+
+uint64_t popcount_u32(const unsigned int *buf, size_t n)
+{
+
+ uint64_t total = 0;
+ size_t i = 0;
+
+ switch(popcount_kernel()){
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+   case X86_SIMD_AVX512:
+     total = popcount_u32_avx512(buf,n,&i);
+     break;
+#endif
+#if defined(__AVX2__)
+   case X86_SIMD_AVX2:
+     total = popcount_u32_avx2(buf,n,&i);
+     break;
+#endif
+   default:
+     break;
+ }
+ for(;i<n;i++){
+   total += popcount32(buf[i]);
+ }
+
+ return(total);
+
+}
+
+void popcount_u32_each(const unsigned int *buf, unsigned char *cnt, size_t n)
+{
+
+ size_t i = 0;
+
+ switch(popcount_kernel()){
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+   case X86_SIMD_AVX512:
+     i = popcount_u32_each_avx512(buf,cnt,n);
+     break;
+#endif
+#if defined(__AVX2__)
+   case X86_SIMD_AVX2:
+     i = popcount_u32_each_avx2(buf,cnt,n);
+     break;
+#endif
+   default:
+     break;
+ }
+ for(;i<n;i++){
+   cnt[i] = popcount32(buf[i]);
+ }
+
+}
+
+void popcount_bytes_lut(const unsigned int *buf, unsigned char *out, size_t n,
+                        const unsigned char lut[16])
+{
+
+ size_t i = 0;
+ unsigned int k;
+
+ /*
+  * The vector kernels take the bytes in memory order, which is least
+  * significant first on x86 (the only place they are built).
+  */
+ switch(popcount_kernel()){
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+   case X86_SIMD_AVX512:
+     i = popcount_bytes_lut_avx512(buf,out,n,lut);
+     break;
+#endif
+#if defined(__AVX2__)
+   case X86_SIMD_AVX2:
+     i = popcount_bytes_lut_avx2(buf,out,n,lut);
+     break;
+#endif
+   default:
+     break;
+ }
+ for(;i<n;i++){
+   for(k=0;k<4;k++){
+     out[4*i+k] = lut[popcount32((buf[i] >> (8*k)) & 0xff)];
+   }
+ }
+
+}
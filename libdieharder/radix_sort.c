@@ -0,0 +1,80 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * radix_sort_uint() sorts n unsigned ints into ascending order, exactly
+ * as gsl_sort_uint(data,1,n) would, with an LSD radix sort on 8 bit
+ * digits.  The caller passes in scratch space for n more unsigned ints
+ * so a test that sorts over and over can allocate it just once.
+ *
+ * All four digit histograms are counted in a single pass over the data,
+ * and a digit that is the same in every key (the top byte of a 24 bit
+ * birthday, say) is skipped outright, so the cost is at most five
+ * linear passes however the keys are distributed.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX_SIZE - 1)
+#define RADIX_PASSES (32/RADIX_BITS)
+
+void radix_sort_uint(unsigned int *data, unsigned int *scratch, size_t n)
+{
+
+ size_t count[RADIX_PASSES][RADIX_SIZE];
+ size_t i,sum,c;
+ unsigned int *src,*dst,*tmp,key;
+ unsigned int pass,shift,b;
+
+ if(n < 2) return;
+
+ memset(count,0,sizeof(count));
+ for(i=0;i<n;i++){
+   key = data[i];
+   for(pass=0;pass<RADIX_PASSES;pass++){
+     count[pass][(key >> (pass*RADIX_BITS)) & RADIX_MASK]++;
+   }
+ }
+
+ src = data;
+ dst = scratch;
+ for(pass=0;pass<RADIX_PASSES;pass++){
+   shift = pass*RADIX_BITS;
+
+   /*
+    * Every key has the same digit here, so this pass would leave the
+    * order as it is.
+    */
+   if(count[pass][(src[0] >> shift) & RADIX_MASK] == n) continue;
+
+   /*
+    * Turn the counts into starting offsets and scatter.
+    */
+   sum = 0;
+   for(b=0;b<RADIX_SIZE;b++){
+     c = count[pass][b];
+     count[pass][b] = sum;
+     sum += c;
+   }
+   for(i=0;i<n;i++){
+     key = src[i];
+     dst[count[pass][(key >> shift) & RADIX_MASK]++] = key;
+   }
+   tmp = src;
+   src = dst;
+   dst = tmp;
+ }
+
+ /*
+  * An odd number of passes leaves the result in scratch.
+  */
+ if(src != data) memcpy(data,src,n*sizeof(unsigned int));
+
+}
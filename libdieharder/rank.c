@@ -198,3 +198,140 @@ int binary_rank(uint **mtx,int mrows,int ncols)
  return(i);
 
 }
+
+/*
+ *========================================================================
+ * The word-parallel rank kernels (see Dbitmatrix.h).
+ *
+ * Rather than hunt down each column for a pivot we take the rows in
+ * order.  A row that is still nonzero when we get to it is a pivot,
+ * and its lowest set bit is its pivot column:  we clear that bit from
+ * every later row by xoring in the whole pivot row, a word at a time
+ * and without a branch.  Pivot columns are all different, so a row
+ * that comes out zero was a combination of the pivot rows before it.
+ * The rank is the number of pivots.
+ *========================================================================
+ */
+unsigned int binary_rank32(unsigned int *rows, unsigned int mrows, unsigned int ncols)
+{
+
+ unsigned int i,k,rank;
+ unsigned int colmask,x,low;
+
+ colmask = (ncols >= 32) ? 0xffffffff : (1u << ncols) - 1;
+ rank = 0;
+ for(i = 0;i < mrows && rank < ncols;i++){
+   x = rows[i] & colmask;
+   if(x == 0) continue;
+   rank++;
+   low = x & (~x + 1);
+   for(k = i+1;k < mrows;k++){
+     rows[k] ^= x & (0u - ((rows[k] & low) != 0));
+   }
+ }
+
+ return(rank);
+
+}
+
+unsigned int binary_rank64(uint64_t *rows, unsigned int mrows, unsigned int ncols)
+{
+
+ unsigned int i,k,rank;
+ uint64_t colmask,x,low;
+
+ colmask = (ncols >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << ncols) - 1;
+ rank = 0;
+ for(i = 0;i < mrows && rank < ncols;i++){
+   x = rows[i] & colmask;
+   if(x == 0) continue;
+   rank++;
+   low = x & (~x + 1);
+   for(k = i+1;k < mrows;k++){
+     rows[k] ^= x & ((uint64_t)0 - ((rows[k] & low) != 0));
+   }
+ }
+
+ return(rank);
+
+}
+
+/*
+ * nmtx mrows x ncols matrices, one after another in rows, ranked into
+ * ranks[].
+ */
+void binary_rank32_batch(unsigned int *rows, unsigned int mrows, unsigned int ncols,
+                         unsigned int nmtx, unsigned int *ranks)
+{
+
+ unsigned int m;
+
+ for(m = 0;m < nmtx;m++){
+   ranks[m] = binary_rank32(rows + m*mrows,mrows,ncols);
+ }
+
+}
+
+Dbitmatrix *bitmatrix_create(unsigned int nrows, unsigned int ncols)
+{
+
+ Dbitmatrix *m;
+
+ m = (Dbitmatrix *)malloc(sizeof(Dbitmatrix));
+ m->nrows = nrows;
+ m->ncols = ncols;
+ m->nwords = (ncols + 63)/64;
+ m->data = (uint64_t *)calloc((size_t)nrows*m->nwords,sizeof(uint64_t));
+ return(m);
+
+}
+
+void bitmatrix_destroy(Dbitmatrix *m)
+{
+
+ if(m == NULL) return;
+ free(m->data);
+ free(m);
+
+}
+
+/*
+ * The same elimination on multiword rows.  The pivot row is zero in
+ * the words before its pivot word, so only the words from there on
+ * need to be xored (masked rather than branched on, which the compiler
+ * can vectorize and the branch predictor can't get wrong).
+ */
+unsigned int bitmatrix_rank(Dbitmatrix *m)
+{
+
+ unsigned int i,k,w,v,nw,rank;
+ uint64_t lastmask,low,mask,*p,*q;
+
+ nw = m->nwords;
+ if(nw == 0) return(0);
+ lastmask = (m->ncols % 64) ? ((uint64_t)1 << (m->ncols % 64)) - 1 : ~(uint64_t)0;
+ for(i = 0;i < m->nrows;i++) m->data[(size_t)i*nw + nw-1] &= lastmask;
+
+ if(nw == 1) return(binary_rank64(m->data,m->nrows,m->ncols));
+
+ rank = 0;
+ for(i = 0;i < m->nrows && rank < m->ncols;i++){
+   p = m->data + (size_t)i*nw;
+   for(w = 0;w < nw && p[w] == 0;w++);
+   if(w == nw) continue;
+   rank++;
+   low = p[w] & (~p[w] + 1);
+   for(k = i+1;k < m->nrows;k++){
+     q = m->data + (size_t)k*nw;
+     mask = (uint64_t)0 - ((q[w] & low) != 0);
+     for(v = w;v < nw;v++) q[v] ^= p[v] & mask;
+   }
+ }
+
+ MYDEBUG(D_BRANK){
+   printf("# bitmatrix_rank(): %ux%u matrix has rank %u\n",m->nrows,m->ncols,rank);
+ }
+
+ return(rank);
+
+}
@@ -60,33 +60,186 @@
 
 #include "static_get_bits.c"
 
+/*
+ * Samples per buffer in rgb_bitdist_sweep()
+ */
+#define RGB_BITDIST_SWEEP_BUF 256
+
+/*
+ * The pieces of the test common to rgb_bitdist() and rgb_bitdist_sweep().
+ *
+ * rgb_bitdist_vtest_create() sets up the value_max binomial histograms,
+ * one per ntuple value, for tsamples samples of bsamples ntuples each.
+ */
+static void rgb_bitdist_vtest_create(Vtest *vtest, uint value_max, uint bsamples, uint tsamples)
+{
+
+ uint i,b;
+ double ntuple_prob,pbin;
+
+ ntuple_prob = 1.0/(double)value_max;
+ for(i=0;i<value_max;i++){
+   Vtest_create(&vtest[i],bsamples+1);
+   /*
+    * We will experiment a bit with a cutoff that cleans up our degree of
+    * freedom problem.
+    */
+   vtest[i].cutoff = 20.0;
+   for(b=0;b<=bsamples;b++){
+     if(i==0){
+       pbin = gsl_ran_binomial_pdf(b,ntuple_prob,bsamples);
+       vtest[i].x[b] = 0.0;
+       vtest[i].y[b] = tsamples*pbin;
+     } else {
+       vtest[i].x[b] = 0.0;
+       vtest[i].y[b] = vtest[0].y[b];
+     }
+     MYDEBUG(D_RGB_BITDIST){
+       printf("# rgb_bitdist():  %3u     %3u   %10.5f  %10.5f\n",
+         i,b,vtest[i].x[b],vtest[i].y[b]);
+     }
+     vtest[i].x[0] = tsamples;
+   }
+   MYDEBUG(D_RGB_BITDIST){
+     printf("# rgb_bitdist():=====================================================\n");
+   }
+ }
+
+}
+
+/*
+ * rgb_bitdist_tally() adds one sample's counts of each ntuple value to
+ * the CUMULATIVE histograms, clears count for the next sample and
+ * returns the total count.  Only the (at most n) values that actually
+ * turned up in the sample, listed in value[], can have a count, so we
+ * visit those instead of all value_max of them.
+ */
+static uint rgb_bitdist_tally(Vtest *vtest, uint *count, const uint *value, uint n)
+{
+
+ uint b,v,c,ctotal;
+
+ ctotal = 0;
+ for(b=0;b<n;b++){
+   v = value[b];
+   c = count[v];
+   if(c){
+     count[v] = 0;
+     ctotal += c;
+     vtest[v].x[c]++;
+     vtest[v].x[0]--;
+     MYDEBUG(D_RGB_BITDIST){
+       printf("# rgb_bitdist(): vtest[%u].x[%u] = %u\n",v,c,(uint)vtest[v].x[c]);
+     }
+   }
+ }
+
+ return(ctotal);
+
+}
+
+/*
+ * rgb_bitdist_score() evaluates the histograms, saves the pvalue of a
+ * randomly selected one in test[k]->pvalues[irun] and destroys them.
+ */
+static void rgb_bitdist_score(Test **test, uint k, uint irun, Vtest *vtest,
+                              uint value_max, uint bsamples, gsl_rng *rng)
+{
+
+ uint i,b,ri;
+
+ ri = gsl_rng_uniform_int(rng,value_max);
+ for(i=0;i<value_max;i++){
+   for(b=0;b<=bsamples;b++){
+     MYDEBUG(D_RGB_BITDIST){
+       printf("# rgb_bitdist():  %3u     %3u   %10.5f  %10.5f\n",
+         i,b,vtest[i].x[b],vtest[i].y[b]);
+     }
+   }
+   MYDEBUG(D_RGB_BITDIST){
+     printf("# rgb_bitdist():=====================================================\n");
+   }
+   Vtest_eval(&vtest[i]);
+
+   /*
+    * NOTE NOTE NOTE
+    *
+    * This is a bit nasty.  We can only save ONE pvalue per call.  The
+    * only way to do so without bias is to randomly select which one to
+    * save from large set of possibilities.
+    *
+    * However, this sucks.  Eventually I need to figure out how to
+    * turn the whole list of pvalues into a pvalue.  They are NOT
+    * independent though, so this is too difficult to deal with just
+    * now.  Randomly sampling might miss one particular byte pattern
+    * with a consistently bad pvalue unless/until the number of psamples
+    * is high enough to resolve these deviations, but this seems
+    * relatively "unlikely" -- deviations in the expected binomial bit
+    * pattern distribution will usually be systematic.
+    */
+   if(i == ri ) {
+     test[k]->pvalues[irun] = vtest[i].pvalue;
+     MYDEBUG(D_RGB_BITDIST) {
+       printf("# rgb_bitdist(): test[%u]->pvalues[%u] = %10.5f\n",
+          k,irun,test[k]->pvalues[irun]);
+     }
+   }
+   Vtest_destroy(&vtest[i]);
+ }
+
+}
+
+/*
+ * The sliding window extractor.  Puts the first n nb bit ntuples of
+ * the bitstream in buf (read left to right, the order get_rand_bits_uint()
+ * delivers them) in value[].  Each ntuple is cut out of the 64 bit window
+ * on the two words it starts in with a pair of shifts, with no branches
+ * and no dependence between one ntuple and the next, so the loop
+ * vectorizes.  It may read (but never uses) the word after the last one
+ * it needs, so buf must have one to spare.
+ */
+static inline void rgb_bitdist_windows(const uint *buf, uint nb, uint n, uint *value)
+{
+
+ uint j,p;
+ uint64_t w;
+
+ for(j=0;j<n;j++){
+   p = j*nb;
+   w = ((uint64_t) buf[p/32] << 32) | buf[p/32 + 1];
+   value[j] = (uint)((w << (p%32)) >> (64 - nb));
+ }
+
+}
+
 int rgb_bitdist(Test **test, unsigned int irun)
 {
 
  uint nb;          /* number of bits in a tested ntuple */
  uint value_max;   /* 2^{nb}, basically (max size of nb bit word + 1) */
  uint bsamples;    /* The number of non-overlapping samples in buffer */
- uint value;       /* value of sampled ntuple (as a uint) */
+ uint value[64];   /* values of the sampled ntuples (as uints) */
  uint mask;
+ Dcontext *ctx = test[0]->ctx;
 
  /* Look for cruft below */
 
  uint b,t,i;   /* loop indices? */
- uint ri;
+ uint tsamples;
  uint *count,ctotal; /* count of any ntuple per bitstring */
 
- double ntuple_prob,pbin;  /* probabilities */
+ double ntuple_prob;  /* probabilities */
  Vtest *vtest;               /* A reusable vector of binomial test bins */
 
  /*
   * Sample a bitstring ntuple in length (exactly).
   */
- if(ntuple>0){
+ if(ctx->ntuple>0){
    /*
     * Set test[0]->ntuple to pass back to output()
     */
-   test[0]->ntuple = ntuple;
-   nb = ntuple;
+   test[0]->ntuple = ctx->ntuple;
+   nb = ctx->ntuple;
    MYDEBUG(D_RGB_BITDIST){
      printf("# rgb_bitdist: Testing ntuple = %u\n",nb);
    }
@@ -190,32 +343,7 @@ int rgb_bitdist(Test **test, unsigned int irun)
   * easy to do several ways.
   */
 
- for(i=0;i<value_max;i++){
-   Vtest_create(&vtest[i],bsamples+1);
-   /*
-    * We will experiment a bit with a cutoff that cleans up our degree of
-    * freedom problem.
-    */
-   vtest[i].cutoff = 20.0;
-   for(b=0;b<=bsamples;b++){
-     if(i==0){
-       pbin = gsl_ran_binomial_pdf(b,ntuple_prob,bsamples);
-       vtest[i].x[b] = 0.0;
-       vtest[i].y[b] = tsamples*pbin;
-     } else {
-       vtest[i].x[b] = 0.0;
-       vtest[i].y[b] = vtest[0].y[b];
-     }
-     MYDEBUG(D_RGB_BITDIST){
-       printf("# rgb_bitdist():  %3u     %3u   %10.5f  %10.5f\n",
-         i,b,vtest[i].x[b],vtest[i].y[b]);
-     }
-     vtest[i].x[0] = tsamples;
-   }
-   MYDEBUG(D_RGB_BITDIST){
-     printf("# rgb_bitdist():=====================================================\n");
-   }
- }
+ rgb_bitdist_vtest_create(vtest,value_max,bsamples,tsamples);
 
  /*
   * Now (per ntuple) we check tsamples bitstrings of bits in length,
@@ -238,11 +366,11 @@ int rgb_bitdist(Test **test, unsigned int irun)
       * skipping bits.  Then increment the count of this ntuple value's
       * occurrence out of bsamples tries.
       */
-     value = get_rand_bits_uint (nb, mask, rng);
-     count[value]++;
+     value[b] = get_rand_bits_uint (nb, mask, &ctx->bits);
+     count[value[b]]++;
 
      MYDEBUG(D_RGB_BITDIST) {
-       printf("# rgb_bitdist():b=%u count[%u] = %u\n",b,value,count[value]);
+       printf("# rgb_bitdist():b=%u count[%u] = %u\n",b,value[b],count[value[b]]);
      }
 
    }
@@ -251,20 +379,7 @@ int rgb_bitdist(Test **test, unsigned int irun)
     * We now increment the CUMULATIVE counter -- vtest -- so we can
     * compare the result to the expected value when we're done.
     */
-   ctotal = 0;
-   for(i=0;i<value_max;i++){
-      uint count_i = count[i];
-      if (count_i)
-	{
-	   count[i] = 0;		       /* performs memset */
-	   ctotal += count_i;
-	   vtest[i].x[count_i]++;
-	   vtest[i].x[0]--;
-	}
-      MYDEBUG(D_RGB_BITDIST){
-	 printf("# rgb_bitdist(): vtest[%u].x[%u] = %u\n",i,count[i],(uint)vtest[i].x[count[i]]);
-     }
-   }
+   ctotal = rgb_bitdist_tally(vtest,count,value,bsamples);
    MYDEBUG(D_RGB_BITDIST){
      printf("# rgb_bitdist(): Sample %u: total count = %u (should be %u, count of bits)\n",t,ctotal,bits);
    }
@@ -283,49 +398,77 @@ int rgb_bitdist(Test **test, unsigned int irun)
    printf("# rgb_bitdist():            vtest table\n");
    printf("# rgb_bitdist(): Outcome   bit          x           y       sigma\n");
  }
- ri = gsl_rng_uniform_int(rng,value_max);
- for(i=0;i<value_max;i++){
-   for(b=0;b<=bsamples;b++){
-     MYDEBUG(D_RGB_BITDIST){
-       printf("# rgb_bitdist():  %3u     %3u   %10.5f  %10.5f\n",
-         i,b,vtest[i].x[b],vtest[i].y[b]);
-     }
-   }
-   MYDEBUG(D_RGB_BITDIST){
-     printf("# rgb_bitdist():=====================================================\n");
-   }
-   Vtest_eval(&vtest[i]);
+ rgb_bitdist_score(test,0,irun,vtest,value_max,bsamples,ctx->rng);
 
-   /*
-    * NOTE NOTE NOTE
-    *
-    * This is a bit nasty.  We can only save ONE pvalue per call.  The
-    * only way to do so without bias is to randomly select which one to
-    * save from large set of possibilities.
-    *
-    * However, this sucks.  Eventually I need to figure out how to
-    * turn the whole list of pvalues into a pvalue.  They are NOT
-    * independent though, so this is too difficult to deal with just
-    * now.  Randomly sampling might miss one particular byte pattern
-    * with a consistently bad pvalue unless/until the number of psamples
-    * is high enough to resolve these deviations, but this seems
-    * relatively "unlikely" -- deviations in the expected binomial bit
-    * pattern distribution will usually be systematic.
-    */
-   if(i == ri ) {
-     test[0]->pvalues[irun] = vtest[i].pvalue;
-     MYDEBUG(D_RGB_BITDIST) {
-       printf("# rgb_bitdist(): test[%u]->pvalues[%u] = %10.5f\n",
-          0,irun,test[0]->pvalues[irun]);
+ free(count);
+ free(vtest);
+ 
+ return(0);
+
+}
+
+/*
+ * rgb_bitdist_sweep() is the whole ntuple = 1 to RGB_BITDIST_NMAX series
+ * of rgb_bitdist() in a single pass, test[nb-1] holding the results for
+ * ntuple nb.  For each sample we draw the 2*RGB_BITDIST_NMAX uints the
+ * widest ntuple needs (bsamples = 64 ntuples of nb bits is always exactly
+ * 2*nb uints) and every ntuple is histogrammed from the front of that same
+ * block, rather than regenerating the stream once per ntuple.  The rands
+ * are drawn a buffer of samples at a time.  The ntuples at different
+ * widths are cut out of the same bits, so their pvalues are not
+ * independent of one another -- but neither were those of the separate
+ * runs in the way -a averages them.
+ */
+int rgb_bitdist_sweep(Test **test, unsigned int irun)
+{
+
+ uint nb,value_max,bsamples,tsamples,nwords;
+ uint b,t,n,nt;
+ uint *buf,*w,*count;
+ uint value[64];
+ Vtest *vtest[RGB_BITDIST_NMAX];
+ Dcontext *ctx = test[0]->ctx;
+
+ bsamples = 64;
+ tsamples = test[0]->tsamples;
+ nwords = 2*RGB_BITDIST_NMAX;
+
+ for(nb=1;nb<=RGB_BITDIST_NMAX;nb++){
+   test[nb-1]->ntuple = nb;
+   value_max = 1u << nb;
+   vtest[nb-1] = (Vtest *)malloc(value_max*sizeof(Vtest));
+   rgb_bitdist_vtest_create(vtest[nb-1],value_max,bsamples,tsamples);
+ }
+ count = (uint *)calloc(1u << RGB_BITDIST_NMAX,sizeof(uint));
+
+ /*
+  * One uint to spare at the end for rgb_bitdist_windows().
+  */
+ buf = (uint *)malloc((RGB_BITDIST_SWEEP_BUF*nwords + 1)*sizeof(uint));
+ for(t=0;t<tsamples;){
+   nt = tsamples - t;
+   if(nt > RGB_BITDIST_SWEEP_BUF) nt = RGB_BITDIST_SWEEP_BUF;
+   get_rand_bits_uints(buf,nt*nwords,&ctx->bits);
+   buf[nt*nwords] = 0;
+   for(n=0;n<nt;n++,t++){
+     w = buf + n*nwords;
+     for(nb=1;nb<=RGB_BITDIST_NMAX;nb++){
+       rgb_bitdist_windows(w,nb,bsamples,value);
+       for(b=0;b<bsamples;b++){
+         count[value[b]]++;
+       }
+       rgb_bitdist_tally(vtest[nb-1],count,value,bsamples);
      }
    }
-   Vtest_destroy(&vtest[i]);
  }
+ free(buf);
 
+ for(nb=1;nb<=RGB_BITDIST_NMAX;nb++){
+   rgb_bitdist_score(test,nb-1,irun,vtest[nb-1],1u << nb,bsamples,ctx->rng);
+   free(vtest[nb-1]);
+ }
  free(count);
- free(vtest);
- 
+
  return(0);
 
 }
-
@@ -40,14 +40,15 @@
 int rgb_lagged_sums(Test **test, unsigned int irun)
 {
 
- uint t,i,lag;
+ uint t,lag;
  Xtest ptest;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * Get the lag from ntuple.  Note that a lag of zero means
   * "don't throw any away".
   */
- test[0]->ntuple = ntuple;
+ test[0]->ntuple = ctx->ntuple;
  lag = test[0]->ntuple;
 
  /*
@@ -70,11 +71,14 @@ int rgb_lagged_sums(Test **test, unsigned int irun)
     * weaknesses in e.g. mt19937.
     */
 
-   /* Throw away lag per sample */
-   for(i=0;i<lag;i++) gsl_rng_uniform(rng);
+   /*
+    * Throw away lag per sample.  rng_discard_uniform() jumps ahead
+    * instead of generating them for generators that can.
+    */
+   rng_discard_uniform(ctx->rng,lag);
 
    /* sample only every lag numbers, reset counter */
-   ptest.x += gsl_rng_uniform(rng);
+   ptest.x += gsl_rng_uniform(ctx->rng);
 
  }
 
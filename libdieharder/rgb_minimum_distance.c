@@ -34,6 +34,12 @@
  * as thoroughly as one likes subject to the generous constraints
  * associated with the eventual need for still higher order corrections
  * as n and p are made large enough.
+ *
+ * The minimum distance is found by min_distance2(), which only compares
+ * neighboring points on a grid, so it stays close to linear in n even
+ * for d = 4,5 where sorting on one coordinate hardly prunes anything.
+ * With -d 201 -x 1 the unit d-cube has periodic boundary conditions (a
+ * d-torus), so no point is ever near a boundary.
  * ========================================================================
  */
 
@@ -43,41 +49,19 @@
 double rgb_mindist_avg;
 static double rgb_md_Q[] = {0.0,0.0,0.4135,0.5312,0.6202,1.3789};
 
-int compare_points(const dTuple *a,const dTuple *b)
-{
-  double diff = a->c[0] - b->c[0];
-  if (diff > 0) return 1;
-  if (diff < 0) return -1;
-  return 0;
-}
-
-double distance(const dTuple a,const dTuple b,uint dim)
-{
-  unsigned int i;
-  double delta,distance = 0.0;
-  for(i = 0;i < dim; i++){
-    delta = a.c[i] - b.c[i];
-    distance += delta*delta;
-  }
-  distance = sqrt(distance);
-  return(distance);
-}
-
 int rgb_minimum_distance(Test **test, unsigned int irun)
 {
 
- unsigned int i,j,d,t;
+ unsigned int d,t,n,torus;
  uint rgb_md_dim;
+ Dcontext *ctx = test[0]->ctx;
  
  /*
-  * These are the vector of points and the current point being
-  * considered.  We may or may not need to restructure the vectors
-  * to be able to do the sort.  I'm going to TRY to implement
-  * Fischler's suggested algorithm here that is NlogN instead of doing
-  * the straightforward N^2 algorithm, but we'll see.
+  * The points, stored coordinate by coordinate (x[d*n + t]) so that
+  * min_distance2() can run down each coordinate contiguously.
   */
- dTuple *points;
- double earg,qarg,dist,mindist,dvolume;
+ double *x;
+ double earg,qarg,mindist,dvolume;
 
  rgb_mindist_avg = 0.0;
 
@@ -85,15 +69,14 @@ int rgb_minimum_distance(Test **test, unsigned int irun)
   * Generate d-tuples of tsamples random coordinates in the range
   * 0-10000 (which we may have to scale with dimension). Determine
   * the shortest separation of two points by any means available:
-  * a double loop is simplest and slowest, or we can sort the list
-  * of coordinates on the value of the first coordinate and evaluate
-  * distances for each point only until the distance to the next
-  * coordinate exceeds the minimum found so far, which scales like
-  * the sort (n log n) instead of the double loop (n^2).  From this
-  * we generate p from the Fischler form including corrections,
-  * actually computed in place so that e.g. n can be a variable, and
-  * apply the usual KS test over psamples of independent tests, per
-  * dimension.
+  * a double loop is simplest and slowest, sorting the list on the
+  * first coordinate and sweeping scales like n log n but prunes
+  * less and less as d grows, and binning the points on a grid and
+  * comparing only neighbors (what min_distance2() does) is about
+  * linear in n.  From this we generate p from the Fischler form
+  * including corrections, actually computed in place so that e.g.
+  * n can be a variable, and apply the usual KS test over psamples
+  * of independent tests, per dimension.
   *
   * Actually, I don't see any particular reason that the d-cube should
   * be of "length 10000".  In fact, it seems pretty obvious that it
@@ -101,54 +84,41 @@ int rgb_minimum_distance(Test **test, unsigned int irun)
   * floating point variables.  Is there some aspect of this test that cares
   * what the "scale" is?  I don't think so.
   */
- points = (dTuple *)malloc(test[0]->tsamples*sizeof(dTuple));
+ n = test[0]->tsamples;
  /*
   * Set this for output.  ntuple should be set from the CLI or from
-  * -a(ll) (run_all_tests()).
+  * -a(ll) (run_all_tests()).  Like -a(ll), use d = 5 (the hardest
+  * test anyway) when it is unset or out of bounds, as it is in a plain
+  * -d 201.
   */
- test[0]->ntuple = ntuple;
+ test[0]->ntuple = ctx->ntuple;
+ if(test[0]->ntuple < 2 || test[0]->ntuple > 5) test[0]->ntuple = 5;
  rgb_md_dim = test[0]->ntuple;
+ x = (double *)malloc(rgb_md_dim*n*sizeof(double));
+
+ /*
+  * Periodic wraparound is optional (-x 1), and off by default so
+  * results match earlier versions.  -x is shared by every test (it is
+  * nms in diehard_birthdays), so under -a(ll) it is left to the others.
+  */
+ torus = (!ctx->all && ctx->x_user != 0.0);
 
  if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
-     printf("Generating a list of %u points in %d dimensions\n",test[0]->tsamples,rgb_md_dim);
+     printf("Generating a list of %u points in %d dimensions%s\n",n,rgb_md_dim,
+            torus ? " on a torus" : "");
  }
- for(t=0;t<test[0]->tsamples;t++){
+ for(t=0;t<n;t++){
 
    /*
-    * Generate a new d-dimensional point in the unit d-cube (with
-    * periodic boundary conditions).
+    * Generate a new d-dimensional point in the unit d-cube.
     */
    if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
        printf("points[%u]: (",t);
    }
    for(d=0;d<rgb_md_dim;d++) {
-     points[t].c[d] = gsl_rng_uniform_pos(rng);
+     x[d*n + t] = gsl_rng_uniform_pos(ctx->rng);
      if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
-       printf("%6.4f",points[t].c[d]);
-       if(d == rgb_md_dim - 1){
-         printf(")\n");
-       } else {
-         printf(",");
-       }
-     }
-   }
- }
-
- /*
-  * Now we sort the points using gsl_heapsort and a comparator
-  * on the first coordinate only.  Don't know how to get rid
-  * of the gcc prototype warning.  Probably need a cast of some
-  * sort.
-  */
- gsl_heapsort(points,test[0]->tsamples,sizeof(dTuple),
-                    (gsl_comparison_fn_t) compare_points);
-
- if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
-   printf("List of points sorted by first coordinate:\n");
-   for(t=0;t<test[0]->tsamples;t++){
-     printf("points[%u]: (",t);
-     for(d=0;d<rgb_md_dim;d++) {
-       printf("%6.4f",points[t].c[d]);
+       printf("%6.4f",x[d*n + t]);
        if(d == rgb_md_dim - 1){
          printf(")\n");
        } else {
@@ -159,27 +129,12 @@ int rgb_minimum_distance(Test **test, unsigned int irun)
  }
 
  /*
-  * Now we do the SINGLE PASS through to determine mindist
+  * The minimum distance, never more than 1.0 (the most any pair
+  * could be apart along the first coordinate, as the old sweep had
+  * it).
   */
- mindist = 1.0;
- for(i=0;i<test[0]->tsamples;i++){
-   /*
-    * One thing to experiment with here (very much) is
-    * whether or not we need periodic wraparound.  For
-    * the moment we omit it, although distributing
-    * the points on a euclidean d-torus seems more symmetric
-    * than not and checks to be sure that points are correct
-    * on or very near a boundary.
-    */
-   for(j=i+1;j<test[0]->tsamples;j++){
-     if(points[j].c[0] - points[i].c[0] > mindist) break;
-     dist = distance(points[j],points[i],rgb_md_dim);
-     MYDEBUG(D_RGB_MINIMUM_DISTANCE) {
-       printf("d(%u,%u) = %16.10e\n",i,j,dist);
-     }
-     if( dist < mindist) mindist = dist;
-   }
- }
+ mindist = sqrt(min_distance2(x,n,rgb_md_dim,1.0,torus));
+ if(mindist > 1.0) mindist = 1.0;
  MYDEBUG(D_RGB_MINIMUM_DISTANCE) {
    printf("Found rmin = %16.10e\n",mindist);
  }
@@ -206,7 +161,7 @@ int rgb_minimum_distance(Test **test, unsigned int irun)
  /* qarg = 1.0; */
  test[0]->pvalues[irun] = 1.0 - exp(earg)*qarg;
 
- free(points);
+ free(x);
 
  MYDEBUG(D_RGB_MINIMUM_DISTANCE) {
    printf("# diehard_2dsphere(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
@@ -35,7 +35,12 @@
  */
 
 #include <dieharder/libdieharder.h>
-#define RGB_OPERM_KMAX 10
+/*
+ * make_cexact() steps through all (3k-2)! orderings of its window:  10!
+ * (about 3.6 million) for k = 4, but 13! (about 6.2 billion) for k = 5.
+ * Past 4 it simply never finishes, so that is as far as -n may go.
+ */
+#define RGB_OPERM_KMAX 4
 
 static unsigned int rgb_operm_k;
 
@@ -44,14 +49,66 @@ static unsigned int rgb_operm_k;
  * arguably belong.
  */
 double fpipi(int pi1,int pi2,int nkp);
-uint piperm(size_t *data,int len);
 void make_cexact();
-void make_cexpt();
+void make_cexpt(Dcontext *ctx);
 unsigned int nperms,noperms;
 double **cexact,**ceinv,**cexpt,**idty;
 double *cvexact,*cvein,*cvexpt,*vidty;
 
-int rgb_operm(UNUSED_PARAM Test **test, UNUSED_PARAM unsigned int irun)
+/*
+ * Both cexact[][] and cexpt[][] are averages over samples of
+ *
+ *   f(i,pi_0) * sum_m f(j,pi_m)
+ *
+ * where f(i,p) = delta(i,p) - 1/nperms (see fpipi()), pi_0 is the
+ * permutation index of the central window of a sample and pi_m runs
+ * over all 2k-1 of its windows.  Multiplied out, the sum over samples
+ * needs only
+ *
+ *   a[i][j] = #(central window is i, some window is j)
+ *   b[i]    = #(central window is i)
+ *   c[j]    = #(some window is j)
+ *
+ * which rgb_operm_tally() accumulates in O(k) per sample (instead of
+ * O(nperms^2) calls to fpipi()) and rgb_operm_cov() turns into the
+ * matrix at the end.  The permutation index of a window is its
+ * perm_rank_order(), so there is no table of permutations to search.
+ */
+static void rgb_operm_tally(const double *testv,double *a,double *b,double *c)
+{
+
+ unsigned int m,p0;
+ unsigned int pi[RGB_OPERM_KMAX*2];
+
+ for(m=0;m<2*rgb_operm_k - 1;m++){
+   pi[m] = perm_rank_order(&testv[m],rgb_operm_k,NULL);
+ }
+ p0 = pi[rgb_operm_k - 1];
+ b[p0]++;
+ for(m=0;m<2*rgb_operm_k - 1;m++){
+   a[p0*nperms + pi[m]]++;
+   c[pi[m]]++;
+ }
+
+}
+
+static void rgb_operm_cov(double **cov,const double *a,const double *b,const double *c,
+                          double nsamples)
+{
+
+ unsigned int i,j;
+ double nwin = 2*rgb_operm_k - 1;
+ double n = nperms;
+
+ for(i=0;i<nperms;i++){
+   for(j=0;j<nperms;j++){
+     cov[i][j] += a[i*nperms + j] - b[i]*nwin/n - c[j]/n + nsamples*nwin/(n*n);
+   }
+ }
+
+}
+
+int rgb_operm(Test **test, UNUSED_PARAM unsigned int irun)
 {
 
  unsigned int i,j,iv;
@@ -65,8 +122,14 @@ int rgb_operm(UNUSED_PARAM Test **test, UNUSED_PARAM unsigned int irun)
  gsl_matrix_view CEXACT;
  //gsl_matrix_view CEINV,CEXPT,IDTY;
 
- if (!rgb_operm_k)
+ /*
+  * -n k sets the window size, default 3.
+  */
+ if(test[0]->ctx->ntuple > 0){
+   rgb_operm_k = test[0]->ctx->ntuple;
+ } else {
    rgb_operm_k = 3;
+ }
 
  /*
   * For a given n = ntuple size in bits, there are n! bit orderings
@@ -82,7 +145,8 @@ int rgb_operm(UNUSED_PARAM Test **test, UNUSED_PARAM unsigned int irun)
   * Sanity check first
   */
  if(rgb_operm_k < 2 || rgb_operm_k > RGB_OPERM_KMAX){
-   printf("\nError:  rgb_operm_k must be a positive integer between 2 and %u.  Exiting.\n",RGB_OPERM_KMAX);
+   printf("\nError:  rgb_operm -n %u:  k must be between 2 and %u, as the exact matrix\n",rgb_operm_k,RGB_OPERM_KMAX);
+   printf("steps through all (3k-2)! orderings.  Exiting.\n");
    exit(0);
  }
 
@@ -132,7 +196,7 @@ int rgb_operm(UNUSED_PARAM Test **test, UNUSED_PARAM unsigned int irun)
  }
 
  make_cexact();
- make_cexpt();
+ make_cexpt(test[0]->ctx);
 
  iv=0;
  for(i=0;i<nperms;i++){
@@ -250,18 +314,13 @@ int rgb_operm(UNUSED_PARAM Test **test, UNUSED_PARAM unsigned int irun)
 void make_cexact()
 {
 
- unsigned int i,j,k,ip,t;
- //unsigned int nop;
- double fi,fj;
+ unsigned int i,j,k;
+ double t;
+ double *ca,*cb,*cc;
  /*
   * This is the test vector.
   */
- double testv[RGB_OPERM_KMAX*2];  /* easier than malloc etc, but beware length */
- /*
-  * pi[] is the permutation index of a sample.  ps[] holds the
-  * actual sample.
-  */
- size_t pi[4096],ps[4096];
+ double testv[RGB_OPERM_KMAX*3];
  /*
   * We seem to have made a mistake of sorts.  We actually have to sum
   * BOTH the forward AND the backward directions.  That means that the
@@ -270,52 +329,17 @@ void make_cexact()
   * 0 1 2 3 4 and we'll have to do 23, 34 in the leading direction and
   * 21, 10 in the trailing direction.
   */
- gsl_permutation **operms;
+ gsl_permutation *operm;
 
  MYDEBUG(D_RGB_OPERM){
    printf("#==================================================================\n");
    printf("# rgb_operm: Running cexact()\n");
+   printf("# rgb_operm: Stepping through %u overlapping permutations\n",noperms);
  }
 
- /*
-  * Test fpipi().  This is probably cruft, actually.
- MYDEBUG(D_RGB_OPERM){
-   printf("# rgb_operm: Testing fpipi()\n");
-   for(i=0;i<nperms;i++){
-	 for(j = 0;j<nperms;j++){
-	   printf("# rgb_operm: fpipi(%u,%u,%u) = %f\n",i,j,nperms,fpipi(i,j,nperms));
-	 }
-   }
- }
- */
-
- MYDEBUG(D_RGB_OPERM){
-   printf("#==================================================================\n");
-   printf("# rgb_operm: Forming set of %u overlapping permutations\n",noperms);
-   printf("# rgb_operm: Permutations\n");
-   printf("# rgb_operm:==============================\n");
- }
- operms = (gsl_permutation**) malloc(noperms*sizeof(gsl_permutation*));
- for(i=0;i<noperms;i++){
-   operms[i] = gsl_permutation_alloc(3*rgb_operm_k - 2);
-   /* Must quiet down
-   MYDEBUG(D_RGB_OPERM){
-	 printf("# rgb_operm: ");
-   }
-   */
-   if(i == 0){
-	 gsl_permutation_init(operms[i]);
-   } else {
-	 gsl_permutation_memcpy(operms[i],operms[i-1]);
-	 gsl_permutation_next(operms[i]);
-   }
-   /*
-   MYDEBUG(D_RGB_OPERM){
-	 gsl_permutation_fprintf(stdout,operms[i]," %u");
-	 printf("\n");
-   }
-   */
- }
+ ca = (double *)calloc(nperms*nperms,sizeof(double));
+ cb = (double *)calloc(nperms,sizeof(double));
+ cc = (double *)calloc(nperms,sizeof(double));
 
  /*
   * We now form c_exact PRECISELY the same way that we do c_expt[][]
@@ -323,125 +347,73 @@ void make_cexact()
   * or floats and averaging over the permutations thus represented,
   * we iterate over the complete set of equally weighted permutations
   * to get an exact answer.  Note that we have to center on 2k-1 and
-  * go both forwards and backwards.
+  * go both forwards and backwards.  The permutations are stepped
+  * through one at a time in place; there are far too many to keep.
   */
- for(t=0;t<noperms;t++){
-   /*
-	* To sort into a perm, test vector needs to be double.
-	*/
-   for(k=0;k<3*rgb_operm_k - 2;k++) testv[k] = (double) operms[t]->data[k];
-
-   /* Not cruft, but quiet...
-   MYDEBUG(D_RGB_OPERM){
-	 printf("#------------------------------------------------------------------\n");
-	 printf("# Generating offset sample permutation pi's\n");
-   }
-   */
-   for(k=0;k<2*rgb_operm_k - 1;k++){
-	 gsl_sort_index((size_t *) ps,&testv[k],1,rgb_operm_k);
-	 pi[k] = piperm((size_t *) ps,rgb_operm_k);
-
-	 /* Not cruft, but quiet...
-	 MYDEBUG(D_RGB_OPERM){
-	   printf("# %u: ",k);
-	   for(ip=k;ip<rgb_operm_k+k;ip++){
-		 printf("%.1f ",testv[ip]);
-	   }
-	   printf("\n# ");
-	   for(ip=0;ip<rgb_operm_k;ip++){
-		 printf("%u ",ps[ip]);
-	   }
-	   printf(" = %u\n",pi[k]);
-	 }
-	 */
-
-   }
-
-   /*
-	* This is the business end of things.  The covariance matrix is the
-	* the sum of a central function of the permutation indices that yields
-	* nperms-1/nperms on diagonal, -1/nperms off diagonal, for all the
-	* possible permutations, for the FIRST permutation in a sample (fi)
-	* times the sum of the same function over all the overlapping permutations
-	* drawn from the same sample.  Quite simple, really.
-	*/
-   for(i=0;i<nperms;i++){
-	 fi = fpipi(i,pi[rgb_operm_k-1],nperms);
-	 for(j=0;j<nperms;j++){
-	   fj = 0.0;
-	   for(k=0;k<rgb_operm_k;k++){
-		 fj += fpipi(j,pi[rgb_operm_k - 1 + k],nperms);
-		 if(k != 0){
-		   fj += fpipi(j,pi[rgb_operm_k - 1 - k],nperms);
-	 }
-	   }
-	   cexact[i][j] += fi*fj;
-	 }
-   }
-
- }
+ operm = gsl_permutation_alloc(3*rgb_operm_k - 2);
+ gsl_permutation_init(operm);
+ t = 0.0;
+ do {
+   for(k=0;k<3*rgb_operm_k - 2;k++) testv[k] = (double) operm->data[k];
+   rgb_operm_tally(testv,ca,cb,cc);
+   t++;
+ } while(gsl_permutation_next(operm) == 0);   /* GSL_SUCCESS until the last */
+ gsl_permutation_free(operm);
+
+ rgb_operm_cov(cexact,ca,cb,cc,t);
 
  MYDEBUG(D_RGB_OPERM){
    printf("# rgb_operm:==============================\n");
    printf("# rgb_operm: cexact[][] = \n");
  }
- if (noperms){
-   for(i=0;i<nperms;i++){
+ for(i=0;i<nperms;i++){
+   MYDEBUG(D_RGB_OPERM){
+     printf("# ");
+   }
+   for(j=0;j<nperms;j++){
+     cexact[i][j] /= t;
      MYDEBUG(D_RGB_OPERM){
-       printf("# ");
+       printf("%10.6f  ",cexact[i][j]);
      }
-     for(j=0;j<nperms;j++){
-       cexact[i][j] /= noperms;
-       MYDEBUG(D_RGB_OPERM){
-         printf("%10.6f  ",cexact[i][j]);
-       }
-     }
-   }
-   MYDEBUG(D_RGB_OPERM){
-     printf("\n");
    }
  }
-
- /*
-  * Free operms[]
-  */
- for(i=0;i<noperms;i++){
-   gsl_permutation_free(operms[i]);
+ MYDEBUG(D_RGB_OPERM){
+   printf("\n");
  }
- free(operms);
+
+ free(cc);
+ free(cb);
+ free(ca);
 
 }
 
-void make_cexpt()
+void make_cexpt(Dcontext *ctx)
 {
 
  unsigned int i,j,k,ip,t;
- double fi,fj;
+ double *ca,*cb,*cc;
  /*
   * This is the test vector.
   */
- double testv[RGB_OPERM_KMAX*2];  /* easier than malloc etc, but beware length */
- /*
-  * pi[] is the permutation index of a sample.  ps[] holds the
-  * actual sample.
-  */
- uint pi[4096];
- size_t ps[4096];
+ double testv[RGB_OPERM_KMAX*3];
 
  MYDEBUG(D_RGB_OPERM){
    printf("#==================================================================\n");
    printf("# rgb_operm: Running cexpt()\n");
  }
 
+ ca = (double *)calloc(nperms*nperms,sizeof(double));
+ cb = (double *)calloc(nperms,sizeof(double));
+ cc = (double *)calloc(nperms,sizeof(double));
+
  /*
   * We evaluate cexpt[][] by sampling.  In a nutshell, this involves
   *   a) Filling testv[] with 2*rgb_operm_k - 1 random uints or doubles
   * It clearly cannot matter which we use, as long as the probability of
   * exact duplicates in a sample is very low.
-  *   b) Using gsl_sort_index the exact same way it was used in make_cexact()
-  * to generate the pi[] index, using ps[] as scratch space for the sort
-  * indices.
-  *   c) Evaluating fi and fj from the SAMPLED result, tsamples times.
+  *   b) Using perm_rank_order() the exact same way it was used in
+  * make_cexact() to generate the permutation index of each window.
+  *   c) Tallying fi*fj for the SAMPLED result, tsamples times.
   *   d) Normalizing.
   * Note that this is pretty much identical to the way we formed c_exact[][]
   * except that we are determining the relative frequency of each sort order
@@ -463,69 +435,44 @@ void make_cexpt()
   * communicate with me and explain why I'm wrong.  I'm still very much
   * learning statistics and would cherish gentle correction.
   */
- for(t=0;t<tsamples;t++){
+ for(t=0;t<ctx->tsamples;t++){
    /*
     * To sort into a perm, test vector needs to be double.
     */
-   for(k=0;k<3*rgb_operm_k - 2;k++) testv[k] = (double) gsl_rng_get(rng);
+   for(k=0;k<3*rgb_operm_k - 2;k++) testv[k] = (double) gsl_rng_get(ctx->rng);
 
    /* Not cruft, but quiet... */
    MYDEBUG(D_RGB_OPERM){
-	 printf("#------------------------------------------------------------------\n");
-	 printf("# Generating offset sample permutation pi's\n");
-   }
-   for(k=0;k<2*rgb_operm_k-1;k++){
-	 gsl_sort_index(ps,&testv[k],1,rgb_operm_k);
-	 pi[k] = piperm(ps,rgb_operm_k);
-
-	 /* Not cruft, but quiet... */
-	 MYDEBUG(D_RGB_OPERM){
-	   printf("# %u: ",k);
-	   for(ip=k;ip<rgb_operm_k+k;ip++){
-		 printf("%.1f ",testv[ip]);
-	   }
-	   printf("\n# ");
-	   for(ip=0;ip<rgb_operm_k;ip++){
-             printf("%u ",(unsigned)ps[ip]);
-           }
-	   printf(" = %u\n",pi[k]);
-	 }
-   }
-
-   /*
-    * This is the business end of things.  The covariance matrix is the
-    * the sum of a central function of the permutation indices that yields
-    * nperms-1/nperms on diagonal, -1/nperms off diagonal, for all the
-    * possible permutations, for the FIRST permutation in a sample (fi)
-    * times the sum of the same function over all the overlapping permutations
-    * drawn from the same sample.  Quite simple, really.
-    */
-   for(i=0;i<nperms;i++){
-     fi = fpipi(i,pi[rgb_operm_k-1],nperms);
-     for(j=0;j<nperms;j++){
-       fj = 0.0;
-       for(k=0;k<rgb_operm_k;k++){
-         fj += fpipi(j,pi[rgb_operm_k - 1 + k],nperms);
-	 if(k != 0){
-           fj += fpipi(j,pi[rgb_operm_k - 1 - k],nperms);
-	 }
+     printf("#------------------------------------------------------------------\n");
+     printf("# Generating offset sample permutation pi's\n");
+     for(k=0;k<2*rgb_operm_k-1;k++){
+       printf("# %u: ",k);
+       for(ip=k;ip<rgb_operm_k+k;ip++){
+         printf("%.1f ",testv[ip]);
        }
-       cexpt[i][j] += fi*fj;
+       printf(" = %u\n",perm_rank_order(&testv[k],rgb_operm_k,NULL));
      }
    }
+
+   rgb_operm_tally(testv,ca,cb,cc);
  }
 
+ rgb_operm_cov(cexpt,ca,cb,cc,ctx->tsamples);
+ free(cc);
+ free(cb);
+ free(ca);
+
  MYDEBUG(D_RGB_OPERM){
    printf("# rgb_operm:==============================\n");
    printf("# rgb_operm: cexpt[][] = \n");
  }
- if (tsamples){
+ if (ctx->tsamples){
    for(i=0;i<nperms;i++){
      MYDEBUG(D_RGB_OPERM){
        printf("# ");
      }
      for(j=0;j<nperms;j++){
-       cexpt[i][j] /= tsamples;
+       cexpt[i][j] /= ctx->tsamples;
        MYDEBUG(D_RGB_OPERM){
          printf("%10.6f  ",cexpt[i][j]);
        }
@@ -538,79 +485,6 @@ void make_cexpt()
 
 }
 
-uint piperm(size_t *data,int len)
-{
-
- uint i,j,k,max,min;
- uint pindex,uret,tmp;
- static gsl_permutation** lookup = 0;
-
- /*
-  * Allocate space for lookup table and fill it.
-  */
- if(lookup == 0){
-   lookup = (gsl_permutation**) malloc(nperms*sizeof(gsl_permutation*));
-   MYDEBUG(D_RGB_OPERM){
-	 printf("# rgb_operm: Allocating piperm lookup table of perms.\n");
-   }
-   for(i=0;i<nperms;i++){
-		lookup[i] = gsl_permutation_alloc(rgb_operm_k);
-   }
-   for(i=0;i<nperms;i++){
-	 if(i == 0){
-	   gsl_permutation_init(lookup[i]);
-	 } else {
-	   gsl_permutation_memcpy(lookup[i],lookup[i-1]);
-	   gsl_permutation_next(lookup[i]);
-	 }
-   }
-
-   /*
-	* This method yields a mirror symmetry in the permutations top to
-	* bottom.
-   for(i=0;i<nperms/2;i++){
-	 if(i == 0){
-	   gsl_permutation_init(lookup[i]);
-	   for(j=0;j<rgb_operm_k;j++){
-		 lookup[nperms-i-1]->data[rgb_operm_k-j-1] = lookup[i]->data[j];
-	   }
-	 } else {
-	   gsl_permutation_memcpy(lookup[i],lookup[i-1]);
-	   gsl_permutation_next(lookup[i]);
-	   for(j=0;j<rgb_operm_k;j++){
-		 lookup[nperms-i-1]->data[rgb_operm_k-j-1] = lookup[i]->data[j];
-	   }
-	 }
-   }
-   */
-   MYDEBUG(D_RGB_OPERM){
-	 for(i=0;i<nperms;i++){
-	   printf("# rgb_operm: %u => ",i);
-	   gsl_permutation_fprintf(stdout,lookup[i]," %u");
-	   printf("\n");
-	 }
-   }
-
- }
-
- for(i=0;i<nperms;i++){
-   if(memcmp(data,lookup[i]->data,len*sizeof(uint))==0){
-	 /* Not cruft, but off:
-	 MYDEBUG(D_RGB_OPERM){
-	   printf("# piperm(): ");
-	   gsl_permutation_fprintf(stdout,lookup[i]," %u");
-	   printf(" = %u\n",i);
-	 }
-	 */
-	 return(i);
-   }
- }
- printf("We'd better not get here...\n");
-
- return(0);
-
-}
-
 double fpipi(int pi1,int pi2,int nkp)
 {
 
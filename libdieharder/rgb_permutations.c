@@ -6,6 +6,8 @@
  *========================================================================
  * This just counts the permutations of n samples.  They should
  * occur n! times each.  We count them and do a straight chisq.
+ * The permutation index of a sample is its perm_rank_order(), found
+ * with k(k-1)/2 compares and no table of all n! permutations.
  *========================================================================
  */
 
@@ -22,8 +24,7 @@ int rgb_permutations(Test **test, unsigned int irun)
  uint i,k,permindex=0,t;
  Vtest vtest;
  double *testv;
- size_t ps[4096];
- gsl_permutation** lookup;
+ Dcontext *ctx = test[0]->ctx;
 
 
  MYDEBUG(D_RGB_PERMUTATIONS){
@@ -36,12 +37,16 @@ int rgb_permutations(Test **test, unsigned int irun)
   * valid test is 2.  If ntuple is less than 2, we choose the default
   * test size as 5 (like operm5).
   */
- if(ntuple<2){
+ if(ctx->ntuple<2){
    test[0]->ntuple = 5;
  } else {
-   test[0]->ntuple = ntuple;
+   test[0]->ntuple = ctx->ntuple;
  }
  k = test[0]->ntuple;
+ if(k > RGB_PERM_KMAX){
+   fprintf(stderr,"Error:  rgb_permutations can test at most k = %u.\n",RGB_PERM_KMAX);
+   exit(0);
+ }
  nperms = gsl_sf_fact(k);
 
  /*
@@ -63,35 +68,11 @@ int rgb_permutations(Test **test, unsigned int irun)
    vtest.y[i] = (double) test[0]->tsamples/nperms;
  }
 
- MYDEBUG(D_RGB_PERMUTATIONS){
-   printf("# rgb_permutations: Allocating permutation lookup table.\n");
- }
- lookup = (gsl_permutation**) malloc(nperms*sizeof(gsl_permutation*));
- for(i=0;i<nperms;i++){
-   lookup[i] = gsl_permutation_alloc(k);
- }
- for(i=0;i<nperms;i++){
-   if(i == 0){
-     gsl_permutation_init(lookup[i]);
-   } else {
-     gsl_permutation_memcpy(lookup[i],lookup[i-1]);
-     gsl_permutation_next(lookup[i]);
-   }
- }
-
- MYDEBUG(D_RGB_PERMUTATIONS){
-   for(i=0;i<nperms;i++){
-     printf("# rgb_permutations: %u => ",i);
-     gsl_permutation_fprintf(stdout,lookup[i]," %u");
-     printf("\n");
-   }
- }
-
  /*
   * We count the order permutations in a long string of samples of
   * rgb_permutation_k non-overlapping rands.  This is done by:
   *   a) Filling testv[] with rgb_permutation_k rands.
-  *   b) Using gsl_sort_index to generate the permutation index.
+  *   b) Using perm_rank_order() to generate the permutation index.
   *   c) Incrementing a counter for that index (a-c done tsamples times)
   *   d) Doing a straight chisq on the counter vector with nperms-1 DOF
   *
@@ -103,31 +84,13 @@ int rgb_permutations(Test **test, unsigned int irun)
     * To sort into a perm, test vector needs to be double.
     */
    for(i=0;i<k;i++) {
-     testv[i] = (double) gsl_rng_get(rng);
+     testv[i] = (double) gsl_rng_get(ctx->rng);
      MYDEBUG(D_RGB_PERMUTATIONS){
        printf("# rgb_permutations: testv[%u] = %u\n",i,(uint) testv[i]);
      }
    }
 
-   gsl_sort_index(ps,testv,1,k);
-
-   MYDEBUG(D_RGB_PERMUTATIONS){
-     for(i=0;i<k;i++) {
-       printf("# rgb_permutations: ps[%u] = %lu\n",i,(unsigned long)ps[i]);
-     }
-   }
-
-   for(i=0;i<nperms;i++){
-     if(memcmp(ps,lookup[i]->data,k*sizeof(size_t))==0){
-       permindex = i;
-       MYDEBUG(D_RGB_PERMUTATIONS){
-         printf("# Found permutation: ");
-         gsl_permutation_fprintf(stdout,lookup[i]," %u");
-         printf(" = %u\n",i);
-       }
-       break;
-     }
-   }
+   permindex = perm_rank_order(testv,k,NULL);
 
    vtest.x[permindex]++;
    MYDEBUG(D_RGB_PERMUTATIONS){
@@ -150,10 +113,6 @@ int rgb_permutations(Test **test, unsigned int irun)
    printf("# rgb_permutations(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
- for(i=0;i<nperms;i++){
-   gsl_permutation_free(lookup[i]);
- }
- free(lookup);
  free(testv);
  Vtest_destroy(&vtest);
 
@@ -21,13 +21,13 @@
 
 #include <dieharder/libdieharder.h>
 
-static unsigned int *rgb_persist_rand_uint;
-
-int rgb_persist(UNUSED_PARAM Test **test, Rgb_Persist *persist)
+int rgb_persist(Test **test, Rgb_Persist *persist)
 {
 
  uint last_rand;
  uint i,j;
+ uint rgb_persist_rand_uint[256];
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * Now go through the list and dump the numbers several ways.
@@ -39,20 +39,19 @@ int rgb_persist(UNUSED_PARAM Test **test, Rgb_Persist *persist)
  }
 
  persist->cumulative_mask = 0;
- for(j=0;j<psamples;j++){
+ for(j=0;j<ctx->psamples;j++){
    /*
     * Do not reset the total count of rands or rewind file input
     * files -- let them auto-rewind as needed.  Otherwise try
     * different seeds for different samples.
     */
-   if(strncmp("file_input",gsl_rng_name(rng),10)){
-	 seed = random_seed();
-	 gsl_rng_set(rng,seed);
+   if(strncmp("file_input",gsl_rng_name(ctx->rng),10)){
+	 context_reseed(ctx,random_seed());
    }
    /*
     * Fill rgb_persist_rand_uint with a string of random numbers
     */
-   for(i=0;i<256;i++) rgb_persist_rand_uint[i] = gsl_rng_get(rng);
+   for(i=0;i<256;i++) rgb_persist_rand_uint[i] = gsl_rng_get(ctx->rng);
    last_rand = rgb_persist_rand_uint[0];  /* to start it */
    persist->and_mask = ~(last_rand ^ rgb_persist_rand_uint[0]);
    for(i=0;i<256;i++){
@@ -73,7 +72,7 @@ int rgb_persist(UNUSED_PARAM Test **test, Rgb_Persist *persist)
 	 }
 
    }
-   persist->and_mask = persist->and_mask & rmax_mask;
+   persist->and_mask = persist->and_mask & ctx->rmax_mask;
    persist->cumulative_mask = persist->cumulative_mask | persist->and_mask;
  }
 
@@ -22,23 +22,25 @@ int rgb_timing(Test **test, Rgb_Timing *timing)
  unsigned int i,j;
  unsigned int *rand_uint;
  double *rand_dbl;
+ Dcontext *ctx = test[0]->ctx;
 
  MYDEBUG(D_RGB_TIMING){
    printf("# Entering rgb_timing(): ps = %u  ts = %u\n",
           test[0]->psamples, test[0]->tsamples);
  }
 
- seed = random_seed();
- gsl_rng_set(rng,seed);
+ context_reseed(ctx,random_seed());
 
  rand_uint = (uint *)malloc((size_t)test[0]->tsamples*sizeof(uint));
 
+ /*
+  * Integer rands are timed the way the tests draw them, in bulk (see
+  * rng_fill.h).
+  */
  total_time = 0.0;
  for(i=0;i<test[0]->psamples;i++){
    start_timing();
-   for(j=0;j<test[0]->tsamples;j++){
-     rand_uint[j] = gsl_rng_get(rng);
-   }
+   fill_u32(ctx->rng,rand_uint,test[0]->tsamples);
    stop_timing();
    total_time += delta_timing();
  }
@@ -57,7 +59,7 @@ int rgb_timing(Test **test, Rgb_Timing *timing)
  for(i=0;i<test[0]->psamples;i++){
    start_timing();
    for(j=0;j<test[0]->tsamples;j++){
-     rand_dbl[j] = gsl_rng_uniform(rng);
+     rand_dbl[j] = gsl_rng_uniform(ctx->rng);
    }
    stop_timing();
    total_time += delta_timing();
@@ -543,6 +543,144 @@ static double aesni_get_double (void *vstate)
   return TO_DOUBLE(aesni_get(vstate));
 }
 
+/*
+ * Multi-lane AES-CTR.  VAES runs an AES round on every 128 bit lane of
+ * a ymm or zmm register, so one refill (AESCTR_UNROLL counters) is two
+ * ymm or one zmm, and we do AESCTR_VREFILLS refills at once:  refill r
+ * encrypts ctr[i] + AESCTR_UNROLL*r, as the r'th aesctr_r() refill
+ * from here would, into 16 * AESCTR_UNROLL bytes of out.  Only for the
+ * AES-NI stream (g_use_aesni); the counters are advanced past it.
+ */
+#define AESCTR_VREFILLS 4
+
+#if defined(__AES__) && __AES__ && defined(__VAES__) && defined(__AVX2__)
+#define AESCTR_SIMD 1
+static void aesctr_counters(aesctr_state_t *state, aes128_t *ctr)
+{
+  int r, i;
+  for (r = 0; r < AESCTR_VREFILLS; r++) {
+    for (i = 0; i < AESCTR_UNROLL; i++) {
+      ctr[r * AESCTR_UNROLL + i] = state->ctr[i];
+      state->ctr[i].u64[0] += AESCTR_UNROLL;
+      state->ctr[i].u64[1] += (state->ctr[i].u64[0] < AESCTR_UNROLL);
+    }
+  }
+}
+
+static void aesctr_refills_y(aesctr_state_t *state, uint8_t *out)
+{
+  ALIGN_WINDOWS aes128_t ctr[AESCTR_VREFILLS * AESCTR_UNROLL] ALIGN_GCC_CLANG;
+  __m256i work[AESCTR_VREFILLS * AESCTR_UNROLL / 2];
+  const int nw = AESCTR_VREFILLS * AESCTR_UNROLL / 2;
+  int i, r;
+  aesctr_counters(state, ctr);
+  for (i = 0; i < nw; i++) {
+    work[i] = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&ctr[2 * i]),
+                               _mm256_broadcastsi128_si256(state->seed[0].m128));
+  }
+  for (r = 1; r <= AESCTR_ROUNDS - 1; r++) {
+    const __m256i subkey = _mm256_broadcastsi128_si256(state->seed[r].m128);
+    for (i = 0; i < nw; i++) work[i] = _mm256_aesenc_epi128(work[i], subkey);
+  }
+  for (i = 0; i < nw; i++) {
+    _mm256_storeu_si256((__m256i *)&out[32 * i],
+        _mm256_aesenclast_epi128(work[i],
+            _mm256_broadcastsi128_si256(state->seed[AESCTR_ROUNDS].m128)));
+  }
+}
+#endif
+
+#if defined(AESCTR_SIMD) && defined(__AVX512F__)
+static void aesctr_refills_z(aesctr_state_t *state, uint8_t *out)
+{
+  ALIGN_WINDOWS aes128_t ctr[AESCTR_VREFILLS * AESCTR_UNROLL] ALIGN_GCC_CLANG;
+  __m512i work[AESCTR_VREFILLS * AESCTR_UNROLL / 4];
+  const int nw = AESCTR_VREFILLS * AESCTR_UNROLL / 4;
+  int i, r;
+  aesctr_counters(state, ctr);
+  for (i = 0; i < nw; i++) {
+    work[i] = _mm512_xor_si512(_mm512_loadu_si512((const void *)&ctr[4 * i]),
+                               _mm512_broadcast_i32x4(state->seed[0].m128));
+  }
+  for (r = 1; r <= AESCTR_ROUNDS - 1; r++) {
+    const __m512i subkey = _mm512_broadcast_i32x4(state->seed[r].m128);
+    for (i = 0; i < nw; i++) work[i] = _mm512_aesenc_epi128(work[i], subkey);
+  }
+  for (i = 0; i < nw; i++) {
+    _mm512_storeu_si512((void *)&out[64 * i],
+        _mm512_aesenclast_epi128(work[i],
+            _mm512_broadcast_i32x4(state->seed[AESCTR_ROUNDS].m128)));
+  }
+}
+#endif
+
+/* Bulk fill (see rng_fill.h):  what's left of the current refill, then
+   AESCTR_VREFILLS refills at a time when VAES can make them, then the
+   tail, each 64 bit return truncated to unsigned int as gsl_rng_get()
+   into one truncates it. */
+void aesni_fill_u32(void *vstate, unsigned int *buf, size_t n)
+{
+  aesctr_state_t* state = (aesctr_state_t*) vstate;
+  size_t i = 0;
+
+  while (i < n && state->offset < 16 * AESCTR_UNROLL)
+    buf[i++] = (unsigned int)aesctr_r(state);
+#ifdef AESCTR_SIMD
+  if (g_use_aesni && x86_has_vaes()) {
+    uint8_t out[16 * AESCTR_UNROLL * AESCTR_VREFILLS];
+    const size_t run = sizeof(out) / sizeof(uint64_t);
+    uint64_t output;
+    size_t k;
+    for (; i + run <= n; i += run) {
+#ifdef __AVX512F__
+      if (x86_simd_level() >= X86_SIMD_AVX512)
+        aesctr_refills_z(state, out);
+      else
+#endif
+        aesctr_refills_y(state, out);
+      for (k = 0; k < run; k++) {
+        memcpy(&output, &out[sizeof(output) * k], sizeof(output));
+#ifdef LITTLE_ENDIAN
+        output = bswap_64(output);
+#endif
+        buf[i + k] = (unsigned int)output;
+      }
+    }
+  }
+#endif
+  for (; i < n; i++)
+    buf[i] = (unsigned int)aesctr_r(state);
+}
+
+/* Discard (see rng_discard.h):  the 64 bit returns come 16 * AESCTR_UNROLL
+   bytes per refill, and each refill adds AESCTR_UNROLL to every counter.
+   Skip whole refills on the counters, then refill once and set the
+   offset into the buffer. */
+void aesni_discard(void *vstate, uint64_t n)
+{
+  aesctr_state_t* state = (aesctr_state_t*) vstate;
+  uint64_t avail, per, refills, add, low;
+  int i;
+
+  avail = (16 * AESCTR_UNROLL - state->offset) / sizeof(uint64_t);
+  if (n <= avail) {
+    state->offset += n * sizeof(uint64_t);
+    return;
+  }
+  per = 16 * AESCTR_UNROLL / sizeof(uint64_t);
+  n -= avail;
+  refills = (n + per - 1) / per;
+  add = (refills - 1) * AESCTR_UNROLL;
+  for (i = 0; i < AESCTR_UNROLL; i++) {
+    low = state->ctr[i].u64[0];
+    state->ctr[i].u64[0] += add;
+    state->ctr[i].u64[1] += (state->ctr[i].u64[0] < low);
+  }
+  state->offset = 16 * AESCTR_UNROLL;
+  (void)aesctr_r(state);
+  state->offset = (n - (refills - 1) * per) * sizeof(uint64_t);
+}
+
 static const gsl_rng_type aesni_type =
 {"aesni",                       /* name */
  UINT64_MAX,			/* RAND_MAX 64bit only */
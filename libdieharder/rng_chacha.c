@@ -215,6 +215,68 @@ static inline double chacha_next_double(chacha_state_t *state){
     return (chacha_next64(state) >> 11) * (1.0/9007199254740992.0);
 }
 
+/*
+ * Multi-lane ChaCha for the bulk fill:  16 GCC vectors (see
+ * cpu_features.h) hold the 16 state words of 8 (AVX2) or 16 (AVX-512)
+ * consecutive blocks, one block per lane, so the quarter rounds are
+ * plain lane-wise adds, xors and rotates with no shuffling between
+ * them.  Lane j is the block at ctr + 16 j, laid out exactly as
+ * generate_block() lays it out.  ctr must be on a block boundary; it is
+ * advanced past the blocks made.
+ */
+#define CHACHA_VROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define CHACHA_VQUARTERROUND(x, a, b, c, d) \
+    x[a] += x[b]; x[d] ^= x[a]; x[d] = CHACHA_VROTL32(x[d], 16); \
+    x[c] += x[d]; x[b] ^= x[c]; x[b] = CHACHA_VROTL32(x[b], 12); \
+    x[a] += x[b]; x[d] ^= x[a]; x[d] = CHACHA_VROTL32(x[d],  8); \
+    x[c] += x[d]; x[b] ^= x[c]; x[b] = CHACHA_VROTL32(x[b],  7)
+
+#define _chacha_blocks_tpl(V)                                               \
+static void chacha_blocks_##V(chacha_state_t *state, uint32_t *buf)         \
+{                                                                           \
+    enum { lanes = sizeof(uint##V##_t) / sizeof(uint32_t) };                \
+    const uint32_t constants[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574}; \
+    uint##V##_t x[16], input[16];                                           \
+    uint64_t c0, c1;                                                        \
+    int i, j;                                                               \
+    for (i = 0; i < 4; ++i) input[i] = (uint##V##_t){0} + constants[i];     \
+    for (i = 0; i < 8; ++i) input[4 + i] = (uint##V##_t){0} + state->keysetup[i]; \
+    for (j = 0; j < lanes; ++j) {                                           \
+        c0 = state->ctr[0] + 16 * (uint64_t)j;                              \
+        c1 = state->ctr[1] + (c0 < state->ctr[0]);                          \
+        input[12][j] = (c0 / 16) & 0xffffffffu;                             \
+        input[13][j] = (((uint32_t)(c1) % 16) << 28) | ((c0 / 16) >> 32);   \
+        input[14][j] = (c1 / 16) & 0xffffffffu;                             \
+        input[15][j] = (c1 / 16) >> 32;                                     \
+    }                                                                       \
+    for (i = 0; i < 16; ++i) x[i] = input[i];                               \
+    for (i = 0; i < CHACHA_ROUNDS ; i += 2) {                               \
+        CHACHA_VQUARTERROUND(x, 0, 4,  8, 12);                              \
+        CHACHA_VQUARTERROUND(x, 1, 5,  9, 13);                              \
+        CHACHA_VQUARTERROUND(x, 2, 6, 10, 14);                              \
+        CHACHA_VQUARTERROUND(x, 3, 7, 11, 15);                              \
+        CHACHA_VQUARTERROUND(x, 0, 5, 10, 15);                              \
+        CHACHA_VQUARTERROUND(x, 1, 6, 11, 12);                              \
+        CHACHA_VQUARTERROUND(x, 2, 7,  8, 13);                              \
+        CHACHA_VQUARTERROUND(x, 3, 4,  9, 14);                              \
+    }                                                                       \
+    for (i = 0; i < 16; ++i) x[i] += input[i];                              \
+    for (j = 0; j < lanes; ++j)                                             \
+        for (i = 0; i < 16; ++i) buf[16 * j + i] = x[i][j];                 \
+    c0 = state->ctr[0];                                                     \
+    state->ctr[0] += 16 * lanes;                                            \
+    state->ctr[1] += (state->ctr[0] < c0);                                  \
+}
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#define CHACHA_SIMD_Y 1
+_chacha_blocks_tpl(y32)
+#endif
+#if defined(__GNUC__) && defined(__AVX512F__)
+#define CHACHA_SIMD_Z 1
+_chacha_blocks_tpl(z32)
+#endif
+
 // See https://www.felixcloutier.com/x86/cpuid
 #if defined(__SSE2__) && __SSE2__
 #if defined(__SSSE3__) && __SSSE3__
@@ -273,7 +335,9 @@ static void chacha_advance(chacha_state_t *state, uint64_t *delta) {
   state->ctr[0] += delta[0];
   carry = state->ctr[0] < orig;
   state->ctr[1] += (delta[1] + carry);
-  if ((idx + delta[0] >= 16 || delta[1]) && ((state->ctr[0] % 16) != 0)) {
+  /* At idx 0 the block is the previous one, chacha_next32() hasn't
+     generated the current one yet */
+  if ((idx == 0 || idx + delta[0] >= 16 || delta[1]) && ((state->ctr[0] % 16) != 0)) {
     generate_block(state);
   }
 }
@@ -305,6 +369,41 @@ static double chacha_get_double (void *vstate)
   return TO_DOUBLE(chacha_next64(state));
 }
 
+/* Bulk fill (see rng_fill.h):  the rest of the current block one at a
+   time, then whole runs of blocks from the multi-lane kernels, then the
+   tail.  The same stream as chacha_next32(). */
+void chacha_fill_u32(void *vstate, unsigned int *buf, size_t n)
+{
+  chacha_state_t* state = (chacha_state_t*) vstate;
+  size_t i = 0;
+  while (i < n && state->ctr[0] % 16 != 0)
+    buf[i++] = chacha_next32(state);
+#ifdef CHACHA_SIMD_Z
+  if (x86_simd_level() >= X86_SIMD_AVX512) {
+    for (; i + 16 * 16 <= n; i += 16 * 16)
+      chacha_blocks_z32(state, buf + i);
+  }
+#endif
+#ifdef CHACHA_SIMD_Y
+  if (x86_simd_level() >= X86_SIMD_AVX2) {
+    for (; i + 16 * 8 <= n; i += 16 * 8)
+      chacha_blocks_y32(state, buf + i);
+  }
+#endif
+  for (; i < n; i++)
+    buf[i] = chacha_next32(state);
+}
+
+/* Discard (see rng_discard.h):  the counter counts 32 bit returns, so
+   chacha_advance() skips n of them directly. */
+void chacha_discard(void *vstate, uint64_t n)
+{
+  uint64_t delta[2];
+  delta[0] = n;
+  delta[1] = 0;
+  chacha_advance((chacha_state_t*) vstate, delta);
+}
+
 static const gsl_rng_type chacha_type =
 {"chacha",                      /* name */
  UINT32_MAX,			/* RAND_MAX */
@@ -0,0 +1,292 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * rng_discard() (see rng_discard.h), the table of generators that have
+ * a native discard, and the GF(2) polynomial jump used by the linear
+ * (xoshiro/xoroshiro) ones.  A generator that isn't in the table is
+ * stepped exactly as before, one gsl_rng_get() or gsl_rng_uniform() at
+ * a time.
+ *========================================================================
+ */
+
+#undef VERSION
+#include "config.h"
+#include <dieharder/libdieharder.h>
+
+static const rng_discard_type rng_discards[] = {
+ {&gsl_rng_philox2x32, philox2x32_discard, 2},
+ {&gsl_rng_philox4x32, philox4x32_discard, 2},
+ {&gsl_rng_threefry2x32, threefry2x32_discard, 2},
+ {&gsl_rng_threefry4x32, threefry4x32_discard, 2},
+ {&gsl_rng_chacha, chacha_discard, 2},
+ {&gsl_rng_aesni, aesni_discard, 1},
+ {&gsl_rng_pcg32, pcg32_discard, 1},
+ {&gsl_rng_drand48, drand48_discard, 1},
+ {&gsl_rng_splitmix64, splitmix64_discard, 1},
+ {&gsl_rng_wyrand, wyrand_discard, 1},
+ {&gsl_rng_xoshiro128_pp, xoshiro128_pp_discard, 1},
+ {&gsl_rng_xoshiro128_ss, xoshiro128_ss_discard, 1},
+ {&gsl_rng_xoshiro128_p, xoshiro128_p_discard, 1},
+ {&gsl_rng_xoroshiro64_ss, xoroshiro64_ss_discard, 1},
+ {&gsl_rng_xoroshiro64_s, xoroshiro64_s_discard, 1},
+#ifndef HAVE_32BITLONG
+ {&gsl_rng_philox2x64, philox2x64_discard, 1},
+ {&gsl_rng_philox4x64, philox4x64_discard, 1},
+ {&gsl_rng_threefry2x64, threefry2x64_discard, 1},
+ {&gsl_rng_threefry4x64, threefry4x64_discard, 1},
+ {&gsl_rng_xoshiro256_pp, xoshiro256_pp_discard, 1},
+ {&gsl_rng_xoshiro256_ss, xoshiro256_ss_discard, 1},
+ {&gsl_rng_xoshiro256_p, xoshiro256_p_discard, 1},
+ {&gsl_rng_xoroshiro128_pp, xoroshiro128_pp_discard, 1},
+ {&gsl_rng_xoroshiro128_ss, xoroshiro128_ss_discard, 1},
+ {&gsl_rng_xoroshiro128_p, xoroshiro128_p_discard, 1},
+#endif
+#if defined(__SIZEOF_INT128__) && !defined(HAVE_32BITLONG)
+ {&gsl_rng_pcg64, pcg64_discard, 1},
+ {&gsl_rng_pcg64_cmdxsm, pcg64_cmdxsm_discard, 1},
+ {&gsl_rng_pcg64_dxsm, pcg64_dxsm_discard, 1},
+#endif
+ {NULL, NULL, 0}
+};
+
+static const rng_discard_type *rng_discard_lookup(const gsl_rng_type *type)
+{
+
+ const rng_discard_type *d;
+
+ for(d = rng_discards;d->type != NULL;d++){
+   if(*d->type == type) return(d);
+ }
+ return(NULL);
+
+}
+
+/*
+ * Return the native discard for type, or NULL if it doesn't have one.
+ */
+rng_discard_t rng_get_discard(const gsl_rng_type *type)
+{
+
+ const rng_discard_type *d = rng_discard_lookup(type);
+
+ return(d ? d->discard : NULL);
+
+}
+
+void rng_discard(gsl_rng *rng, uint64_t n)
+{
+
+ const rng_discard_type *d = rng_discard_lookup(rng->type);
+
+ if(d != NULL){
+   d->discard(rng->state,n);
+   return;
+ }
+ while(n--) gsl_rng_get(rng);
+
+}
+
+void rng_discard_uniform(gsl_rng *rng, uint64_t n)
+{
+
+ const rng_discard_type *d = rng_discard_lookup(rng->type);
+
+ if(d != NULL){
+   d->discard(rng->state,n*d->per_double);
+   return;
+ }
+ while(n--) gsl_rng_uniform(rng);
+
+}
+
+/*
+ *========================================================================
+ * The GF(2) jump.  Polynomials over GF(2) are bit vectors, bit i the
+ * coefficient of x^i, in RNG_GF2_MAXDEG/64 + 1 words.
+ *========================================================================
+ */
+#define GF2_WORDS (RNG_GF2_MAXDEG/64 + 1)
+
+static inline unsigned int gf2_bit(const uint64_t *a, unsigned int i)
+{
+ return((a[i/64] >> (i%64)) & 1);
+}
+
+static inline void gf2_flip(uint64_t *a, unsigned int i)
+{
+ a[i/64] ^= (uint64_t) 1 << (i%64);
+}
+
+/*
+ * a = a*x mod p, a of degree < deg(p) = d.
+ */
+static void gf2_mulx(uint64_t *a, const rng_gf2_poly *poly)
+{
+
+ unsigned int i,d = poly->degree;
+
+ for(i=GF2_WORDS-1;i>0;i--){
+   a[i] = (a[i] << 1) | (a[i-1] >> 63);
+ }
+ a[0] <<= 1;
+ if(gf2_bit(a,d)){
+   for(i=0;i<GF2_WORDS;i++) a[i] ^= poly->p[i];
+ }
+
+}
+
+/*
+ * a ^= p x^shift, a 2*GF2_WORDS words long.
+ */
+static inline void gf2_xor_shifted(uint64_t *a, const uint64_t *p, unsigned int shift)
+{
+
+ unsigned int k,w = shift/64,b = shift%64;
+
+ for(k=0;k<GF2_WORDS && k+w<2*GF2_WORDS;k++){
+   a[k+w] ^= p[k] << b;
+   if(b && k+w+1 < 2*GF2_WORDS) a[k+w+1] ^= p[k] >> (64-b);
+ }
+
+}
+
+/*
+ * a = a^2 mod p.  Squaring over GF(2) just spreads the bits out,
+ * x^i -> x^2i, and we reduce from the top down.
+ */
+static void gf2_sqr(uint64_t *a, const rng_gf2_poly *poly)
+{
+
+ uint64_t sq[2*GF2_WORDS];
+ unsigned int i,d = poly->degree;
+
+ memset(sq,0,sizeof(sq));
+ for(i=0;i<d;i++){
+   if(gf2_bit(a,i)) gf2_flip(sq,2*i);
+ }
+ for(i=2*d;i-- > d;){
+   if(gf2_bit(sq,i)) gf2_xor_shifted(sq,poly->p,i-d);
+ }
+ memcpy(a,sq,GF2_WORDS*sizeof(uint64_t));
+
+}
+
+/*
+ * Berlekamp-Massey on the sequence of bit 0 of the state, 2*degree
+ * steps of it.  For a full period linear generator (and any nonzero
+ * state) the connection polynomial that comes out is the characteristic
+ * polynomial of the step, of the full degree; if it isn't we leave
+ * poly->degree at zero and the caller just steps.
+ */
+static void gf2_charpoly(const void *vstate, size_t size, unsigned long int (*get)(void *),
+                         unsigned int degree, rng_gf2_poly *poly)
+{
+
+ uint64_t state[RNG_GF2_MAXDEG/64];
+ unsigned char s[2*RNG_GF2_MAXDEG];
+ unsigned char c[2*RNG_GF2_MAXDEG+1],b[2*RNG_GF2_MAXDEG+1],t[2*RNG_GF2_MAXDEG+1];
+ unsigned int i,j,n,L,m,dlt;
+ rng_gf2_poly p;
+
+ n = 2*degree;
+ memcpy(state,vstate,size);
+ for(i=0;i<n;i++){
+   s[i] = state[0] & 1;
+   get(state);
+ }
+
+ memset(c,0,sizeof(c));
+ memset(b,0,sizeof(b));
+ c[0] = b[0] = 1;
+ L = 0;
+ m = 1;
+ for(i=0;i<n;i++){
+   dlt = s[i];
+   for(j=1;j<=L;j++) dlt ^= c[j] & s[i-j];
+   if(dlt == 0){
+     m++;
+   } else if(2*L <= i){
+     memcpy(t,c,sizeof(c));
+     for(j=0;j+m<=n;j++) c[j+m] ^= b[j];
+     L = i + 1 - L;
+     memcpy(b,t,sizeof(t));
+     m = 1;
+   } else {
+     for(j=0;j+m<=n;j++) c[j+m] ^= b[j];
+     m++;
+   }
+ }
+ if(L != degree) return;
+
+ /*
+  * c(x) = 1 + c_1 x + ... + c_L x^L is the connection polynomial; the
+  * characteristic polynomial is its reciprocal x^L c(1/x).
+  */
+ memset(&p,0,sizeof(p));
+ for(j=0;j<=L;j++){
+   if(c[j]) gf2_flip(p.p,L-j);
+ }
+ memcpy(poly->p,p.p,sizeof(p.p));
+ poly->degree = degree;
+
+}
+
+void rng_discard_gf2(void *vstate, size_t size, unsigned long int (*get)(void *),
+                     unsigned int degree, rng_gf2_poly *poly, uint64_t n)
+{
+
+ uint64_t state[RNG_GF2_MAXDEG/64],acc[RNG_GF2_MAXDEG/64];
+ uint64_t *r;
+ unsigned int i,k;
+ int bit;
+
+ /*
+  * Short discards are cheaper to just step, and so is everything if
+  * we can't get the polynomial.
+  */
+ if(n > 2*(uint64_t)degree && poly->degree == 0){
+   gf2_charpoly(vstate,size,get,degree,poly);
+ }
+ if(n <= 2*(uint64_t)degree || poly->degree != degree){
+   memcpy(state,vstate,size);
+   while(n--) get(state);
+   memcpy(vstate,state,size);
+   return;
+ }
+
+ /*
+  * r = x^n mod p, from the top bit of n down.  The lag tests discard
+  * the same n over and over, so the last r is kept with the polynomial.
+  */
+ if(poly->n != n){
+   r = poly->r;
+   memset(r,0,sizeof(poly->r));
+   r[0] = 1;
+   for(bit=63;bit>=0 && ((n >> bit) & 1) == 0;bit--);
+   for(;bit>=0;bit--){
+     gf2_sqr(r,poly);
+     if((n >> bit) & 1) gf2_mulx(r,poly);
+   }
+   poly->n = n;
+ }
+ r = poly->r;
+
+ /*
+  * s' = r(T) s = sum_i r_i T^i s, accumulated by stepping a copy.
+  */
+ memcpy(state,vstate,size);
+ memset(acc,0,size);
+ for(i=0;i<degree;i++){
+   if(gf2_bit(r,i)){
+     for(k=0;k<size/8;k++) acc[k] ^= state[k];
+   }
+   get(state);
+ }
+ memcpy(vstate,acc,size);
+
+}
@@ -250,3 +250,26 @@ static const gsl_rng_type drand48_type =
  &drand48_get_double};
 
 const gsl_rng_type *gsl_rng_drand48 = &drand48_type;
+
+/* Jump n steps ahead (see rng_discard.h):  the 48 bit LCG composed with
+   itself by squaring, mod 2^48. */
+void drand48_discard(void *vstate, uint64_t n)
+{
+  drand48_state_t* state = (drand48_state_t*) vstate;
+#ifdef HAVE_NATIVE64
+  U64 cur_mult = DRAND48_MULT, cur_plus = DRAND48_ADD;
+  U64 acc_mult = 1, acc_plus = 0;
+  while (n > 0) {
+    if (n & 1) {
+      acc_mult = (acc_mult * cur_mult) & DRAND48_MASK;
+      acc_plus = (acc_plus * cur_mult + cur_plus) & DRAND48_MASK;
+    }
+    cur_plus = ((cur_mult + 1) * cur_plus) & DRAND48_MASK;
+    cur_mult = (cur_mult * cur_mult) & DRAND48_MASK;
+    n /= 2;
+  }
+  *state = (acc_mult * *state + acc_plus) & DRAND48_MASK;
+#else
+  while (n--) our_rand48_r (state);
+#endif
+}
@@ -15,6 +15,7 @@
 
 #define RNG_FILE_INPUT_C
 #include <dieharder/libdieharder.h>
+#include <ctype.h>
 
 static void file_input_set (void *vstate, unsigned long int s);
 
@@ -23,6 +24,7 @@ int fromfile;
 int filenumbits;
 off_t filecount;
 char filetype;
+int file_input_cache;
 
 /*
  * This is a wrapper for getting random numbers from a file.  Note
@@ -71,13 +73,223 @@ file_input_set_rtot(gsl_rng *rng,UNUSED_PARAM uint value)
   state->rtot = 0;
 }
 
+/*
+ * The input file is read through a big buffer a line at a time, and
+ * the lines are converted by the hand-written parsers below instead of
+ * sscanf(), which spends far more time working out what it has been
+ * asked to do than doing it.
+ */
+#define FILE_INPUT_BUFSIZE (1 << 20)
+
+/*
+ * Return the next line of the file (without its newline), or NULL at
+ * EOF.  A line longer than the whole buffer is returned in pieces, as
+ * fgets() would.
+ */
+static char *file_input_line(file_input_state_t *state)
+{
+
+ char *line,*nl;
+ size_t n;
+
+ while(1){
+   nl = memchr(state->buf + state->bpos,'\n',state->bend - state->bpos);
+   if(nl != NULL){
+     line = state->buf + state->bpos;
+     *nl = 0;
+     state->bpos = nl - state->buf + 1;
+     return(line);
+   }
+
+   /*
+    * No whole line left, so slide what there is of the next one down
+    * to the start of the buffer and read in some more.
+    */
+   n = state->bend - state->bpos;
+   if(n == FILE_INPUT_BUFSIZE || (n > 0 && feof(state->fp))){
+     state->buf[n] = 0;
+     state->bpos = state->bend;
+     return(state->buf);
+   }
+   memmove(state->buf,state->buf + state->bpos,n);
+   state->bpos = 0;
+   state->bend = n;
+   n = fread(state->buf + state->bend,1,FILE_INPUT_BUFSIZE - state->bend,state->fp);
+   if(n == 0 && state->bend == 0) return(NULL);
+   state->bend += n;
+ }
+
+}
+
+/*
+ * Convert the unsigned integer (in base 8, 10 or 16) at the start of p,
+ * after any white space, into *val.  Returns the number of digits
+ * converted, 0 if there weren't any (where sscanf() returned 0).  As
+ * with sscanf(), a sign is allowed, a hex number can start with 0x, and
+ * a number too big for an unsigned long gives ULONG_MAX.
+ */
+static int file_input_parse_uint(const char *p, unsigned int base, unsigned int *val)
+{
+
+ unsigned long int u = 0;
+ unsigned int d;
+ int neg = 0,n = 0;
+
+ while(isspace((unsigned char) *p)) p++;
+ if(*p == '-' || *p == '+') neg = (*p++ == '-');
+ if(base == 16 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && isxdigit((unsigned char) p[2])){
+   p += 2;
+ }
+ for(;;p++,n++){
+   if(*p >= '0' && *p <= '9'){
+     d = *p - '0';
+   } else if(*p >= 'a' && *p <= 'f'){
+     d = *p - 'a' + 10;
+   } else if(*p >= 'A' && *p <= 'F'){
+     d = *p - 'A' + 10;
+   } else {
+     break;
+   }
+   if(d >= base) break;
+   if(u > (ULONG_MAX - d)/base){
+     u = ULONG_MAX;
+   } else {
+     u = u*base + d;
+   }
+ }
+ *val = neg ? -(unsigned int) u : (unsigned int) u;
+ return(n);
+
+}
+
+/*
+ * Convert the double at the start of p into *val.  Plain decimals with
+ * at most 15 or so significant digits and a small exponent (almost
+ * anything a program prints with %f or %g) are converted exactly with
+ * one multiply or divide; everything else is handed to strtod().
+ * Returns 0 if there was nothing to convert.
+ */
+static int file_input_parse_double(const char *p, double *val)
+{
+
+ static const double p10[] = {
+   1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+ const char *s;
+ char *end;
+ uint64_t m = 0;
+ int neg = 0,digits = 0,exp10 = 0,e = 0,eneg = 0,exact = 1;
+
+ s = p;
+ while(isspace((unsigned char) *s)) s++;
+ if(*s == '-' || *s == '+') neg = (*s++ == '-');
+ for(;isdigit((unsigned char) *s);s++,digits++){
+   if(m >= (1ULL << 53)/10) exact = 0;
+   m = m*10 + (*s - '0');
+ }
+ if(*s == '.'){
+   for(s++;isdigit((unsigned char) *s);s++,digits++,exp10--){
+     if(m >= (1ULL << 53)/10) exact = 0;
+     m = m*10 + (*s - '0');
+   }
+ }
+ if(digits && (*s == 'e' || *s == 'E')){
+   s++;
+   if(*s == '-' || *s == '+') eneg = (*s++ == '-');
+   if(!isdigit((unsigned char) *s)) exact = 0;
+   for(;isdigit((unsigned char) *s);s++){
+     if(e < 1000) e = e*10 + (*s - '0');
+   }
+   exp10 += eneg ? -e : e;
+ }
+
+ if(digits == 0 || !exact || exp10 < -22 || exp10 > 22){
+   *val = strtod(p,&end);
+   return(end != p);
+ }
+ *val = exp10 < 0 ? (double) m/p10[-exp10] : (double) m*p10[exp10];
+ if(neg) *val = -*val;
+ return(1);
+
+}
+
+/*
+ * Read and convert the next rand in the file, according to the "type"
+ * (basically matching scanf type) in its header.
+ */
+static unsigned int file_input_next(file_input_state_t *state)
+{
+
+ unsigned int iret = 0;
+ int ok = 1;
+ double f;
+ char *inbuf;
+
+ if((inbuf = file_input_line(state)) == NULL){
+   fprintf(stderr,"# file_input(): Error: EOF on %s\n",filename);
+   exit(0);
+ }
+
+ switch(filetype){
+   /*
+    * 32 bit unsigned int by assumption
+    */
+   case 'd':
+   case 'i':
+   case 'u':
+     ok = file_input_parse_uint(inbuf,10,&iret);
+     break;
+   /*
+    * double precision floats get converted to 32 bit uint
+    */
+   case 'e':
+   case 'E':
+   case 'f':
+   case 'F':
+   case 'g':
+     ok = file_input_parse_double(inbuf,&f);
+     iret = (uint) (f*UINT_MAX);
+     break;
+   /*
+    * OK, so octal is really pretty silly, but we got it.  Still uint.
+    */
+   case 'o':
+     ok = file_input_parse_uint(inbuf,8,&iret);
+     break;
+   /*
+    * hexadecimal is silly too, but we got it.  uint, of course.
+    */
+   case 'x':
+   case 'X':
+     ok = file_input_parse_uint(inbuf,16,&iret);
+     break;
+   /*
+    * binary is NOT so silly.  Let's do it.  The hard way.  A typical
+    * entry should look like:
+    *    01110101001010100100111101101110
+    */
+   case 'b':
+     iret = bit2uint(inbuf,filenumbits);
+     break;
+   default:
+     fprintf(stderr,"# file_input(): Error. File type %c is not recognized.\n",filetype);
+     exit(0);
+     break;
+ }
+ if(!ok){
+   fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
+   exit(0);
+ }
+
+ return(iret);
+
+}
+
 static unsigned long int file_input_get (void *vstate)
 {
 
  file_input_state_t *state = (file_input_state_t *) vstate;
  unsigned int iret;
- double f;
- char inbuf[K]; /* input buffer */
 
  /*
   * Check that the file is open (via file_input_set()).
@@ -85,79 +297,13 @@ static unsigned long int file_input_get (void *vstate)
  if(state->fp != NULL) {
 
    /*
-	* Read in the next random number from the file
+	* Read in the next random number, from the binary cache if we have
+	* one and from the file itself if we don't.
 	*/
-   if(fgets(inbuf,K,state->fp) == 0){
-	 fprintf(stderr,"# file_input(): Error: EOF on %s\n",filename);
-	 exit(0);
-   }
-   /*
-	* Got one (as we pretty much have to unless the file is badly
-	* broken).  Convert the STRING input above into a uint according to
-	* the "type" (basically matching scanf type).
-	*/
-   switch(filetype){
-	 /*
-	  * 32 bit unsigned int by assumption
-	  */
-	 case 'd':
-	 case 'i':
-	 case 'u':
-	   if(0 == sscanf(inbuf,"%u",&iret)){
-		 fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-		 exit(0);
-	   }
-	   break;
-	 /*
-	  * double precision floats get converted to 32 bit uint
-	  */
-	 case 'e':
-	 case 'E':
-	 case 'f':
-	 case 'F':
-	 case 'g':
-	   if(0 == sscanf(inbuf,"%lg",&f)){
-		 fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-		 exit(0);
-	   }
-	   iret = (uint) f*UINT_MAX;
-	   break;
-	 /*
-	  * OK, so octal is really pretty silly, but we got it.  Still uint.
-	  */
-	 case 'o':
-	   if(0 == sscanf(inbuf,"%o",&iret)){
-		 fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-		 exit(0);
-	   }
-	   break;
-	 /*
-	  * hexadecimal is silly too, but we got it.  uint, of course.
-	  */
-	 case 'x':
-	   if(0 == sscanf(inbuf,"%x",&iret)){
-		 fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-		 exit(0);
-	   }
-	   break;
-	 case 'X':
-	   if(0 == sscanf(inbuf,"%X",&iret)){
-		 fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-		 exit(0);
-	   }
-	   break;
-	 /*
-	  * binary is NOT so silly.  Let's do it.  The hard way.  A typical
-	  * entry should look like:
-	  *    01110101001010100100111101101110
-	  */
-	 case 'b':
-	   iret = bit2uint(inbuf,filenumbits);
-	   break;
-	 default:
-	   fprintf(stderr,"# file_input(): Error. File type %c is not recognized.\n",filetype);
-	   exit(0);
-	   break;
+   if(state->map != NULL){
+     iret = state->map[state->rptr];
+   } else {
+     iret = file_input_next(state);
    }
 
    /*
@@ -166,7 +312,7 @@ static unsigned long int file_input_get (void *vstate)
 	*/
    state->rptr++;
    state->rtot++;
-   if(verbose){
+   if(verbose == D_FILE_INPUT || verbose == D_ALL){
      fprintf(stdout,"# file_input() %lu: %lu/%lu -> %u\n",
              (unsigned long)state->rtot, (unsigned long)state->rptr,
              (unsigned long)state->flen,(uint)iret);
@@ -195,6 +341,144 @@ static double file_input_get_double (void *vstate)
   return file_input_get (vstate) / (double) UINT_MAX;
 }
 
+/*
+ * Parse the header at the top of the file.  We MUST have precisely
+ * three data lines at the beginning after any comments.
+ */
+static void file_input_header(file_input_state_t *state)
+{
+
+ int cnt,numfields;
+ char *line;
+ char inbuf[K]; /* input buffer */
+
+ cnt = 0;
+ while(cnt < 3){
+   if((line = file_input_line(state)) == NULL){
+	 fprintf(stderr,"# file_input(): Error: EOF on %s\n",filename);
+	 exit(0);
+   }
+   strncpy(inbuf,line,K-1);
+   inbuf[K-1] = 0;
+   if(verbose){
+	 fprintf(stdout,"%d: %s\n",cnt,inbuf);
+   }
+
+   /*
+	* Skip comments altogether, whereever they might be.  Also adopt code
+	* to use new, improved, more portable "split()" command.
+	*/
+   if(inbuf[0] != '#'){
+	 /*
+	  * Just like perl, sorta.  In fact, I'm really liking using
+	  * perl-derived utility functions for parsing where I can.
+	  */
+	 numfields = split(inbuf);
+	 if(numfields != 2){
+	   fprintf(stderr,"# file_input(): Error: Wrong number of fields: format is 'fieldname: value'\n");
+	   exit(0);
+	 }
+	 if(strncmp(splitbuf[0],"type",4) == 0){
+	   filetype = splitbuf[1][0];
+	   cnt++;
+	   if(verbose){
+		 fprintf(stdout,"# file_input(): cnt = %d\n",cnt);
+		 fprintf(stdout,"# file_input(): filenumtype set to %c\n",filetype);
+	   }
+	 }
+	 if(strncmp(splitbuf[0],"count",5) == 0){
+	   state->flen = atoi(splitbuf[1]);
+	   filecount = state->flen;
+	   cnt++;
+	   if(verbose){
+		 fprintf(stdout,"# file_input(): cnt = %d\n",cnt);
+		 fprintf(stdout,"# file_input(): state->flen set to %lu\n",(unsigned long)state->flen);
+	   }
+	 }
+	 if(strncmp(splitbuf[0],"numbit",6) == 0){
+	   filenumbits = atoi(splitbuf[1]);
+	   cnt++;
+	   if(verbose){
+		 fprintf(stdout,"# file_input(): cnt = %d\n",cnt);
+		 fprintf(stdout,"# file_input(): filenumbits set to %i\n",filenumbits);
+	   }
+	 }
+   }
+ }
+
+}
+
+/*
+ * Start over at the first rand after the header.
+ */
+static void file_input_rewind(file_input_state_t *state)
+{
+
+ rewind(state->fp);
+ state->bpos = state->bend = 0;
+ file_input_header(state);
+
+}
+
+/*
+ * With -C (file_input_cache), the first run converts the whole file
+ * into a binary cache next to it, filename.raw, and every run (this
+ * one included) reads the rands from that instead of parsing them.
+ * The cache is just the rands as raw uints, so it can also be tested
+ * directly with -g 201.  It is rebuilt whenever it is older than the
+ * file or doesn't hold count rands.  Called with the header just
+ * parsed; if anything goes wrong we simply go on parsing the file.
+ */
+static void file_input_cache_open(file_input_state_t *state)
+{
+
+ char cname[K+8],tname[K+16];
+ struct stat fbuf,cbuf;
+ unsigned int *wbuf;
+ FILE *cfp;
+ off_t i;
+ size_t n;
+ int ok;
+
+ if(state->flen <= 0 || stat(filename,&fbuf) || !S_ISREG(fbuf.st_mode)) return;
+ snprintf(cname,sizeof(cname),"%s.raw",filename);
+
+ if(stat(cname,&cbuf) || cbuf.st_mtime < fbuf.st_mtime ||
+    cbuf.st_size != (off_t) (state->flen*sizeof(uint))){
+   snprintf(tname,sizeof(tname),"%s.tmp",cname);
+   if((cfp = fopen(tname,"w")) == NULL){
+     fprintf(stderr,"# file_input(): Warning: cannot write cache %s, parsing %s\n",tname,filename);
+     return;
+   }
+   if(verbose == D_FILE_INPUT || verbose == D_ALL){
+     fprintf(stdout,"# file_input(): Converting %s to %s\n",filename,cname);
+   }
+   wbuf = (unsigned int *) malloc(PAGE*sizeof(uint));
+   ok = 1;
+   for(i = 0;ok && i < state->flen;i += n){
+     for(n = 0;n < PAGE && i + (off_t) n < state->flen;n++){
+       wbuf[n] = file_input_next(state);
+     }
+     ok = (fwrite(wbuf,sizeof(uint),n,cfp) == n);
+   }
+   free(wbuf);
+   if(fclose(cfp) != 0) ok = 0;
+   if(!ok || rename(tname,cname) != 0){
+     fprintf(stderr,"# file_input(): Warning: cannot write cache %s, parsing %s\n",cname,filename);
+     unlink(tname);
+     file_input_rewind(state);
+     return;
+   }
+   file_input_rewind(state);
+ }
+
+ state->map = file_input_map(cname,state->flen);
+ if(verbose == D_FILE_INPUT || verbose == D_ALL){
+   fprintf(stdout,"# file_input(): %s %s\n",state->map ? "Reading cache" : "Cannot map cache",cname);
+ }
+
+}
+
 
 /*
  * file_input_set() is not yet terriby robust.  For example, it
@@ -206,9 +490,6 @@ static double file_input_get_double (void *vstate)
 static void file_input_set (void *vstate, unsigned long int s)
 {
 
- int cnt,numfields;
- char inbuf[K]; /* input buffer */
-
  file_input_state_t *state = (file_input_state_t *) vstate;
 
  if(verbose == D_FILE_INPUT || verbose == D_ALL){
@@ -228,6 +509,7 @@ static void file_input_set (void *vstate, unsigned long int s)
    }
    /* fclose(state->fp); */
    state->fp = NULL;
+   if(state->map) file_input_unmap(state);
  }
 
  if (state->fp == NULL){
@@ -244,6 +526,10 @@ static void file_input_set (void *vstate, unsigned long int s)
 	 fprintf(stderr,"# file_input(): Error: Cannot open %s, exiting.\n", filename);
 	 exit(0);
    }
+   if(state->buf == NULL){
+	 state->buf = (char *) malloc(FILE_INPUT_BUFSIZE + 1);
+   }
+   state->bpos = state->bend = 0;
 
 
    /*
@@ -269,79 +555,26 @@ static void file_input_set (void *vstate, unsigned long int s)
 	* Rewinding seriously reduces the size of the space being explored.
 	* On the other hand, bombing a test also sucks, especially in a long
 	* -a(ll) run.  Therefore we rewind every time our file pointer reaches
-	* the end of the file or call gsl_rng_set(rng,0).
+	* the end of the file or call gsl_rng_set(rng,0).  From the cache
+	* that is all there is to it.
 	*/
    if(state->rptr >= state->flen){
-	 rewind(state->fp);
 	 state->rptr = 0;
 	 state->rewind_cnt++;
 	 if(verbose == D_FILE_INPUT || verbose == D_ALL){
 	   fprintf(stderr,"# file_input(): Rewinding %s at rtot = %u\n", filename,(uint) state->rtot);
 	   fprintf(stderr,"# file_input(): Rewind count = %u, resetting rptr = %lu\n",state->rewind_cnt, (unsigned long)state->rptr);
 	 }
+	 if(state->map) return;
+	 rewind(state->fp);
+	 state->bpos = state->bend = 0;
    } else {
 	 return;
    }
  }
 
- /*
-  * We MUST have precisely three data lines at the beginning after
-  * any comments.
-  */
- cnt = 0;
- while(cnt < 3){
-   if(state->fp != NULL) {
-	 if(fgets(inbuf,K,state->fp) == 0){
-	   fprintf(stderr,"# file_input(): Error: EOF on %s\n",filename);
-	   exit(0);
-	 }
-   }
-   if(verbose){
-	 fprintf(stdout,"%d: %s",cnt,inbuf);
-   }
-
-   /*
-	* Skip comments altogether, whereever they might be.  Also adopt code
-	* to use new, improved, more portable "split()" command.
-	*/
-   if(inbuf[0] != '#'){
-	 /*
-	  * Just like perl, sorta.  In fact, I'm really liking using
-	  * perl-derived utility functions for parsing where I can.
-	  */
-	 chop(inbuf);
-	 numfields = split(inbuf);
-	 if(numfields != 2){
-	   fprintf(stderr,"# file_input(): Error: Wrong number of fields: format is 'fieldname: value'\n");
-	   exit(0);
-	 }
-	 if(strncmp(splitbuf[0],"type",4) == 0){
-	   filetype = splitbuf[1][0];
-	   cnt++;
-	   if(verbose){
-		 fprintf(stdout,"# file_input(): cnt = %d\n",cnt);
-		 fprintf(stdout,"# file_input(): filenumtype set to %c\n",filetype);
-	   }
-	 }
-	 if(strncmp(splitbuf[0],"count",5) == 0){
-	   state->flen = atoi(splitbuf[1]);
-	   filecount = state->flen;
-	   cnt++;
-	   if(verbose){
-		 fprintf(stdout,"# file_input(): cnt = %d\n",cnt);
-		 fprintf(stdout,"# file_input(): state->flen set to %lu\n",(unsigned long)state->flen);
-	   }
-	 }
-	 if(strncmp(splitbuf[0],"numbit",6) == 0){
-	   filenumbits = atoi(splitbuf[1]);
-	   cnt++;
-	   if(verbose){
-		 fprintf(stdout,"# file_input(): cnt = %d\n",cnt);
-		 fprintf(stdout,"# file_input(): filenumbits set to %i\n",filenumbits);
-	   }
-	 }
-   }
- }
+ file_input_header(state);
+ if(file_input_cache && state->map == NULL) file_input_cache_open(state);
 
  return;
 
@@ -6,6 +6,10 @@
  */
 
 #include <dieharder/libdieharder.h>
+#include <fcntl.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
 
 /*
  * This is a wrapper for getting random numbers in RAW (binary integer)
@@ -14,7 +18,16 @@
  * realloc its required storage as needed, and count as we go.  In this
  * way we can figure out if e.g. a compressed file is sufficiently
  * "random" to make it likely that the compression is good and so on.
+ *
+ * A regular file is mmap'd instead, and we just hand out its words
+ * (and rewind by resetting rptr).  Pipes, devices and anything we
+ * cannot map are still read with fread().
+ */
+
+/*
+ * Files at least this big get a hugepage hint as well.
  */
+#define FILE_INPUT_RAW_HUGE (1UL<<30)
 
 static unsigned long int file_input_raw_get (void *vstate);
 static double file_input_raw_get_double (void *vstate);
@@ -46,12 +59,14 @@ static unsigned long int file_input_raw_get(void *vstate)
  /*
   * Check that the file is open (via file_input_raw_set()).
   */
- if(state->fp != NULL) {
+ if(state->map != NULL || state->fp != NULL) {
 
    /*
     * Read in the next random number from the file
     */
-   if(fread(&iret,sizeof(uint),1,state->fp) != 1){
+   if(state->map != NULL){
+     iret = state->map[state->rptr];
+   } else if(fread(&iret,sizeof(uint),1,state->fp) != 1){
      fprintf(stderr,"# file_input_raw(): Error.  This cannot happen.\n");
      exit(0);
    }
@@ -62,7 +77,7 @@ static unsigned long int file_input_raw_get(void *vstate)
     */
    state->rptr++;
    state->rtot++;
-   if(verbose){
+   if(verbose == D_FILE_INPUT_RAW || verbose == D_ALL){
      fprintf(stdout,"# file_input() %u: %u/%u -> %u\n",(uint)state->rtot,(uint)state->rptr,(uint)state->flen,(uint)iret);
    }
 
@@ -89,6 +104,83 @@ static double file_input_raw_get_double (void *vstate)
   return file_input_raw_get (vstate) / (double) UINT_MAX;
 }
 
+/*
+ * Bulk fill (see rng_fill.h).  From a mapped file this is a memcpy()
+ * up to the end of the file, a rewind, and so on.
+ */
+void file_input_raw_fill_u32(void *vstate, unsigned int *buf, size_t n)
+{
+
+ file_input_state_t *state = (file_input_state_t *) vstate;
+ size_t i,chunk;
+
+ if(state->map == NULL || verbose == D_FILE_INPUT_RAW || verbose == D_ALL){
+   for(i=0;i<n;i++){
+     buf[i] = file_input_raw_get(vstate);
+   }
+   return;
+ }
+
+ while(n){
+   chunk = state->flen - state->rptr;
+   if(chunk > n) chunk = n;
+   memcpy(buf,state->map + state->rptr,chunk*sizeof(uint));
+   buf += chunk;
+   n -= chunk;
+   state->rptr += chunk;
+   state->rtot += chunk;
+   if(state->rptr == state->flen){
+     file_input_raw_set(vstate, 0);
+   }
+ }
+
+}
+
+/*
+ * Map the first nwords words of the (regular) file name.  Returns NULL
+ * if we can't, in which case the caller just falls back on fread().
+ * file_input uses this for its binary cache as well.
+ */
+const unsigned int *file_input_map(const char *name, off_t nwords)
+{
+
+ void *map = NULL;
+#if !defined(_WIN32)
+ size_t len;
+ int fd;
+
+ len = (size_t) nwords*sizeof(uint);
+ if((fd = open(name,O_RDONLY)) < 0) return(NULL);
+ map = mmap(NULL,len,PROT_READ,MAP_PRIVATE,fd,0);
+ close(fd);
+ if(map == MAP_FAILED) return(NULL);
+
+ /*
+  * We read it front to back, and perhaps many times over.  These are
+  * only hints, so we don't care if they fail.
+  */
+ madvise(map,len,MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+ if(len >= FILE_INPUT_RAW_HUGE) madvise(map,len,MADV_HUGEPAGE);
+#endif
+ if(verbose == D_FILE_INPUT_RAW || verbose == D_ALL){
+   fprintf(stdout,"# file_input_raw(): Mapped %s, %lu bytes.\n",name,(unsigned long) len);
+ }
+#endif
+ return((const unsigned int *) map);
+
+}
+
+void file_input_unmap(file_input_state_t *state)
+{
+
+#if !defined(_WIN32)
+ munmap((void *) state->map,(size_t) state->flen*sizeof(uint));
+#endif
+ state->map = NULL;
+
+}
+
 
 /*
  * file_input_raw_set() is very simple.  If the file hasn't been opened
@@ -127,6 +219,7 @@ static void file_input_raw_set (void *vstate, unsigned long int s)
     * correctly opens later.
     */
    state->fp = NULL;
+   state->map = NULL;
 
    if(stat(filename, &sbuf)){
      if(errno == EBADF){
@@ -175,15 +268,19 @@ static void file_input_raw_set (void *vstate, unsigned long int s)
   * of anything else forces a close (resetting rewind_cnt) followed
   * by a reopen.
   */
- if(state->fp && s ) {
+ if((state->fp || state->map) && s ) {
    if(verbose == D_FILE_INPUT || verbose == D_ALL){
      fprintf(stdout,"# file_input(): Closing/reopening/resetting %s\n",filename);
    }
-   fclose(state->fp);
-   state->fp = NULL;
+   if(state->map){
+     file_input_unmap(state);
+   } else {
+     fclose(state->fp);
+     state->fp = NULL;
+   }
  }
 
- if (state->fp == NULL){
+ if (state->fp == NULL && state->map == NULL){
    if(verbose == D_FILE_INPUT_RAW || verbose == D_ALL){
      fprintf(stdout,"# file_input_raw(): Opening %s\n", filename);
    }
@@ -193,7 +290,8 @@ static void file_input_raw_set (void *vstate, unsigned long int s)
     * length.  We can now open it.  The test catches all other conditions
     * that might keep the file from reading, e.g. permissions.
     */
-   if ((state->fp = fopen(filename,"r")) == NULL) {
+   if(state->flen) state->map = file_input_map(filename,state->flen);
+   if (state->map == NULL && (state->fp = fopen(filename,"r")) == NULL) {
      fprintf(stderr,"# file_input_raw(): Error: Cannot open %s, exiting.\n", filename);
      exit(0);
    }
@@ -223,7 +321,7 @@ static void file_input_raw_set (void *vstate, unsigned long int s)
     * the end of the file or call gsl_rng_set(rng,0).
     */
    if(state->flen && state->rptr >= state->flen){
-     rewind(state->fp);
+     if(state->fp) rewind(state->fp);
      state->rptr = 0;
      state->rewind_cnt++;
      if(verbose == D_FILE_INPUT_RAW || verbose == D_ALL){
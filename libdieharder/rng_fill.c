@@ -0,0 +1,85 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * fill_u32() (see rng_fill.h) and the table of generators that have
+ * a native bulk fill.  A generator that isn't in the table works
+ * exactly as before, one gsl_rng_get() at a time.
+ *========================================================================
+ */
+
+#undef VERSION
+#include "config.h"
+#include <dieharder/libdieharder.h>
+
+static const rng_fill_type rng_fills[] = {
+ {&gsl_rng_wyrand, wyrand_fill_u32},
+ {&gsl_rng_xoshiro128_pp, xoshiro128_pp_fill_u32},
+ {&gsl_rng_xoshiro128_ss, xoshiro128_ss_fill_u32},
+ {&gsl_rng_xoshiro128_p, xoshiro128_p_fill_u32},
+ {&gsl_rng_xoroshiro64_ss, xoroshiro64_ss_fill_u32},
+ {&gsl_rng_xoroshiro64_s, xoroshiro64_s_fill_u32},
+ {&gsl_rng_philox2x32, philox2x32_fill_u32},
+ {&gsl_rng_philox4x32, philox4x32_fill_u32},
+ {&gsl_rng_threefry2x32, threefry2x32_fill_u32},
+ {&gsl_rng_threefry4x32, threefry4x32_fill_u32},
+ {&gsl_rng_chacha, chacha_fill_u32},
+ {&gsl_rng_aesni, aesni_fill_u32},
+#ifndef HAVE_32BITLONG
+ {&gsl_rng_philox2x64, philox2x64_fill_u32},
+ {&gsl_rng_philox4x64, philox4x64_fill_u32},
+ {&gsl_rng_threefry2x64, threefry2x64_fill_u32},
+ {&gsl_rng_threefry4x64, threefry4x64_fill_u32},
+ {&gsl_rng_xoshiro256_pp, xoshiro256_pp_fill_u32},
+ {&gsl_rng_xoshiro256_ss, xoshiro256_ss_fill_u32},
+ {&gsl_rng_xoshiro256_p, xoshiro256_p_fill_u32},
+ {&gsl_rng_xoroshiro128_pp, xoroshiro128_pp_fill_u32},
+ {&gsl_rng_xoroshiro128_ss, xoroshiro128_ss_fill_u32},
+ {&gsl_rng_xoroshiro128_p, xoroshiro128_p_fill_u32},
+ {&gsl_rng_romuduojr, romuduojr_fill_u32},
+ {&gsl_rng_romuduo, romuduo_fill_u32},
+ {&gsl_rng_romutrio, romutrio_fill_u32},
+ {&gsl_rng_romuquad, romuquad_fill_u32},
+#endif
+ {&gsl_rng_splitmix64, splitmix64_fill_u32},
+ {&gsl_rng_file_input_raw, file_input_raw_fill_u32},
+ {&gsl_rng_stdin_input_raw, stdin_input_raw_fill_u32},
+ {NULL, NULL}
+};
+
+/*
+ * Return the native fill for type, or NULL if it doesn't have one.
+ */
+rng_fill_u32_t rng_get_fill_u32(const gsl_rng_type *type)
+{
+
+ const rng_fill_type *f;
+
+ for(f = rng_fills;f->type != NULL;f++){
+   if(*f->type == type) return(f->fill_u32);
+ }
+ return(NULL);
+
+}
+
+void fill_u32(gsl_rng *rng, unsigned int *buf, size_t n)
+{
+
+ rng_fill_u32_t fill;
+ size_t i;
+
+ fill = rng_get_fill_u32(rng->type);
+ if(fill != NULL){
+   fill(rng->state,buf,n);
+   return;
+ }
+
+ for(i=0;i<n;i++){
+   buf[i] = gsl_rng_get(rng);
+ }
+
+}
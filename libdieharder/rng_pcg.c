@@ -90,6 +90,27 @@ static const gsl_rng_type pcg32_type =
 
 const gsl_rng_type *gsl_rng_pcg32 = &pcg32_type;
 
+/* Jump n steps ahead (see rng_discard.h), Brown's "arbitrary stride"
+   LCG advance in O(log n), as pcg_advance_lcg_128() below. */
+void pcg32_discard(void *vstate, uint64_t n)
+{
+  pcg32_random_t* rng = (pcg32_random_t*) vstate;
+  uint64_t cur_mult = 6364136223846793005ULL;
+  uint64_t cur_plus = rng->inc|1;
+  uint64_t acc_mult = 1u;
+  uint64_t acc_plus = 0u;
+  while (n > 0) {
+    if (n & 1) {
+      acc_mult *= cur_mult;
+      acc_plus = acc_plus * cur_mult + cur_plus;
+    }
+    cur_plus = (cur_mult + 1) * cur_plus;
+    cur_mult *= cur_mult;
+    n /= 2;
+  }
+  rng->state = acc_mult * rng->state + acc_plus;
+}
+
 #if defined(HAVE_UINT128_T) && !defined(HAVE_32BITLONG)
 
 /* pcg64: avoid emulated 128bit math for now. gcc/clang 64bit only */
@@ -169,7 +190,7 @@ pcg_setseq_128_xsl_rr_64_boundedrand_r(pcg_state_setseq_128* rng,
     }
 }
 
-// unused
+// used by the pcg64 discards
 static pcg128_t pcg_advance_lcg_128(pcg128_t state, pcg128_t delta, pcg128_t cur_mult,
                                     pcg128_t cur_plus)
 {
@@ -238,6 +259,11 @@ static const gsl_rng_type pcg64_type =
 
 const gsl_rng_type *gsl_rng_pcg64 = &pcg64_type;
 
+void pcg64_discard(void *vstate, uint64_t n)
+{
+  pcg64_advance_r((pcg64_random_t*) vstate, n);
+}
+
 /* pcg64_cmdxsm cheap multiplier with a 64bit DXSM mixer.
    This is also called PCG64 variant 2.0.
  */
@@ -309,6 +335,13 @@ static const gsl_rng_type pcg64_cmdxsm_type =
  &pcg64_cmdxsm_get_double};
 const gsl_rng_type *gsl_rng_pcg64_cmdxsm = &pcg64_cmdxsm_type;
 
+void pcg64_cmdxsm_discard(void *vstate, uint64_t n)
+{
+  pcg64_random_t* rng = (pcg64_random_t*) vstate;
+  rng->state = pcg_advance_lcg_128(rng->state, n,
+                                   PCG_CHEAP_MULTIPLIER_128, rng->inc);
+}
+
 /* pcg64_dxsm with a strong 128bit DXSM mixer.
  */
 static inline void pcg64_dxsm_srandom_r(pcg_state_setseq_128* rng,
@@ -350,4 +383,9 @@ static const gsl_rng_type pcg64_dxsm_type =
  &pcg64_dxsm_get_double};
 const gsl_rng_type *gsl_rng_pcg64_dxsm = &pcg64_dxsm_type;
 
+void pcg64_dxsm_discard(void *vstate, uint64_t n)
+{
+  pcg64_advance_r((pcg64_random_t*) vstate, n);
+}
+
 #endif
@@ -35,7 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #undef VERSION
 #include "config.h"
 #include <assert.h>
-//#include "cpu_features.h"
+#include "cpu_features.h"
 
 #define R123_ASSERT(x) assert(x)
 #define R123_STATIC_ASSERT(x,y) assert(x)
@@ -411,6 +411,80 @@ _philoxNxW_tpl(2, 1, 64, uint64_t)    /* philox2x64bijection */
 _philoxNxW_tpl(4, 2, 64, uint64_t)    /* philox4x64bijection */
 #endif /* R123_USE_PHILOX_64BIT */
 
+/*
+ * Multi-lane Philox.  A round is a 32x32->64 bit multiply and some xors,
+ * so the templates above instantiated on a GCC vector type (see
+ * cpu_features.h) run a whole vector of counters at once, one block per
+ * lane, given a vector mulhilo:  vpmuludq multiplies the even lanes, a
+ * second one the odd lanes shifted down, and blends put the low and
+ * high halves back together.  V is y32 (AVX2, 8 lanes) or z32 (AVX-512,
+ * 16 lanes).  There is no vector 64x64->128 multiply, so the 64 bit
+ * Philoxes stay scalar.  The 4x round template initializes with a scalar
+ * 0, which a vector can't take, hence its own copy here.
+ */
+#define _philox4xVround_tpl(V)                                          \
+static inline struct r123array4x##V _philox4x##V##round(struct r123array4x##V ctr, struct r123array2x##V key){ \
+    uint##V##_t hi0, hi1;                                               \
+    uint##V##_t lo0 = mulhilo##V(PHILOX_M4x32_0, ctr.v[0], &hi0);       \
+    uint##V##_t lo1 = mulhilo##V(PHILOX_M4x32_1, ctr.v[2], &hi1);       \
+    struct r123array4x##V out = {{hi1^ctr.v[1]^key.v[0], lo1,           \
+                                  hi0^ctr.v[3]^key.v[1], lo0}};         \
+    return out;                                                         \
+}
+
+#define PHILOX_M2xy32_0 PHILOX_M2x32_0
+#define PHILOX_M2xz32_0 PHILOX_M2x32_0
+#define PHILOX_Wy32_0 PHILOX_W32_0
+#define PHILOX_Wy32_1 PHILOX_W32_1
+#define PHILOX_Wz32_0 PHILOX_W32_0
+#define PHILOX_Wz32_1 PHILOX_W32_1
+#define PHILOX2xy32_DEFAULT_ROUNDS PHILOX2x32_DEFAULT_ROUNDS
+#define PHILOX4xy32_DEFAULT_ROUNDS PHILOX4x32_DEFAULT_ROUNDS
+#define PHILOX2xz32_DEFAULT_ROUNDS PHILOX2x32_DEFAULT_ROUNDS
+#define PHILOX4xz32_DEFAULT_ROUNDS PHILOX4x32_DEFAULT_ROUNDS
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#define PHILOX_SIMD_Y 1
+static inline uinty32_t mulhiloy32(uint32_t a, uinty32_t b, uinty32_t *hip)
+{
+    const __m256i am = _mm256_set1_epi32(a);
+    __m256i even = _mm256_mul_epu32(am, (__m256i)b);
+    __m256i odd = _mm256_mul_epu32(am, _mm256_srli_epi64((__m256i)b, 32));
+    *hip = (uinty32_t)_mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+    return (uinty32_t)_mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+}
+_r123array_tpl(1, y32, uinty32_t)
+_r123array_tpl(2, y32, uinty32_t)
+_r123array_tpl(4, y32, uinty32_t)
+_philox2xWbumpkey_tpl(y32)
+_philox4xWbumpkey_tpl(y32)
+_philox2xWround_tpl(y32, uinty32_t)
+_philox4xVround_tpl(y32)
+_philoxNxW_tpl(2, 1, y32, uinty32_t)
+_philoxNxW_tpl(4, 2, y32, uinty32_t)
+#endif
+
+#if defined(__GNUC__) && defined(__AVX512F__)
+#define PHILOX_SIMD_Z 1
+static inline uintz32_t mulhiloz32(uint32_t a, uintz32_t b, uintz32_t *hip)
+{
+    const __m512i am = _mm512_set1_epi32(a);
+    __m512i even = _mm512_mul_epu32(am, (__m512i)b);
+    __m512i odd = _mm512_mul_epu32(am, _mm512_srli_epi64((__m512i)b, 32));
+    *hip = (uintz32_t)_mm512_mask_blend_epi32(0xaaaa, _mm512_srli_epi64(even, 32), odd);
+    return (uintz32_t)_mm512_mask_blend_epi32(0xaaaa, even, _mm512_slli_epi64(odd, 32));
+}
+_r123array_tpl(1, z32, uintz32_t)
+_r123array_tpl(2, z32, uintz32_t)
+_r123array_tpl(4, z32, uintz32_t)
+_philox2xWbumpkey_tpl(z32)
+_philox4xWbumpkey_tpl(z32)
+_philox2xWround_tpl(z32, uintz32_t)
+_philox4xVround_tpl(z32)
+_philoxNxW_tpl(2, 1, z32, uintz32_t)
+_philoxNxW_tpl(4, 2, z32, uintz32_t)
+#endif
+
 #define philox2x32(c,k) philox2x32_R(philox2x32_rounds, c, k)
 #define philox4x32(c,k) philox4x32_R(philox4x32_rounds, c, k)
 #if R123_USE_PHILOX_64BIT
@@ -589,6 +663,76 @@ _philoxNxW_advance_tpl(2, 64)
 _philoxNxW_advance_tpl(4, 64)
 #endif
 
+/*
+ * Bulk fills (see rng_fill.h).  Whatever is left in the buffer goes
+ * first, then whole runs of blocks from the widest multi-lane kernel
+ * the CPU can run (lane j encrypting counter ctr+1+j, as the next blocks
+ * philoxNxW_next() would), then the rest one at a time.  64 bit words
+ * are truncated to unsigned int just as gsl_rng_get() into one is.
+ */
+#define _philoxNxW_blocks_tpl(N, W, V)                                    \
+static void philox##N##x##V##_blocks(philox##N##x##W##_state *s, unsigned int *buf) \
+{                                                                         \
+  enum { lanes = sizeof(uint##V##_t) / sizeof(uint##W##_t) };             \
+  philox##N##x##V##_ctr_t c, x;                                           \
+  philox##N##x##V##_key_t k;                                              \
+  int i, j;                                                               \
+  for (j = 0; j < lanes; j++) {                                           \
+    i = 0;                                                                \
+    do {                                                                  \
+      s->ctr.v[i++]++;                                                    \
+    } while (s->ctr.v[i-1] == 0 && i < N);                                \
+    for (i = 0; i < N; i++) c.v[i][j] = s->ctr.v[i];                      \
+  }                                                                       \
+  for (i = 0; i < N/2; i++) k.v[i] = (uint##V##_t){0} + s->key.v[i];      \
+  x = philox##N##x##V##_R(philox##N##x##V##_rounds, c, k);                \
+  for (j = 0; j < lanes; j++)                                             \
+    for (i = 0; i < N; i++) buf[j*N + i] = x.v[i][j];                     \
+}
+
+#ifdef PHILOX_SIMD_Y
+_philoxNxW_blocks_tpl(2, 32, y32)
+_philoxNxW_blocks_tpl(4, 32, y32)
+#define _philox_fill_y(N)                                              \
+  if (x86_simd_level() >= X86_SIMD_AVX2) {                     \
+    for (; i + 8*N <= n; i += 8*N)                                        \
+      philox##N##xy32_blocks(&state->state.state##N##x32, buf + i);       \
+  }
+#else
+#define _philox_fill_y(N)
+#endif
+
+#ifdef PHILOX_SIMD_Z
+_philoxNxW_blocks_tpl(2, 32, z32)
+_philoxNxW_blocks_tpl(4, 32, z32)
+#define _philox_fill_z(N)                                              \
+  if (x86_simd_level() >= X86_SIMD_AVX512) {                   \
+    for (; i + 16*N <= n; i += 16*N)                                      \
+      philox##N##xz32_blocks(&state->state.state##N##x32, buf + i);       \
+  }
+#else
+#define _philox_fill_z(N)
+#endif
+
+#define _philoxNxW_fill_tpl(N, W, FILL)                                   \
+void philox##N##x##W##_fill_u32(void *vstate, unsigned int *buf, size_t n) \
+{                                                                         \
+  philox_all_t *state = (philox_all_t*) vstate;                           \
+  size_t i = 0;                                                           \
+  while (i < n && state->buffer_pos < N)                                  \
+    buf[i++] = (unsigned int)philox##N##x##W##_next(state);               \
+  FILL                                                                    \
+  for (; i < n; i++)                                                      \
+    buf[i] = (unsigned int)philox##N##x##W##_next(state);                 \
+}
+
+_philoxNxW_fill_tpl(2, 32, _philox_fill_z(2) _philox_fill_y(2))
+_philoxNxW_fill_tpl(4, 32, _philox_fill_z(4) _philox_fill_y(4))
+#if R123_USE_PHILOX_64BIT
+_philoxNxW_fill_tpl(2, 64, )
+_philoxNxW_fill_tpl(4, 64, )
+#endif
+
 /*
 #define _philoxNxW_next_extern_tpl(N, W)                                 \
 extern inline uint64_t philox##N##x##W##_next64(philox_all_t *state);    \
@@ -603,13 +747,56 @@ _philoxNxW_next_extern_tpl(4, 64)
 #endif
 */
 
+/*
+ * Discard (see rng_discard.h).  Use up what is left in the buffer, add
+ * the number of whole blocks skipped to the multiword counter, and
+ * regenerate the buffer at the block the discard ends in.
+ */
+#define _philoxNxW_discard_tpl(N, W)                                             \
+void philox##N##x##W##_discard(void *vstate, uint64_t n) {                       \
+  philox_all_t *state = (philox_all_t*) vstate;                                 \
+  int i;                                                                      \
+  uint64_t avail, blocks, add;                                                \
+  uint##W##_t a, sum, carry;                                                  \
+  philox##N##x##W##_ctr_t ct;                                                  \
+  avail = N - state->buffer_pos;                                              \
+  if (n <= avail) {                                                           \
+    state->buffer_pos += n;                                                   \
+    return;                                                                   \
+  }                                                                           \
+  n -= avail;                                                                 \
+  blocks = (n + N - 1) / N;                                                   \
+  add = blocks;                                                               \
+  carry = 0;                                                                  \
+  for (i = 0; i < N; i++) {                                                   \
+    a = (uint##W##_t)add;                                                     \
+    sum = state->state.state##N##x##W.ctr.v[i] + a;                           \
+    state->state.state##N##x##W.ctr.v[i] = sum + carry;                       \
+    carry = (sum < a) | (sum + carry < carry);                                \
+    add = (W == 64) ? 0 : add >> (W % 64);                                    \
+  }                                                                           \
+  ct = philox##N##x##W(state->state.state##N##x##W.ctr, state->state.state##N##x##W.key); \
+  for (i = 0; i < N; i++) {                                                   \
+    state->buffer[i].u##W = ct.v[i];                                          \
+  }                                                                           \
+  state->buffer_pos = n - (blocks - 1) * N;                                   \
+}
+
+_philoxNxW_discard_tpl(2, 32)
+_philoxNxW_discard_tpl(4, 32)
+#if R123_USE_PHILOX_64BIT
+_philoxNxW_discard_tpl(2, 64)
+_philoxNxW_discard_tpl(4, 64)
+#endif
+
 #define _philoxNxW_get(N, W, MAX)                                       \
 static void philox##N##x##W##_set(void *vstate, unsigned long int seed) \
 {                                                                       \
   philox_all_t* state = (philox_all_t*) vstate;                         \
   uint##W##_t steps[N];                                                 \
+  memset(state, 0, sizeof(*state));                                     \
   steps[0] = (uint##W##_t)seed;                                         \
-  for (unsigned i = i; i < N; i++)                                      \
+  for (unsigned i = 1; i < N; i++)                                      \
     steps[i] = 0;                                                       \
   philox##N##x##W##_advance(state, steps, 1);                           \
 }                                                                       \
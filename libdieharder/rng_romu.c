@@ -209,6 +209,25 @@ romuquad_set (void *vstate, unsigned long int seed)
  return;
 }
 
+/*
+ * Bulk fills (see rng_fill.h).  The generator runs on a local copy of
+ * the state, which the compiler can keep in registers.  Like
+ * gsl_rng_get() into an unsigned int, they keep the low 32 bits.
+ */
+#define RNG_FILL(n) \
+void n##_fill_u32 (void *vstate, unsigned int *buf, size_t len) \
+{ \
+  romu_state_t state = *(romu_state_t *)vstate; \
+  size_t i; \
+  for(i=0;i<len;i++) buf[i] = (unsigned int)n##_next64(&state); \
+  *(romu_state_t *)vstate = state; \
+}
+
+RNG_FILL (romuduojr)
+RNG_FILL (romuduo)
+RNG_FILL (romutrio)
+RNG_FILL (romuquad)
+
 static const gsl_rng_type romuduojr_type =
 {"romuduojr",			/* name */
  UINT64_MAX,			/* RAND_MAX */
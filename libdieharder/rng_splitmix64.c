@@ -46,6 +46,30 @@ static double splitmix_get_double (void *vstate)
   return TO_DOUBLE(splitmix64_next (&state->x));
 }
 
+/*
+ * Bulk fill (see rng_fill.h), keeping the low 32 bits of each return
+ * just as gsl_rng_get() into an unsigned int does.
+ */
+void splitmix64_fill_u32 (void *vstate, unsigned int *buf, size_t n)
+{
+  uint64_t x = ((splitmix_state_t*)vstate)->x;
+  size_t i;
+
+  for(i=0;i<n;i++){
+    buf[i] = (unsigned int)splitmix64_next (&x);
+  }
+  ((splitmix_state_t*)vstate)->x = x;
+}
+
+/*
+ * Discard (see rng_discard.h):  the state is a Weyl sequence, so n
+ * steps is n times the increment.
+ */
+void splitmix64_discard (void *vstate, uint64_t n)
+{
+  ((splitmix_state_t*)vstate)->x += n * UINT64_C(0x9e3779b97f4a7c15);
+}
+
 static const gsl_rng_type splitmix64_type =
 {"splitmix64",
  RNG64_MAX,			/* RAND_MAX */
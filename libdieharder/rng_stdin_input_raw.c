@@ -1,28 +1,240 @@
+#define _XOPEN_SOURCE 600       /* for posix_memalign() */
+#undef VERSION
+#include "config.h"
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dieharder/libdieharder.h>
+#if defined(HAVE_PTHREAD) && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#define STDIN_THREAD 1
+#endif
 
 /*
  * This is a wrapping of stdin.
+ *
+ * With pthreads, a reader thread read()s fd 0 into a ring of large
+ * buffers while the tests consume the ones already filled, so a fast
+ * producer on the other end of the pipe isn't held back by a stdio
+ * call per rand.  The rands come out in exactly the same order.  The
+ * only locking is when we move on to the next buffer and find it
+ * isn't there yet (or, for the reader, that all of them are full).
+ *
+ * At exit we report how fast the pipe delivered, and how long the
+ * tests sat waiting on it.
  */
 
+static void stdin_input_raw_eof (int err)
+{
+  if (err == 0) {
+      fprintf(stderr,"# stdin_input_raw(): Error: EOF\n");
+  } else {
+      fprintf(stderr,"# stdin_input_raw(): Error: %s\n", strerror(err));
+  }
+  exit(0);
+}
+
+#ifdef STDIN_THREAD
+
+#define STDIN_NBUF 4                  /* Buffers in the ring */
+#define STDIN_BUFSIZE (1 << 20)       /* Bytes per buffer */
+
+static struct {
+  unsigned char *buf[STDIN_NBUF];
+  size_t len[STDIN_NBUF];             /* Bytes (whole words) in buf[i] */
+  unsigned long head;                 /* Buffers filled so far */
+  unsigned long tail;                 /* Buffers used up so far */
+  int done;                           /* The reader has hit EOF; no buffers after head */
+  int err;                            /* errno that ended the read, or 0 */
+  pthread_mutex_t lock;               /* Only to sleep on cond */
+  pthread_cond_t cond;
+  int started;
+  /* The consumer's place in buf[tail % STDIN_NBUF] */
+  const unsigned int *words;
+  size_t nwords;
+  size_t wpos;
+  /* For the report */
+  double bytes;
+  double wait;
+  struct timeval start;
+} ring = {.lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER};
+
+static double stdin_elapsed (struct timeval *tv)
+{
+  struct timeval now;
+
+  gettimeofday(&now,NULL);
+  return (now.tv_sec - tv->tv_sec) + 1.0e-6*(now.tv_usec - tv->tv_usec);
+}
+
+static void stdin_wake (void)
+{
+  pthread_mutex_lock(&ring.lock);
+  pthread_cond_broadcast(&ring.cond);
+  pthread_mutex_unlock(&ring.lock);
+}
+
+static void *stdin_reader (UNUSED_PARAM void *arg)
+{
+  unsigned long head;
+  unsigned char *p;
+  size_t got;
+  ssize_t n;
+  int eof = 0;
+
+  for (head = 0;;head++) {
+
+    /*
+     * Wait for a free buffer.
+     */
+    if (head - __atomic_load_n(&ring.tail,__ATOMIC_ACQUIRE) == STDIN_NBUF) {
+      pthread_mutex_lock(&ring.lock);
+      while (head - __atomic_load_n(&ring.tail,__ATOMIC_ACQUIRE) == STDIN_NBUF) {
+        pthread_cond_wait(&ring.cond,&ring.lock);
+      }
+      pthread_mutex_unlock(&ring.lock);
+    }
+
+    p = ring.buf[head % STDIN_NBUF];
+    got = 0;
+    while (got < STDIN_BUFSIZE) {
+      n = read(0,p + got,STDIN_BUFSIZE - got);
+      if (n > 0) {
+        got += n;
+      } else if (n == 0) {
+        eof = 1;
+        break;
+      } else if (errno != EINTR) {
+        ring.err = errno;
+        eof = 1;
+        break;
+      }
+    }
+    ring.bytes += got;
+
+    /*
+     * A trailing partial word is dropped, just as fread() would.
+     */
+    ring.len[head % STDIN_NBUF] = got - got % sizeof(unsigned int);
+    __atomic_store_n(&ring.head,head + 1,__ATOMIC_RELEASE);
+    if (eof) __atomic_store_n(&ring.done,1,__ATOMIC_RELEASE);
+    stdin_wake();
+    if (eof) return NULL;
+  }
+}
+
+static void stdin_input_raw_report (void)
+{
+  double t = stdin_elapsed(&ring.start);
+
+  fprintf(stderr,"# stdin_input_raw(): read %.1f MB in %.2f seconds (%.1f MB/s), %.2f seconds waiting on the pipe\n",
+          ring.bytes/1.0e6,t,t > 0.0 ? ring.bytes/1.0e6/t : 0.0,ring.wait);
+}
+
+static void stdin_start (void)
+{
+  pthread_t tid;
+  int i;
+
+  for (i = 0;i < STDIN_NBUF;i++) {
+    if (posix_memalign((void **) &ring.buf[i],4096,STDIN_BUFSIZE) != 0) {
+      stdin_input_raw_eof(ENOMEM);
+    }
+  }
+  gettimeofday(&ring.start,NULL);
+  ring.started = 1;
+  if (pthread_create(&tid,NULL,stdin_reader,NULL) != 0) {
+    fprintf(stderr,"# stdin_input_raw(): Error: cannot start reader thread\n");
+    exit(0);
+  }
+  pthread_detach(tid);
+  atexit(stdin_input_raw_report);
+}
+
+/*
+ * Hand buf[tail] back to the reader and wait for the next one.
+ */
+static void stdin_next (void)
+{
+  struct timeval tv;
+  unsigned long tail;
+
+  if (!ring.started) {
+    stdin_start();
+    tail = 0;
+  } else {
+    tail = ring.tail + 1;
+    __atomic_store_n(&ring.tail,tail,__ATOMIC_RELEASE);
+    stdin_wake();
+  }
+
+  if (__atomic_load_n(&ring.head,__ATOMIC_ACQUIRE) == tail) {
+    gettimeofday(&tv,NULL);
+    pthread_mutex_lock(&ring.lock);
+    while (__atomic_load_n(&ring.head,__ATOMIC_ACQUIRE) == tail &&
+           !__atomic_load_n(&ring.done,__ATOMIC_ACQUIRE)) {
+      pthread_cond_wait(&ring.cond,&ring.lock);
+    }
+    pthread_mutex_unlock(&ring.lock);
+    ring.wait += stdin_elapsed(&tv);
+    if (__atomic_load_n(&ring.head,__ATOMIC_ACQUIRE) == tail) stdin_input_raw_eof(ring.err);
+  }
+
+  ring.words = (const unsigned int *) ring.buf[tail % STDIN_NBUF];
+  ring.nwords = ring.len[tail % STDIN_NBUF]/sizeof(unsigned int);
+  ring.wpos = 0;
+  if (ring.nwords == 0) stdin_input_raw_eof(ring.err);
+}
+
+static unsigned long int
+stdin_input_raw_get (UNUSED_PARAM void *vstate)
+{
+  if (ring.wpos == ring.nwords) stdin_next();
+  return ring.words[ring.wpos++];
+}
+
+/*
+ * Bulk fill (see rng_fill.h), a buffer at a time.
+ */
+void stdin_input_raw_fill_u32 (UNUSED_PARAM void *vstate, unsigned int *buf, size_t n)
+{
+  size_t chunk;
+
+  while (n) {
+    if (ring.wpos == ring.nwords) stdin_next();
+    chunk = ring.nwords - ring.wpos;
+    if (chunk > n) chunk = n;
+    memcpy(buf,ring.words + ring.wpos,chunk*sizeof(unsigned int));
+    ring.wpos += chunk;
+    buf += chunk;
+    n -= chunk;
+  }
+}
+
+#else
+
 static unsigned long int
 stdin_input_raw_get (UNUSED_PARAM void *vstate)
 {
   unsigned int j;
   if (fread(&j,sizeof(j),1,stdin) != 1) {
-      if (feof(stdin)) {
-          fprintf(stderr,"# stdin_input_raw(): Error: EOF\n");
-      } else {
-          fprintf(stderr,"# stdin_input_raw(): Error: %s\n", strerror(errno));
-      }
-      exit(0);
+      stdin_input_raw_eof(feof(stdin) ? 0 : errno);
   }
   /* printf("raw: %10u\n",j); */
   return j;
 }
 
+void stdin_input_raw_fill_u32 (void *vstate, unsigned int *buf, size_t n)
+{
+  size_t i;
+
+  for (i = 0;i < n;i++) {
+    buf[i] = stdin_input_raw_get(vstate);
+  }
+}
+
+#endif
+
 static double
 stdin_input_raw_get_double (void *vstate)
 {
@@ -38,6 +38,7 @@
 #include "config.h"
 #include <dieharder/libdieharder.h>
 #include <assert.h>
+#include "cpu_features.h"
 
 #ifndef HAVE_32BITLONG
 #define R123_USE_64BIT 1
@@ -866,6 +867,72 @@ _threefry2x_tpl(64)
 _threefry4x_tpl(64)
 #endif
 
+/*
+ * Multi-lane Threefry.  The rounds are nothing but adds, rotates and
+ * xors, so the very same templates instantiated on a GCC vector type
+ * (see cpu_features.h) encrypt a whole vector of counters at once, one
+ * block per lane, and give exactly what the scalar code gives one block
+ * at a time.  V is the vector "word":  y32/y64 for AVX2 (8 or 4 lanes),
+ * z32/z64 for AVX-512 (16 or 8 lanes).
+ */
+#define _threefry_simd_alias_tpl(V, W)                                  \
+enum r123_enum_threefry_rot##V {                                        \
+    R_##V##x4_0_0=R_##W##x4_0_0, R_##V##x4_0_1=R_##W##x4_0_1,           \
+    R_##V##x4_1_0=R_##W##x4_1_0, R_##V##x4_1_1=R_##W##x4_1_1,           \
+    R_##V##x4_2_0=R_##W##x4_2_0, R_##V##x4_2_1=R_##W##x4_2_1,           \
+    R_##V##x4_3_0=R_##W##x4_3_0, R_##V##x4_3_1=R_##W##x4_3_1,           \
+    R_##V##x4_4_0=R_##W##x4_4_0, R_##V##x4_4_1=R_##W##x4_4_1,           \
+    R_##V##x4_5_0=R_##W##x4_5_0, R_##V##x4_5_1=R_##W##x4_5_1,           \
+    R_##V##x4_6_0=R_##W##x4_6_0, R_##V##x4_6_1=R_##W##x4_6_1,           \
+    R_##V##x4_7_0=R_##W##x4_7_0, R_##V##x4_7_1=R_##W##x4_7_1,           \
+    R_##V##x2_0_0=R_##W##x2_0_0, R_##V##x2_1_0=R_##W##x2_1_0,           \
+    R_##V##x2_2_0=R_##W##x2_2_0, R_##V##x2_3_0=R_##W##x2_3_0,           \
+    R_##V##x2_4_0=R_##W##x2_4_0, R_##V##x2_5_0=R_##W##x2_5_0,           \
+    R_##V##x2_6_0=R_##W##x2_6_0, R_##V##x2_7_0=R_##W##x2_7_0            \
+};                                                                      \
+static inline uint##V##_t RotL_##V(uint##V##_t x, unsigned int N)       \
+{                                                                       \
+    return (x << (N & (W-1))) | (x >> ((W-N) & (W-1)));                 \
+}                                                                       \
+_r123array_tpl(2, V, uint##V##_t)                                       \
+_r123array_tpl(4, V, uint##V##_t)
+
+#define SKEIN_KS_PARITYy32 ((uinty32_t){0} + SKEIN_KS_PARITY32)
+#define SKEIN_KS_PARITYy64 ((uinty64_t){0} + SKEIN_KS_PARITY64)
+#define SKEIN_KS_PARITYz32 ((uintz32_t){0} + SKEIN_KS_PARITY32)
+#define SKEIN_KS_PARITYz64 ((uintz64_t){0} + SKEIN_KS_PARITY64)
+#define THREEFRY2xy32_DEFAULT_ROUNDS THREEFRY2x32_DEFAULT_ROUNDS
+#define THREEFRY4xy32_DEFAULT_ROUNDS THREEFRY4x32_DEFAULT_ROUNDS
+#define THREEFRY2xy64_DEFAULT_ROUNDS THREEFRY2x64_DEFAULT_ROUNDS
+#define THREEFRY4xy64_DEFAULT_ROUNDS THREEFRY4x64_DEFAULT_ROUNDS
+#define THREEFRY2xz32_DEFAULT_ROUNDS THREEFRY2x32_DEFAULT_ROUNDS
+#define THREEFRY4xz32_DEFAULT_ROUNDS THREEFRY4x32_DEFAULT_ROUNDS
+#define THREEFRY2xz64_DEFAULT_ROUNDS THREEFRY2x64_DEFAULT_ROUNDS
+#define THREEFRY4xz64_DEFAULT_ROUNDS THREEFRY4x64_DEFAULT_ROUNDS
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#define THREEFRY_SIMD_Y 1
+_threefry_simd_alias_tpl(y32, 32)
+_threefry2x_tpl(y32)
+_threefry4x_tpl(y32)
+#ifndef HAVE_32BITLONG
+_threefry_simd_alias_tpl(y64, 64)
+_threefry2x_tpl(y64)
+_threefry4x_tpl(y64)
+#endif
+#endif
+#if defined(__GNUC__) && defined(__AVX512F__)
+#define THREEFRY_SIMD_Z 1
+_threefry_simd_alias_tpl(z32, 32)
+_threefry2x_tpl(z32)
+_threefry4x_tpl(z32)
+#ifndef HAVE_32BITLONG
+_threefry_simd_alias_tpl(z64, 64)
+_threefry2x_tpl(z64)
+_threefry4x_tpl(z64)
+#endif
+#endif
+
 /* gcc4.5 and 4.6 seem to optimize a macro-ized threefryNxW better
    than a static inline function.  Why?  */
 #define threefry2x32(c,k) threefry2x32_R(threefry2x32_rounds, c, k)
@@ -1031,13 +1098,139 @@ _threefryNxW_advance_tpl(2, 64)
 _threefryNxW_advance_tpl(4, 64)
 #endif
 
+/*
+ * Bulk fills (see rng_fill.h).  Whatever is left in the buffer goes
+ * first, then whole runs of blocks from the widest multi-lane kernel
+ * the CPU can run (lane j encrypting counter ctr+1+j, as the next blocks
+ * threefryNxW_next() would), then the rest one at a time.  64 bit words
+ * are truncated to unsigned int just as gsl_rng_get() into one is.
+ */
+#define _threefryNxW_blocks_tpl(N, W, V)                                  \
+static void threefry##N##x##V##_blocks(threefry##N##x##W##_state_t *s, unsigned int *buf) \
+{                                                                         \
+  enum { lanes = sizeof(uint##V##_t) / sizeof(uint##W##_t) };             \
+  threefry##N##x##V##_ctr_t c, x;                                         \
+  threefry##N##x##V##_key_t k;                                            \
+  int i, j;                                                               \
+  for (j = 0; j < lanes; j++) {                                           \
+    i = 0;                                                                \
+    do {                                                                  \
+      s->ctr.v[i++]++;                                                    \
+    } while (s->ctr.v[i-1] == 0 && i < N);                                \
+    for (i = 0; i < N; i++) c.v[i][j] = s->ctr.v[i];                      \
+  }                                                                       \
+  for (i = 0; i < N; i++) k.v[i] = (uint##V##_t){0} + s->key.v[i];        \
+  x = threefry##N##x##V##_R(threefry##N##x##V##_rounds, c, k);            \
+  for (j = 0; j < lanes; j++)                                             \
+    for (i = 0; i < N; i++) buf[j*N + i] = (unsigned int)x.v[i][j];       \
+}
+
+#ifdef THREEFRY_SIMD_Y
+_threefryNxW_blocks_tpl(2, 32, y32)
+_threefryNxW_blocks_tpl(4, 32, y32)
+#ifndef HAVE_32BITLONG
+_threefryNxW_blocks_tpl(2, 64, y64)
+_threefryNxW_blocks_tpl(4, 64, y64)
+#endif
+#define _threefry_fill_y(N, W)                                            \
+  if (x86_simd_level() >= X86_SIMD_AVX2) {                                \
+    const size_t run = N * (sizeof(uinty##W##_t) / sizeof(uint##W##_t));  \
+    for (; i + run <= n; i += run)                                        \
+      threefry##N##xy##W##_blocks(s, buf + i);                            \
+  }
+#else
+#define _threefry_fill_y(N, W)
+#endif
+
+#ifdef THREEFRY_SIMD_Z
+_threefryNxW_blocks_tpl(2, 32, z32)
+_threefryNxW_blocks_tpl(4, 32, z32)
+#ifndef HAVE_32BITLONG
+_threefryNxW_blocks_tpl(2, 64, z64)
+_threefryNxW_blocks_tpl(4, 64, z64)
+#endif
+#define _threefry_fill_z(N, W)                                            \
+  if (x86_simd_level() >= X86_SIMD_AVX512) {                              \
+    const size_t run = N * (sizeof(uintz##W##_t) / sizeof(uint##W##_t));  \
+    for (; i + run <= n; i += run)                                        \
+      threefry##N##xz##W##_blocks(s, buf + i);                            \
+  }
+#else
+#define _threefry_fill_z(N, W)
+#endif
+
+#define _threefryNxW_fill_tpl(N, W)                                       \
+void threefry##N##x##W##_fill_u32(void *vstate, unsigned int *buf, size_t n) \
+{                                                                         \
+  threefry_all_t *state = (threefry_all_t*) vstate;                       \
+  threefry##N##x##W##_state_t *s = &state->state.state##N##x##W;          \
+  size_t i = 0;                                                           \
+  while (i < n && state->buffer_pos < N)                                  \
+    buf[i++] = (unsigned int)threefry##N##x##W##_next(state);             \
+  _threefry_fill_z(N, W)                                                  \
+  _threefry_fill_y(N, W)                                                  \
+  (void)s;                                                                \
+  for (; i < n; i++)                                                      \
+    buf[i] = (unsigned int)threefry##N##x##W##_next(state);               \
+}
+
+_threefryNxW_fill_tpl(2, 32)
+_threefryNxW_fill_tpl(4, 32)
+#ifndef HAVE_32BITLONG
+_threefryNxW_fill_tpl(2, 64)
+_threefryNxW_fill_tpl(4, 64)
+#endif
+
+/*
+ * Discard (see rng_discard.h).  Use up what is left in the buffer, add
+ * the number of whole blocks skipped to the multiword counter, and
+ * regenerate the buffer at the block the discard ends in.
+ */
+#define _threefryNxW_discard_tpl(N, W)                                             \
+void threefry##N##x##W##_discard(void *vstate, uint64_t n) {                       \
+  threefry_all_t *state = (threefry_all_t*) vstate;                                 \
+  int i;                                                                      \
+  uint64_t avail, blocks, add;                                                \
+  uint##W##_t a, sum, carry;                                                  \
+  threefry##N##x##W##_ctr_t ct;                                                  \
+  avail = N - state->buffer_pos;                                              \
+  if (n <= avail) {                                                           \
+    state->buffer_pos += n;                                                   \
+    return;                                                                   \
+  }                                                                           \
+  n -= avail;                                                                 \
+  blocks = (n + N - 1) / N;                                                   \
+  add = blocks;                                                               \
+  carry = 0;                                                                  \
+  for (i = 0; i < N; i++) {                                                   \
+    a = (uint##W##_t)add;                                                     \
+    sum = state->state.state##N##x##W.ctr.v[i] + a;                           \
+    state->state.state##N##x##W.ctr.v[i] = sum + carry;                       \
+    carry = (sum < a) | (sum + carry < carry);                                \
+    add = (W == 64) ? 0 : add >> (W % 64);                                    \
+  }                                                                           \
+  ct = threefry##N##x##W(state->state.state##N##x##W.ctr, state->state.state##N##x##W.key); \
+  for (i = 0; i < N; i++) {                                                   \
+    state->buffer[i].u##W = ct.v[i];                                          \
+  }                                                                           \
+  state->buffer_pos = n - (blocks - 1) * N;                                   \
+}
+
+_threefryNxW_discard_tpl(2, 32)
+_threefryNxW_discard_tpl(4, 32)
+#ifndef HAVE_32BITLONG
+_threefryNxW_discard_tpl(2, 64)
+_threefryNxW_discard_tpl(4, 64)
+#endif
+
 #define _threefryNxW_get(N, W)                                          \
 static void threefry##N##x##W##_set(void *vstate, unsigned long int seed) \
 {                                                                       \
   threefry_all_t *state = (threefry_all_t*) vstate;                     \
   uint##W##_t steps[N];                                                 \
+  memset(state, 0, sizeof(*state));                                     \
   steps[0] = (uint##W##_t)seed;                                         \
-  for (unsigned i = i; i < N; i++)                                      \
+  for (unsigned i = 1; i < N; i++)                                      \
     steps[i] = 0;                                                       \
   threefry##N##x##W##_advance(state, steps, 1);                         \
 }                                                                       \
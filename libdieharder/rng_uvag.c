@@ -117,6 +117,9 @@ static void uvag_set (UNUSED_PARAM void *vstate, unsigned long int s)
  uint i, array_len = 255 + WORD, tot, seed_seed, tmp8;
  unsigned char key[256], *kp, temp;
  gsl_rng *seed_rng;    /* random number generator used to seed uvag */
+ Dbits seed_bits;      /* and a bit reader of our own on it */
+ unsigned long int smax;
+ uint sbits;
 
  /*
   * Preload the array with 1-byte integers
@@ -137,20 +140,21 @@ static void uvag_set (UNUSED_PARAM void *vstate, unsigned long int s)
  seed_rng = gsl_rng_alloc(dh_rng_types[14]);
  seed_seed = s;
  gsl_rng_set(seed_rng,seed_seed);
- //random_max = gsl_rng_max(seed_rng);
- random_max = seed_rng->type->max;
- rmax = random_max;
- rmax_bits = 0;
- rmax_mask = 0;
- while(rmax){
-   rmax >>= 1;
-   rmax_mask = rmax_mask << 1;
-   rmax_mask++;
-   rmax_bits++;
+ /*
+  * The key bytes come from a private bit reader on seed_rng, so they
+  * neither disturb nor depend on the bits any test is reading (and we
+  * no longer overwrite the global rmax_bits of the rng under test).
+  */
+ smax = seed_rng->type->max;
+ sbits = 0;
+ while(smax){
+   smax >>= 1;
+   sbits++;
  }
+ bits_init(&seed_bits,seed_rng,sbits);
  for(i=0;i<256;i++){
    /* if(i%32 == 0) printf("\n"); */
-   get_rand_bits(&tmp8,sizeof(uint),8,seed_rng);
+   bits_get_rand_bits(&seed_bits,&tmp8,sizeof(uint),8);
    if(i!=255){
      key[i] = tmp8;
    } else {
@@ -57,6 +57,30 @@ static void wyrand_set (void *vstate, unsigned long int s) {
  state->i = (uint64_t)s;
 }
 
+/*
+ * Bulk fill (see rng_fill.h), keeping the low 32 bits of each return
+ * just as gsl_rng_get() into an unsigned int does.
+ */
+void wyrand_fill_u32 (void *vstate, unsigned int *buf, size_t n)
+{
+  uint64_t seed = ((wyrand_state_t*)vstate)->i;
+  size_t i;
+
+  for(i=0;i<n;i++){
+    buf[i] = (unsigned int)wyrand(&seed);
+  }
+  ((wyrand_state_t*)vstate)->i = seed;
+}
+
+/*
+ * Discard (see rng_discard.h):  wyrand's state is a Weyl sequence
+ * stepping by _wyp[0].
+ */
+void wyrand_discard (void *vstate, uint64_t n)
+{
+  ((wyrand_state_t*)vstate)->i += n * _wyp[0];
+}
+
 static const gsl_rng_type wyrand_type =
 {"wyrand",                      /* name */
  RNG64_MAX,			/* RAND_MAX */
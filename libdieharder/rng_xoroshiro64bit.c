@@ -274,6 +274,49 @@ static void xoroshiro64_set (void *vstate, unsigned long int s) {
  state->s[3] = (s + 3) ^ rotl(s, 24);
 }
 
+/*
+ * Bulk fills (see rng_fill.h).  The generator runs on a local copy of
+ * the state, which the compiler can keep in registers.  Like
+ * gsl_rng_get() into an unsigned int, they keep the low 32 bits.
+ */
+#define RNG_FILL(n) \
+void n##_fill_u32 (void *vstate, unsigned int *buf, size_t len) \
+{ \
+  xoshiro64_state_t state = *(xoshiro64_state_t *)vstate; \
+  size_t i; \
+  for(i=0;i<len;i++) buf[i] = (unsigned int)n##_get(&state); \
+  *(xoshiro64_state_t *)vstate = state; \
+}
+
+RNG_FILL (xoroshiro128_pp)
+RNG_FILL (xoroshiro128_ss)
+RNG_FILL (xoroshiro128_p)
+RNG_FILL (xoshiro256_pp)
+RNG_FILL (xoshiro256_ss)
+RNG_FILL (xoshiro256_p)
+
+/*
+ * Discards (see rng_discard.h), jumping with rng_discard_gf2() as the
+ * 32 bit ones do.  xoroshiro128++ has different shifts from ** and +,
+ * so it gets its own polynomial.  The polynomials (and their cached
+ * x^n) are rewritten by every discard, so discarding from two threads
+ * at once is not safe.
+ */
+static rng_gf2_poly xoroshiro128pp_poly, xoroshiro128_poly, xoshiro256_poly;
+
+#define RNG_DISCARD(n, poly, words) \
+void n##_discard (void *vstate, uint64_t count) \
+{ \
+  rng_discard_gf2(vstate, (words)*sizeof(uint64_t), n##_get, 64*(words), &poly, count); \
+}
+
+RNG_DISCARD (xoroshiro128_pp, xoroshiro128pp_poly, 2)
+RNG_DISCARD (xoroshiro128_ss, xoroshiro128_poly, 2)
+RNG_DISCARD (xoroshiro128_p, xoroshiro128_poly, 2)
+RNG_DISCARD (xoshiro256_pp, xoshiro256_poly, 4)
+RNG_DISCARD (xoshiro256_ss, xoshiro256_poly, 4)
+RNG_DISCARD (xoshiro256_p, xoshiro256_poly, 4)
+
 static const gsl_rng_type xoroshiro128_pp_type =
 {"xoroshiro128++",              /* name */
  UINT64_MAX,			/* RAND_MAX */
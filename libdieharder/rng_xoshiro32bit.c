@@ -221,6 +221,46 @@ static void xoshiro32_set (void *vstate, unsigned long int s) {
  state->s[3] = (s + 3) ^ rotl(s, 24);
 }
 
+/*
+ * Bulk fills (see rng_fill.h).  The generator runs on a local copy of
+ * the state, which the compiler can keep in registers.
+ */
+#define RNG_FILL(n) \
+void n##_fill_u32 (void *vstate, unsigned int *buf, size_t len) \
+{ \
+  xoshiro32_state_t state = *(xoshiro32_state_t *)vstate; \
+  size_t i; \
+  for(i=0;i<len;i++) buf[i] = (unsigned int)n##_get(&state); \
+  *(xoshiro32_state_t *)vstate = state; \
+}
+
+RNG_FILL (xoshiro128_pp)
+RNG_FILL (xoshiro128_ss)
+RNG_FILL (xoshiro128_p)
+RNG_FILL (xoroshiro64_ss)
+RNG_FILL (xoroshiro64_s)
+
+/*
+ * Discards (see rng_discard.h).  The state transitions are linear over
+ * GF(2), so long discards jump with rng_discard_gf2().  The ++, ** and +
+ * variants of an engine share its transition, and its polynomial.
+ * The polynomials (and their cached x^n) are rewritten by every
+ * discard, so discarding from two threads at once is not safe.
+ */
+static rng_gf2_poly xoshiro128_poly, xoroshiro64_poly;
+
+#define RNG_DISCARD(n, poly, words) \
+void n##_discard (void *vstate, uint64_t count) \
+{ \
+  rng_discard_gf2(vstate, (words)*sizeof(uint32_t), n##_get, 32*(words), &poly, count); \
+}
+
+RNG_DISCARD (xoshiro128_pp, xoshiro128_poly, 4)
+RNG_DISCARD (xoshiro128_ss, xoshiro128_poly, 4)
+RNG_DISCARD (xoshiro128_p, xoshiro128_poly, 4)
+RNG_DISCARD (xoroshiro64_ss, xoroshiro64_poly, 2)
+RNG_DISCARD (xoroshiro64_s, xoroshiro64_poly, 2)
+
 static const gsl_rng_type xoshiro128_pp_type =
 {"xoshiro128++",                      /* name */
  UINT32_MAX,			/* RAND_MAX */
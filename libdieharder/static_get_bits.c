@@ -20,13 +20,37 @@
  * without dropping any.  The return can even be of arbitrary size --
  * we make the return a void pointer whose size is specified by the
  * caller (and guaranteed to be big enough to hold the result).
+ *
+ * The leftover bits are kept in the caller's bit reader (rbits, usually
+ * &test[0]->ctx->bits), not in statics.
+ */
+
+inline static uint get_rand_bits_uint (uint nbits, uint mask, Dbits *rbits);
+
+/*
+ * Fill buf with the next n 32 bit uints from rbits, i.e. n calls to
+ * get_rand_bits_uint(32,0xFFFFFFFF,rbits).  A 32 bit generator returns
+ * those straight from gsl_rng_get() (see below), so fill_u32() gives
+ * exactly the same buf in one call.
  */
+inline static void get_rand_bits_uints (uint *buf, uint n, Dbits *rbits)
+{
+
+ uint i;
+
+ if(rbits->rmax_bits == 32){
+   fill_u32(rbits->rng,buf,n);
+   return;
+ }
+ for(i=0;i<n;i++){
+   buf[i] = get_rand_bits_uint(32,0xFFFFFFFF,rbits);
+ }
+
+}
 
-inline static uint get_rand_bits_uint (uint nbits, uint mask, gsl_rng *rng)
+inline static uint get_rand_bits_uint (uint nbits, uint mask, Dbits *rbits)
 {
 
- static uint bit_buffer;
- static uint bits_left_in_bit_buffer = 0;
  uint bits,breturn;
 
  /*
@@ -103,8 +127,8 @@ and so on.  Very nice.
   * never does (uintvar << 32) for some uint variable; probably should
   * do the same for (uintvar >> 32) calls below.
   */
- if(nbits == rmax_bits){
-   return gsl_rng_get(rng);
+ if(nbits == rbits->rmax_bits){
+   return gsl_rng_get(rbits->rng);
  }
   
  MYDEBUG(D_BITS) {
@@ -112,15 +136,15 @@ and so on.  Very nice.
    printf(" Mask = ");
    dumpuintbits(&mask,1);
    printf("\n");
-   printf("%u bits left\n",bits_left_in_bit_buffer);
+   printf("%u bits left\n",rbits->bits_left);
    printf(" Buff = ");
-   dumpuintbits(&bit_buffer,1);
+   dumpuintbits(&rbits->bit_buffer,1);
    printf("\n");
  }
 
- if (bits_left_in_bit_buffer >= nbits) {
-   bits_left_in_bit_buffer -= nbits;
-   bits = (bit_buffer >> bits_left_in_bit_buffer);
+ if (rbits->bits_left >= nbits) {
+   rbits->bits_left -= nbits;
+   bits = (rbits->bit_buffer >> rbits->bits_left);
    MYDEBUG(D_BITS) {
      printf("Enough:\n");
      printf(" Bits = ");
@@ -131,7 +155,7 @@ and so on.  Very nice.
    return bits & mask;
  }
 
- nbits = nbits - bits_left_in_bit_buffer;
+ nbits = nbits - rbits->bits_left;
  /*
   * This fixes an annoying quirk of the x86.  It only uses the bottom five
   * bits of the shift value.  That means that if you shift right by 32 --
@@ -147,7 +171,7 @@ and so on.  Very nice.
  if(nbits == 32){
    bits = 0;
  } else {
-   bits = (bit_buffer << nbits);
+   bits = (rbits->bit_buffer << nbits);
  }
  MYDEBUG(D_BITS) {
    printf("Not enough, need %u:\n",nbits);
@@ -156,20 +180,20 @@ and so on.  Very nice.
    printf("\n");
  }
  while (1) {
-   bit_buffer = gsl_rng_get (rng);
-   bits_left_in_bit_buffer = rmax_bits;
+   rbits->bit_buffer = gsl_rng_get (rbits->rng);
+   rbits->bits_left = rbits->rmax_bits;
 
    MYDEBUG(D_BITS) {
      printf("Refilled bit_buffer\n");
-     printf("%u bits left\n",bits_left_in_bit_buffer);
+     printf("%u bits left\n",rbits->bits_left);
      printf(" Buff = ");
-     dumpuintbits(&bit_buffer,1);
+     dumpuintbits(&rbits->bit_buffer,1);
      printf("\n");
    }
 
-   if (bits_left_in_bit_buffer >= nbits) {
-     bits_left_in_bit_buffer -= nbits;
-     bits |= (bit_buffer >> bits_left_in_bit_buffer);
+   if (rbits->bits_left >= nbits) {
+     rbits->bits_left -= nbits;
+     bits |= (rbits->bit_buffer >> rbits->bits_left);
 
      MYDEBUG(D_BITS) {
        printf("Returning:\n");
@@ -181,8 +205,8 @@ and so on.  Very nice.
 
      return bits & mask;
    }
-   nbits -= bits_left_in_bit_buffer;
-   bits |= (bit_buffer << nbits);
+   nbits -= rbits->bits_left;
+   bits |= (rbits->bit_buffer << nbits);
 
    MYDEBUG(D_BITS) {
      printf("This should never execute:\n");
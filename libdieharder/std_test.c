@@ -45,6 +45,17 @@
  * This should be called before a test is started in the UI.
  */
 Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
+{
+
+ return(create_test_ctx(default_context(),dtest,tsamples,psamples));
+
+}
+
+/*
+ * The same, but the test is to be run with (and will read its rng and
+ * tunables only from) ctx.  ctx must outlive the test.
+ */
+Test **create_test_ctx(Dcontext *ctx, Dtest *dtest, uint tsamples,uint psamples)
 {
 
  uint i,j;
@@ -55,6 +66,12 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
    fprintf(stdout,"# create_test(): About to create test %s\n",dtest->sname);
  }
 
+ /*
+  * Every test starts reading bits from an empty bit reader, so what it
+  * sees does not depend on what ran before it.
+  */
+ bits_reset(&ctx->bits);
+
  /*
   * Here we have to create a vector of tests of length nkps
   */
@@ -76,7 +93,7 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
 
    /* possibly broken AMD */
    if ((strcmp(dtest->sname, "rgb_timing") == 0) &&
-       (strcmp(gsl_rng_name(rng), "rdrand") == 0) &&
+       (strcmp(gsl_rng_name(ctx->rng), "rdrand") == 0) &&
        !is_genuine_intel()) {
      dtest->tsamples_std = 1000; // don't exhaust the poor cpu with only 77 samples/sec
      dtest->psamples_std = 1;
@@ -88,13 +105,13 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
     * for psamples that permits one to scale the standard number of psamples
     * in an -a(ll) run by multiply_p.
     */
-   if(all == YES || tsamples == 0){
+   if(ctx->all == YES || tsamples == 0){
      newtest[i]->tsamples = dtest->tsamples_std;
    } else {
      newtest[i]->tsamples = tsamples;
    }
-   if(all == YES || psamples == 0){
-     newtest[i]->psamples = dtest->psamples_std * multiply_p;
+   if(ctx->all == YES || psamples == 0){
+     newtest[i]->psamples = dtest->psamples_std * ctx->multiply_p;
      if (newtest[i]->psamples < 1) newtest[i]->psamples = 1;
    } else {
      newtest[i]->psamples = psamples;
@@ -102,14 +119,15 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
 
    /* Give ntuple an initial value of zero; most tests will set it. */
    newtest[i]->ntuple = 0;
+   newtest[i]->ctx = ctx;
 
    /*
     * Now we can malloc space for the pvalues vector, and a
     * single (80-column) LINE for labels for the pvalues.  We default
     * the label to a line of #'s.
     */
-   if(Xtrategy != 0 && Xoff > newtest[i]->psamples){
-     pcutoff = Xoff;
+   if(ctx->Xtrategy != 0 && ctx->Xoff > newtest[i]->psamples){
+     pcutoff = ctx->Xoff;
    } else {
      pcutoff = newtest[i]->psamples;
    }
@@ -125,10 +143,13 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
     * call is the first call.  It will be nonzero after the first call.
     */
    newtest[i]->ks_pvalue = 0.0;
+   newtest[i]->ks_sorted = 0;
+   newtest[i]->ks_tail = NULL;
+   newtest[i]->ks_tailsize = 0;
 
    MYDEBUG(D_STD_TEST){
      printf("Allocated and set newtest->tsamples = %d\n",newtest[i]->tsamples);
-     printf("Xtrategy = %u -> pcutoff = %u\n",Xtrategy,pcutoff);
+     printf("Xtrategy = %u -> pcutoff = %u\n",ctx->Xtrategy,pcutoff);
      printf("Allocated and set newtest->psamples = %d\n",newtest[i]->psamples);
    }
 
@@ -159,6 +180,7 @@ void destroy_test(Dtest *dtest, Test **test)
  for(i=0;i<dtest->nkps;i++){
    free(test[i]->pvalues);
    free(test[i]->pvlabel);
+   free(test[i]->ks_tail);
  }
  /* printf("Freeing all the test structs\n"); */
  for(i=0;i<dtest->nkps;i++){
@@ -183,17 +205,21 @@ void clear_test(Dtest *dtest, Test **test)
 {
 
  unsigned int i;
+ Dcontext *ctx = test[0]->ctx;
+
+ if(is_default_context(ctx)) default_context();
 
  /*
   * reset psamples and clear the ks_pvalues
   */
  for(i=0;i<dtest->nkps;i++){
-   if(all == YES || psamples == 0){
-     test[i]->psamples = dtest->psamples_std*multiply_p;
+   if(ctx->all == YES || ctx->psamples == 0){
+     test[i]->psamples = dtest->psamples_std*ctx->multiply_p;
    } else {
-     test[i]->psamples = psamples;
+     test[i]->psamples = ctx->psamples;
    }
    test[i]->ks_pvalue = 0.0;
+   test[i]->ks_sorted = 0;
  }
 
  /*
@@ -203,6 +229,66 @@ void clear_test(Dtest *dtest, Test **test)
    
 }
 
+/*
+ * The KS (or with -k 3 Kuiper) pvalue of the psamples pvalues of test.
+ * kstest() would sort all of them every time, which in the TTD/RA modes
+ * below, Xstep new pvalues at a time out to Xoff, adds up to psamples^2
+ * work.  But the ones from the last call are still in order (up to
+ * ks_sorted) and add_2_test() only appends, so we sort just the new
+ * ones and merge them in from the top, in one pass, through the test's
+ * own ks_tail.  The statistic is exactly kstest()'s.  Only the sort is
+ * saved; the distribution is worked out afresh for every call, as the
+ * count has always grown since the last one.
+ */
+static void merge_pvalues(Test *test, unsigned int count)
+{
+
+ unsigned int i,j,k,nsorted = test->ks_sorted;
+ double *pvalue = test->pvalues,*tail;
+
+ gsl_sort(&pvalue[nsorted],1,count - nsorted);
+ if(nsorted == 0 || pvalue[nsorted-1] <= pvalue[nsorted]) return;
+
+ if(test->ks_tailsize < count - nsorted){
+   free(test->ks_tail);
+   test->ks_tailsize = count - nsorted;
+   test->ks_tail = (double *)malloc((size_t)test->ks_tailsize*sizeof(double));
+ }
+ tail = test->ks_tail;
+ memcpy(tail,&pvalue[nsorted],(size_t)(count - nsorted)*sizeof(double));
+ i = nsorted;
+ j = count - nsorted;
+ k = count;
+ while(j > 0){
+   if(i > 0 && pvalue[i-1] > tail[j-1]){
+     pvalue[--k] = pvalue[--i];
+   } else {
+     pvalue[--k] = tail[--j];
+   }
+ }
+
+}
+
+static double test_kstest(Test *test, unsigned int kuiper)
+{
+
+ unsigned int n = test->psamples;
+ double d;
+
+ if(n < 1) return(-1.0);
+ if(n == 1) return(test->pvalues[0]);
+
+ if(test->ks_sorted > n) test->ks_sorted = 0;
+ if(test->ks_sorted < n){
+   merge_pvalues(test,n);
+   test->ks_sorted = n;
+ }
+
+ d = kuiper ? kstest_kuiper_v(test->pvalues,n) : kstest_dmax(test->pvalues,n);
+ return(kuiper ? kstest_kuiper_p(n,d) : kstest_p(n,d));
+
+}
+
 /*
  * Test To Destruction (TTD) or Resolve Ambiguity (RA) modes require one
  * to iterate, adding psamples until:
@@ -217,14 +303,15 @@ void clear_test(Dtest *dtest, Test **test)
  * is called by std_test() in two modes -- first call and TTD/RA (add more
  * samples) mode.  This is completely automagic, though.
  *
- * Note that Xoff MUST remain global, if nothing else.  Otherwise we
- * can run out of allocated headroom in the pvalues vector.
+ * Note that Xoff MUST not change between create_test() and here (it is
+ * in the test's context).  Otherwise we can run out of allocated
+ * headroom in the pvalues vector.
  */
 void add_2_test(Dtest *dtest, Test **test, int count)
 {
 
  uint i,j,imax;
-
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * Will count carry us over Xoff?  If it will, stop at Xoff and
@@ -232,7 +319,7 @@ void add_2_test(Dtest *dtest, Test **test, int count)
   * of how many samples we have at the end of it all.
   */
  imax = test[0]->psamples + count;
- if(imax > Xoff) imax = Xoff;
+ if(imax > ctx->Xoff) imax = ctx->Xoff;
  count = imax - test[0]->psamples;
  for(i = test[0]->psamples; i < imax; i++){
    dtest->test(test,i);
@@ -245,16 +332,16 @@ void add_2_test(Dtest *dtest, Test **test, int count)
     */
    test[j]->psamples += count;
 
-   if(ks_test >= 3){
+   if(ctx->ks_test >= 3){
      /*
       * This (Kuiper KS) can be selected with -k 3 from the command line.
       * Generally it is ignored.  All smaller values of ks_test are passed
       * through to kstest() and control its precision (and speed!).
       */
-     test[j]->ks_pvalue = kstest_kuiper(test[j]->pvalues,test[j]->psamples);
+     test[j]->ks_pvalue = test_kstest(test[j],1);
    } else {
      /* This is (symmetrized Kolmogorov-Smirnov) is the default */
-     test[j]->ks_pvalue = kstest(test[j]->pvalues,test[j]->psamples);
+     test[j]->ks_pvalue = test_kstest(test[j],0);
    }
 
  }
@@ -276,6 +363,13 @@ void std_test(Dtest *dtest, Test **test)
 
  unsigned int j,count;
  double pmax = 0.0;
+ Dcontext *ctx = test[0]->ctx;
+
+ /*
+  * The default context follows the globals, which may have been
+  * changed since create_test().
+  */
+ if(is_default_context(ctx)) default_context();
 
  /*
   * First we see if this is the first call.  If it is, we save
@@ -295,7 +389,7 @@ void std_test(Dtest *dtest, Test **test)
    }
  } else {
    /* Add Xstep more samples */
-   count = Xstep;
+   count = ctx->Xstep;
  }
 
  add_2_test(dtest,test,count);
@@ -15,28 +15,25 @@
  * Rewriting means that I can standardize the interface to gsl-encapsulated
  * routines more easily.  It also makes this my own code.
  *
- * The #if'd code below is from David Bauer, and is a bit difficult to
- * read (which ordinarily would be sufficient grounds for not using it,
- * according to my usual standards for non-obfuscating code).  It is,
- * however, 12% faster as it does the summing up of 1's vs 0's using
- * bitshifts and masks (faster operations than looped C sums).  You can
- * turn on the old code if you like, but we'll leave the default "fast".
- *
- * NOBITS = 0 means "use the fast bitmask code", where
- * NOBITS = 1 should turn the linear/obvious C code back on.
+ * The rands are drawn a buffer at a time and their 1 bits counted by
+ * popcount_u32() (see popcount.c), which picks the fastest (SIMD or
+ * popcnt) kernel the CPU has.  This replaces David Bauer's bitmask
+ * count a word at a time, which in turn replaced a loop over the bits.
  * ========================================================================
  */
 
 #include <dieharder/libdieharder.h>
 
-#define NOBITS 0
+#define MONOBIT_BUF 4096
 
 int sts_monobit(Test **test, unsigned int irun)
 {
 
- uint i;
+ uint i,j,n;
  uint blens,nbits;
  Xtest ptest;
+ uint *buf;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * for display only.  1 means monobit tests 1-tuples.
@@ -61,7 +58,7 @@ int sts_monobit(Test **test, unsigned int irun)
  /*
   * The number of bits per random integer tested.
   */
- blens = rmax_bits;
+ blens = ctx->rmax_bits;
  nbits = blens*test[0]->tsamples;
  ptest.y = 0.0;
  ptest.sigma = sqrt((double)nbits);
@@ -75,46 +72,21 @@ int sts_monobit(Test **test, unsigned int irun)
  }
  ptest.x = 0;
 
- for(i=0;i<test[0]->tsamples;i++) {
-#if NOBITS
-   bitstring = gsl_rng_get(rng);
-#else
-   uint n = gsl_rng_get(rng);
-#endif
+ buf = (uint *)malloc(MONOBIT_BUF*sizeof(uint));
+ for(i=0;i<test[0]->tsamples;i+=n) {
+   n = test[0]->tsamples - i;
+   if(n > MONOBIT_BUF) n = MONOBIT_BUF;
+   fill_u32(ctx->rng,buf,n);
    MYDEBUG(D_STS_MONOBIT) {
-#if NOBITS
-     printf("# rgb_bitdist() (nobits): rand_int[%d] = %u = ",i,bitstring);
-     dumpbits(&bitstring,8*sizeof(uint));
-#else
-     printf("# rgb_bitdist() (bits): rand_int[%d] = %u = ",i,n);
-     dumpbits(&n,8*sizeof(uint));
-#endif
-   }
-#if NOBITS
-   for(b=0;b<blens;b++){
-     /*
-      * This gets the integer value of the ntuple at index position
-      * n in the current bitstring, from a window with cyclic wraparound.
-      */
-     bit = bitstring & 0x01;
-     bitstring >>= 1;
-     ptest.x += bit;
-   }
-#else
-   n -= (n >> 1) & 0x55555555;
-   n = (n & 0x33333333) + ((n >> 2) & 0x33333333);
-   n = (n + (n >> 4)) & 0x0f0f0f0f;
-   if(0) {
-     n = (n * 0x01010101) >> 24;
-   } else {
-     n = n + (n >> 8);
-     n = (n + (n >> 16)) & 0x3f;
+     for(j=0;j<n;j++){
+       printf("# rgb_bitdist() (bits): rand_int[%d] = %u = ",i+j,buf[j]);
+       dumpbits(&buf[j],8*sizeof(uint));
+     }
    }
-   ptest.x += n;
-#endif
-
+   ptest.x += popcount_u32(buf,n);
  }
- 
+ free(buf);
+
  ptest.x = 2*ptest.x - nbits;
  MYDEBUG(D_STS_MONOBIT) {
    printf("mtext.x = %10.5f  ptest.sigma = %10.5f\n",ptest.x,ptest.sigma);
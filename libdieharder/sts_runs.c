@@ -26,6 +26,7 @@ int sts_runs(Test **test, unsigned int irun)
  uint *rand_int;
  Xtest ptest;
  double pones,c00,c01,c10,c11;;
+ Dcontext *ctx = test[0]->ctx;
 
  /*
   * for display only.  2 means sts_runs tests 2-tuples.
@@ -40,7 +41,7 @@ int sts_runs(Test **test, unsigned int irun)
  /*
   * Number of total bits from -t test[0]->tsamples = size of rand_int[]
   */
- bits = rmax_bits*test[0]->tsamples;
+ bits = ctx->rmax_bits*test[0]->tsamples;
 
  /*
   * We have to initialize these a bit differently this time
@@ -50,9 +51,7 @@ int sts_runs(Test **test, unsigned int irun)
  /*
   * Create entire bitstring to be tested
   */
- for(t=0;t<test[0]->tsamples;t++){
-   rand_int[t] = gsl_rng_get(rng);
- }
+ fill_u32(ctx->rng,rand_int,test[0]->tsamples);
 
  /*
   * Fill vector of "random" integers with selected generator.
@@ -94,11 +93,11 @@ int sts_runs(Test **test, unsigned int irun)
  /*
   * form the probability of getting a one in the entire sample
   */
- pones /= (double) test[0]->tsamples*rmax_bits;
- c00 /= (double) test[0]->tsamples*rmax_bits;
- c01 /= (double) test[0]->tsamples*rmax_bits;
- c10 /= (double) test[0]->tsamples*rmax_bits;
- c11 /= (double) test[0]->tsamples*rmax_bits;
+ pones /= (double) test[0]->tsamples*ctx->rmax_bits;
+ c00 /= (double) test[0]->tsamples*ctx->rmax_bits;
+ c01 /= (double) test[0]->tsamples*ctx->rmax_bits;
+ c10 /= (double) test[0]->tsamples*ctx->rmax_bits;
+ c11 /= (double) test[0]->tsamples*ctx->rmax_bits;
 
  /*
   * Now we can finally compute the targets for the problem.
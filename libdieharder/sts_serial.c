@@ -77,43 +77,77 @@
 #include "static_get_bits.c"
 
 /*
- * This is a buffer of uint length (2^nb)+1 that we will fill with rands
- * to be tested, once per test.
+ * The widest pattern we will count.  The count table is 2^nb uints, so
+ * this bounds it at 64 MB.
  */
+#define STS_SERIAL_NMAX 24
+
+/*
+ * One pass over the buffer counts every overlapping nb bit window,
+ * starting at each bit of uintbuf[0..n-1] in turn (MSB first), into
+ * count[0..2^nb-1].  Two adjacent uints make a 64 bit window, so any
+ * nb <= 32 fits at every one of the 32 starting bits of the first.
+ * uintbuf[n] must hold the wraparound word.
+ */
+static void sts_serial_count(const uint *uintbuf,uint n,uint nb,uint *count)
+{
+
+ uint j,r;
+ uint64_t w;
+ uint64_t mask = (1ull << nb) - 1;
+
+ for(j=0;j<n;j++){
+   w = ((uint64_t) uintbuf[j] << 32) | uintbuf[j+1];
+   for(r=0;r<32;r++){
+     count[(w >> (64 - nb - r)) & mask]++;
+   }
+ }
+
+}
 
 int sts_serial(Test **test, unsigned int irun)
 {
 
  uint bsize;       /* number of bits/samples in uintbuf */
  uint nb,nb1;          /* number of bits in a tested ntuple */
- uint value;       /* value of sampled ntuple (as a uint) */
- uint mask;        /* mask in only nb bits */
- uint bi;          /* bit offset relative to window */
+ uint m0;          /* lowest order with a test slot of its own */
+ Dcontext *ctx = test[0]->ctx;
 
  /* Look for cruft below */
 
  uint i,j,m,t;            /* generic loop indices */
- uint ctotal;  /* count of any ntuple per bitstring */
- double **freq,*psi2,*delpsi2,*del2psi2;
+ uint tsamples;
+ uint *count;
+ double *psi2,*delpsi2,*del2psi2;
  double pvalue;
  uint *uintbuf;
- uint window;  /* uint window into uintbuf, slide along a byte at at time. */
 
  double mono_mean,mono_sigma;  /* For single bit test */
 
  /*
-  * Sample a bitstring of rgb_bitstring_ntuple in length (exactly).  Note
-  * that I'm going to force nb>=2, nb<=16 for the moment.  The routine
-  * might "work" for nb up to 24 or even (on a really big memory machine)
-  * 32, but memory requirements in uints are around 2^(nb+1) + n where n
-  * is order unity, maybe worse, so I think it would take a 12 to 16 GB
-  * machine to be able to just hold the memory, and then it would take a
-  * very long time.  However, the testing process might parallelize
-  * decently if we could farm out the blocks of bits to be run efficiently
-  * over a network relative to the time required to generate them.
+  * Sample a bitstring of rgb_bitstring_ntuple in length (exactly).  By
+  * default nb = 16, giving one test for m = 1, one test for m = 2 and
+  * two tests each for m = [3,16].  -n nb (up to STS_SERIAL_NMAX) counts
+  * wider patterns instead; the same thirty slots then hold m = 1 and
+  * the orders from m0 = nb-14 up to nb (see below).
   */
- nb = 16;        /* Just ignore sts_serial_ntuple for now */
- tsamples = test[0]->tsamples;  /* ditto */
+ nb = 16;
+ if(ctx->ntuple > 16 && ctx->all != YES){
+   if(ctx->ntuple > STS_SERIAL_NMAX){
+     fprintf(stderr,"Error:  sts_serial can count patterns of at most %u bits.\n",STS_SERIAL_NMAX);
+     exit(0);
+   }
+   nb = ctx->ntuple;
+   /*
+    * The rule (below) is about 2^(nb+2) bits, and the default tsamples
+    * is only good for nb up to 18 or so.
+    */
+   if(ctx->tsamples == 0 && test[0]->tsamples < (1u << (nb-3))){
+     test[0]->tsamples = 1u << (nb-3);
+   }
+ }
+ m0 = nb - 14;
+ tsamples = test[0]->tsamples;
  MYDEBUG(D_STS_SERIAL){
    printf("#==================================================================\n");
    printf("# Starting sts_serial.\n");
@@ -127,16 +161,14 @@ int sts_serial(Test **test, unsigned int irun)
  nb1 = nb+1;
 
  /*
-  * We need a vector of freq vectors.  We make each frequency counter
-  * vector only as large as it needs to be.  We zero each accumulator as
-  * we make it.  Note that we cannot sample "0 bits at a time" so m starts
-  * at 1.
+  * A single count table for the widest patterns, nb bits.  The count
+  * of an m bit pattern is the sum of the counts of the nb bit patterns
+  * that start with it, so we fold the table in half (in place) to go
+  * from m to m-1 and get every narrower table for free.  The counts
+  * are integers, exactly what separate passes for each m would give.
   */
- freq = (double **) malloc(nb1*sizeof(double *));
- for(m = 1;m < nb1;m++) {
-   freq[m] = (double *)malloc(pow(2,m)*sizeof(double));
-   memset(freq[m],0,pow(2,m)*sizeof(double));
- }
+ count = (uint *)malloc((1u << nb)*sizeof(uint));
+ memset(count,0,(1u << nb)*sizeof(uint));
 
  /*
   * These are the statistics required by sts_serial in SP800.  psi2[m] is
@@ -180,16 +212,12 @@ int sts_serial(Test **test, unsigned int irun)
 
  /*
   * We start by filling testbuf with rands and cloning the first into
-  * the last slot for cyclic wrap.  This initial effort just uses the
-  * fast gsl_rng_get() call, but we'll need to use the inline from the
-  * static_get_rng routines in production.
+  * the last slot for cyclic wrap.  get_rand_bits_uints() bulk fills
+  * from a 32 bit rng and won't fail for short ones.
   */
- for(t=0;t<tsamples;t++){
-   /* A bit slower per call, but won't fail for short rngs */
-   uintbuf[t] = get_rand_bits_uint(32,0xFFFFFFFF,rng);
-   /* Fast, but deadly to rngs with less than 32 bits returned */
-   /* uintbuf[t] = gsl_rng_get(rng); */
-   MYDEBUG(D_STS_SERIAL){
+ get_rand_bits_uints(uintbuf,tsamples,&ctx->bits);
+ MYDEBUG(D_STS_SERIAL){
+   for(t=0;t<tsamples;t++){
      printf("# sts_serial(): %u:  ",t);
      dumpuintbits(&uintbuf[t],1);
      printf("\n");
@@ -203,60 +231,30 @@ int sts_serial(Test **test, unsigned int irun)
  }
 
  /*
-  * We now in ONE PASS loop over all of the possible values of m from
-  * 1 to 16.
+  * We now in ONE PASS count the nb bit patterns, then fold our way
+  * down through all of the possible values of m from nb to 1.
   */
- for(m=1;m<nb1;m++){
- 
-   /*
-    * Set the mask for bits to be returned.  This will work fine for
-    * m in the allowed range, and will fail if m = 32 if that ever
-    * happens in the future.
-    */
-   mask = 0;
-   for(i = 0; i < m; i++){
-      mask |= (1u << m);
-   }
-   mask = ((1u << m) - 1);
+ MYDEBUG(D_STS_SERIAL){
+   printf("looping bsize = %u times\n",bsize);
+ }
+ sts_serial_count(uintbuf,tsamples,nb,count);
 
-   /* Initialize index and count total */
-   j = 0;
-   ctotal = 0;
-   MYDEBUG(D_STS_SERIAL){
-     printf("looping bsize = %u times\n",bsize);
-   }
-   for(t=0;t<bsize;t++){
-     /*
-      * Offset of current sample, relative to left boundary of window.
-      */
-     if((t%32) == 0){
-       window = uintbuf[j];  /* start with window = testbuf = charbuf */
-       MYDEBUG(D_STS_SERIAL){
-         printf("uint window[%u] = %08x = ",j,window);
-         dumpuintbits(&window,1);
-         printf("\n");
-       }
-       j++;
-     }
-     bi = t%16;
-     value = (window >> (32 - m - bi)) & mask;
-     MYDEBUG(D_STS_SERIAL){
-       dumpbitwin(value,m);
-       printf("\n");
-     }
-     freq[m][value]++;
-     ctotal++;
-     if(bi == 15){
-       window = (window << 16);
-       window += (uintbuf[j] >> 16);
-       MYDEBUG(D_STS_SERIAL){
-         printf("half window[%u] = %08x = ",j,window);
-         dumpuintbits(&window,1);
-         printf("\n");
-       }
+ MYDEBUG(D_STS_SERIAL){
+   printf("# sts_serial():=====================================================\n");
+ }
+ for(m=nb;m>0;m--){
+
+   if(m < nb){
+     for(i=0;i < (1u << m);i++){
+       count[i] = count[2*i] + count[2*i+1];
      }
    }
 
+   for(i=0;i < (1u << m);i++){
+     psi2[m] += (double) count[i]*count[i];
+   }
+   psi2[m] = pow(2,m)*psi2[m]/bsize - bsize;
+
    MYDEBUG(D_STS_SERIAL){
      printf("# sts_serial():=====================================================\n");
      printf("# sts_serial():                  Count table\n");
@@ -264,9 +262,10 @@ int sts_serial(Test **test, unsigned int irun)
      for(i = 0; i<pow(2,m); i++){
        printf("# sts_serial():   ");
        dumpbitwin(i,m);
-       printf("\t%u\t%f\t%f\n",i,freq[m][i],(double) freq[m][i]/ctotal);
+       printf("\t%u\t%u\t%f\n",i,count[i],(double) count[i]/bsize);
      }
-     printf("# sts_serial(): Total count = %u, target probability = %f\n",ctotal,1.0/pow(2,m));
+     printf("# sts_serial(): Total count = %u, target probability = %f\n",bsize,1.0/pow(2,m));
+     printf("# sts_serial(): psi2[%u] = %f\n",m,psi2[m]);
    }
 
  } /* End of m loop */
@@ -274,25 +273,12 @@ int sts_serial(Test **test, unsigned int irun)
  /*
   * Now it is time to implement the statistic from STS SP800 whatever.
   */
- MYDEBUG(D_STS_SERIAL){
-   printf("# sts_serial():=====================================================\n");
- }
- for(m=1;m<nb1;m++){
-   for(i=0;i<pow(2,m);i++){
-     psi2[m] += freq[m][i]*freq[m][i];
-     /* printf("freq[%u][%u] = %f  p2 = %f \n",m,i,freq[m][i],psi2[m]); */
-   }
-   psi2[m] = pow(2,m)*psi2[m]/bsize - bsize;
-   MYDEBUG(D_STS_SERIAL){
-     printf("# sts_serial(): psi2[%u] = %f\n",m,psi2[m]);
-   }
- }
-
  j=0;
  /*
-  * This is sts_monobit, basically.
+  * This is sts_monobit, basically.  The table is folded all the way down
+  * to m = 1, so count[0] is the number of 0 bits.
   */
- mono_mean = (double) 2*freq[1][0] - bsize;   /* Should be 0.0 */
+ mono_mean = (double) 2*count[0] - bsize;   /* Should be 0.0 */
  mono_sigma = sqrt((double)bsize);
  /* printf("mono mean = %f   mono_sigma = %f\n",mono_mean,mono_sigma); */
  if(irun == 0){
@@ -300,7 +286,12 @@ int sts_serial(Test **test, unsigned int irun)
  }
  test[j++]->pvalues[irun] = gsl_cdf_gaussian_P(mono_mean,mono_sigma);
 
- for(m=2;m<nb1;m++){
+ /*
+  * For nb = 16, m0 = 2:  one test for m0 (as it has no second difference)
+  * and two each above it.  For wider nb the lowest orders are dropped so
+  * that the slots still add up.
+  */
+ for(m=m0;m<nb1;m++){
    delpsi2[m] = psi2[m] - psi2[m-1];
    del2psi2[m] = psi2[m] - 2.0*psi2[m-1] + psi2[m-2];
    pvalue = gsl_sf_gamma_inc_Q(pow(2,m-2),delpsi2[m]/2.0);
@@ -311,7 +302,7 @@ int sts_serial(Test **test, unsigned int irun)
    MYDEBUG(D_STS_SERIAL){
      printf("pvalue 1[%u] = %f\n",m,pvalue);
    }
-   if(m>2){
+   if(m>m0){
      pvalue = gsl_sf_gamma_inc_Q(pow(2,m-3),del2psi2[m]/2.0);
      if(irun == 0){
        test[j]->ntuple = m;
@@ -327,10 +318,7 @@ int sts_serial(Test **test, unsigned int irun)
  free(psi2);
  free(del2psi2);
  free(delpsi2);
- for(m = 1;m < nb1;m++){
-   free(freq[m]);
- }
- free(freq);
+ free(count);
 
  return(0);
 